@@ -0,0 +1,78 @@
+﻿using Lyra.FileLoader;
+using Xunit;
+
+namespace Lyra.Core.Tests.FileLoader;
+
+public sealed class DirectoryNavigatorTest
+{
+    [Fact]
+    public void GetNearest_OrdersByDistance_NextBeforePrevious()
+    {
+        var files = Apply(count: 9, current: 4);
+
+        Assert.Equal(new[] { files[4], files[5], files[3], files[6], files[2] }, DirectoryNavigator.GetNearest(2));
+    }
+
+    [Theory]
+    [InlineData(9, 0, 3, new[] { 0, 1, 2, 3 })]
+    [InlineData(9, 8, 3, new[] { 8, 7, 6, 5 })]
+    [InlineData(9, 1, 3, new[] { 1, 2, 0, 3, 4 })]
+    [InlineData(3, 1, 5, new[] { 1, 2, 0 })]
+    [InlineData(1, 0, 2, new[] { 0 })]
+    [InlineData(9, 4, 0, new[] { 4 })]
+    public void GetNearest_AtListEdges_SkipsMissingNeighbours(int count, int current, int depth, int[] expected)
+    {
+        var files = Apply(count, current);
+
+        Assert.Equal(expected.Select(i => files[i]), DirectoryNavigator.GetNearest(depth));
+    }
+
+    [Fact]
+    public void GetNearest_SameImagesAsGetRange()
+    {
+        for (var current = 0; current < 7; current++)
+        {
+            Apply(count: 7, current);
+            for (var depth = 0; depth <= 8; depth++)
+            {
+                var nearest = DirectoryNavigator.GetNearest(depth);
+                Assert.Equal(DirectoryNavigator.GetRange(depth).Order(), nearest.Order());
+                Assert.Equal(DirectoryNavigator.GetCurrent(), nearest[0]);
+            }
+        }
+    }
+
+    [Fact]
+    public void GetNearest_NegativeDepth_ReturnsEmpty()
+    {
+        Apply(count: 3, current: 1);
+
+        Assert.Empty(DirectoryNavigator.GetNearest(-1));
+    }
+
+    [Fact]
+    public void GetNearest_EmptyCollection_ReturnsEmpty()
+    {
+        DirectoryNavigator.ApplyCollection([], Context([], anchor: null), singleDirectory: true, topDirectory: null);
+
+        Assert.Empty(DirectoryNavigator.GetNearest(3));
+    }
+
+    /// <summary>Opens a collection of <paramref name="count"/> files in one directory at index <paramref name="current"/>.</summary>
+    private static List<string> Apply(int count, int current)
+    {
+        var dir = Path.Combine(Path.GetTempPath(), "Lyra_DirectoryNavigatorTests");
+        var files = Enumerable.Range(0, count).Select(i => Path.Combine(dir, $"{i:D2}.png")).ToList();
+
+        DirectoryNavigator.ApplyCollection(files, Context(files, files[current]), singleDirectory: true, topDirectory: dir);
+        return files;
+    }
+
+    private static FileDropContext Context(List<string> files, string? anchor) => new(
+        ExplicitPaths: files,
+        ExplicitFiles: files,
+        ExplicitDirectories: [],
+        IsSameDirectoryGroup: true,
+        AnchorPath: anchor,
+        IsSingleFileOpen: false);
+}
@@ -183,6 +183,27 @@ public static class DirectoryNavigator
         return result;
     }
 
+    /// <summary>
+    /// Returns the same window as <see cref="GetRange"/>, ordered by distance from the current image:
+    /// the current one, then the next and previous at each distance in turn.
+    /// </summary>
+    public static string[] GetNearest(int depth)
+    {
+        if (depth < 0 || _imageList.Count == 0 || (uint)_currentIndex >= (uint)_imageList.Count)
+            return [];
+
+        var result = new List<string>(2 * depth + 1) { _imageList[_currentIndex] };
+        for (var distance = 1; distance <= depth; distance++)
+        {
+            if (_currentIndex + distance < _imageList.Count)
+                result.Add(_imageList[_currentIndex + distance]);
+            if (_currentIndex - distance >= 0)
+                result.Add(_imageList[_currentIndex - distance]);
+        }
+
+        return result.ToArray();
+    }
+
     public static Navigation GetNavigation()
     {
         var navigation = new Navigation
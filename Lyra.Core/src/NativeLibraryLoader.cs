@@ -54,6 +54,11 @@ internal static class NativeLibraryLoader
                 RuntimeInformation.IsOSPlatform(OSPlatform.Linux) ? "libhdr_native.so" :
                 "libhdr_native.dylib"
             },
+            {
+                "PSD", RuntimeInformation.IsOSPlatform(OSPlatform.Windows) ? "libpsd_native.dll" :
+                RuntimeInformation.IsOSPlatform(OSPlatform.Linux) ? "libpsd_native.so" :
+                "libpsd_native.dylib"
+            },
 #if !DEBUG
             {
                 "SKIA", RuntimeInformation.IsOSPlatform(OSPlatform.Windows) ? "libSkiaSharp.dll" :
@@ -198,6 +203,7 @@ internal static class NativeLibraryLoader
         {
             "libexr" or "libexr.dll" or "libexr.so" or "libexr.dylib" => NativeLibrary.Load(PathDictionary["EXR"]),
             "libhdr" or "libhdr.dll" or "libhdr.so" or "libhdr.dylib" => NativeLibrary.Load(PathDictionary["HDR"]),
+            "libpsd" or "libpsd.dll" or "libpsd.so" or "libpsd.dylib" => NativeLibrary.Load(PathDictionary["PSD"]),
             _ => IntPtr.Zero
         };
     }
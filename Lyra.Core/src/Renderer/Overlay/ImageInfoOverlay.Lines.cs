@@ -22,7 +22,8 @@ public partial class ImageInfoOverlay
             $"[Collection]    {states.CollectionType}  |  Dir: {composite.FileInfo.DirectoryName}/",
             $"[File]          {states.CollectionIndex}/{states.CollectionCount}{dirNav}  |  {fileInfo.Name}  |  {fileSize}",
             $"[Image]         {composite.ImageFormatType.Description()}  |  {width}x{height}" + (composite.IsGrayscale ? "  |  Greyscale" : ""),
-            $"[Displaying]    Zoom: {states.Zoom}%  |  Display Mode: {states.DisplayMode}",
+            $"[Displaying]    Zoom: {states.Zoom}%  |  Display Mode: {states.DisplayMode}" +
+                (composite.ToneMapping is { } tone ? $"  |  Exposure: {tone.ExposureStops:+0.0;-0.0;0.0} EV  |  Tone: {tone.Curve}" : ""),
             $"[System]        Graphics API: OpenGL  |  Sampling: {states.SamplingMode}"
         };
 
@@ -48,9 +49,15 @@ public partial class ImageInfoOverlay
         yield return "";
         yield return "<d>[Debug]</>";
         yield return "";
-        yield return $"<d>[State]         {composite.State.Description()}</>";
+        yield return $"<d>[State]         {composite.State.Description()}{ProgressToStr(composite)}</>";
         yield return $"<d>[Decoder]       {composite.DecoderName}</>";
         yield return $"<d>[Time (ms)]     Estimated: {MsToStr(composite.LoadTimeEstimated)}  |  Elapsed: {MsToStr(composite.LoadTimeComplete)}</>";
+        if (composite.DecodeStages is { } stages)
+            yield return $"<d>[Stages (ms)]   Open: {stages.OpenMs:0.0}  |  Header: {stages.HeaderMs:0.0}  |  Decompress: {stages.DecompressMs:0.0}  |  " +
+                         $"Convert: {stages.ConvertMs:0.0}  |  Tonemap: {stages.TonemapMs:0.0}  |  Threads: {stages.Threads}</>";
+        if (composite.Statistics is { } stats)
+            yield return $"<d>[Samples]       Max RGB: {stats.Max[0]:0.###}/{stats.Max[1]:0.###}/{stats.Max[2]:0.###}  |  Median Lum: {stats.LuminancePercentile(0.5):0.####}  |  " +
+                         $"NaN: {stats.NanCount}  |  Inf: {stats.InfCount}" + (stats.AlphaOpaque ? "  |  Opaque" : "") + "</>";
         yield return "";
         yield return $"<d>[Drag & Drop]   {dropStatus}Paths Enqueued: {states.DropPathsEnqueued}  |  All Files: {states.DropFilesEnumerated}  |  Supported: {states.DropFilesSupported}</>";
     }
@@ -106,6 +113,14 @@ public partial class ImageInfoOverlay
         };
     }
 
+    private static string ProgressToStr(Composite composite)
+    {
+        if (composite.LoadProgress is not double progress || composite.State is not (CompositeState.Loading or CompositeState.Ready))
+            return string.Empty;
+
+        return $"  |  {progress * 100:0}%";
+    }
+
     private static string MsToStr(double? ms)
     {
         return ms switch
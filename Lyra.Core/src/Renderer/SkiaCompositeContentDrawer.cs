@@ -5,6 +5,9 @@ namespace Lyra.Renderer;
 
 public class SkiaCompositeContentDrawer : ICompositeContentDrawer
 {
+    // Encodes linear HDR content (half-float retention) for the 8-bit surface.
+    private static readonly SKPaint LinearToSrgbPaint = new() { ColorFilter = SKColorFilter.CreateLinearToSrgbGamma() };
+
     public void Draw(SKCanvas canvas, Composite composite, SKRect destFullRect, SKRect visibleFullRect, SKSamplingOptions sampling, float zoomScale, float displayScale)
     {
         var content = composite.Content;
@@ -14,7 +17,7 @@ public class SkiaCompositeContentDrawer : ICompositeContentDrawer
         switch (content)
         {
             case RasterContent raster:
-                canvas.DrawImage(raster.Image, destFullRect, sampling);
+                canvas.DrawImage(raster.Image, destFullRect, sampling, raster.IsLinear ? LinearToSrgbPaint : null);
                 break;
 
             case VectorContent vector:
@@ -61,10 +64,13 @@ public class SkiaCompositeContentDrawer : ICompositeContentDrawer
         if (composite.LogicalWidth <= 0 || composite.LogicalHeight <= 0)
             return;
 
+        // Pixels-per-full-unit required by current view
+        var screenPpfu = zoomScale * displayScale;
+
         // Safety: if there's no preview, rely on tiles.
         if (!hasPreview)
         {
-            foreach (var tile in rasterLarge.TileSource.GetTiles(visibleFullRect, new SKSize(composite.LogicalWidth, composite.LogicalHeight)))
+            foreach (var tile in rasterLarge.TileSource.GetTiles(visibleFullRect, new SKSize(composite.LogicalWidth, composite.LogicalHeight), screenPpfu))
                 canvas.DrawImage(tile.Image, tile.DestRect, sampling);
             return;
         }
@@ -74,9 +80,6 @@ public class SkiaCompositeContentDrawer : ICompositeContentDrawer
         var previewPpfuY = rasterLarge.PreviewImage.Height / composite.LogicalHeight;
         var previewPpfu = MathF.Min(previewPpfuX, previewPpfuY);
 
-        // Pixels-per-full-unit required by current view
-        var screenPpfu = zoomScale * displayScale;
-
         // Start tiling when demand exceeds what the preview can provide (with a small tolerance).
         // Example: 1.05 means it allows up to 5% upscale of the preview before switching to tiles.
         const float tileThreshold = 1.05f;
@@ -85,7 +88,7 @@ public class SkiaCompositeContentDrawer : ICompositeContentDrawer
         if (!useTiles)
             return;
 
-        foreach (var tile in rasterLarge.TileSource.GetTiles(visibleFullRect, new SKSize(composite.LogicalWidth, composite.LogicalHeight))) 
+        foreach (var tile in rasterLarge.TileSource.GetTiles(visibleFullRect, new SKSize(composite.LogicalWidth, composite.LogicalHeight), screenPpfu)) 
             canvas.DrawImage(tile.Image, tile.DestRect, sampling);
     }
 }
\ No newline at end of file
@@ -159,7 +159,7 @@ public class SkiaOpenGlRenderer : IRenderer
         else if (_composite is null || _composite.IsEmpty)
         {
             if (_composite?.State == CompositeState.Loading)
-                _centeredOverlay.Render(canvas, bounds, textColor, "Loading...");
+                _centeredOverlay.Render(canvas, bounds, textColor, _composite.LoadProgress is double progress ? $"Loading... {progress * 100:0}%" : "Loading...");
             else
                 _centeredOverlay.Render(canvas, bounds, textColor, "No image");
         }
@@ -31,7 +31,7 @@ public partial class SdlCore : IDisposable
     private DisplayMode _displayMode = DisplayMode.Undefined;
 
     private const int PreloadDepth = 3;
-    private const int CleanupSafeRange = 4;
+    private const int CacheMaxRange = 32; // beyond the preload window, ImageStore.CacheBudgetBytes decides how far images stay
 
     public SdlCore(GpuBackend backend = GpuBackend.OpenGL)
     {
@@ -71,8 +71,7 @@ public partial class SdlCore : IDisposable
 
     private void LoadImage()
     {
-        var keepPaths = DirectoryNavigator.GetRange(CleanupSafeRange);
-        ImageStore.Cleanup(keepPaths);
+        ImageStore.Cleanup(DirectoryNavigator.GetRange(PreloadDepth), DirectoryNavigator.GetNearest(CacheMaxRange));
 
         var currentPath = DirectoryNavigator.GetCurrent();
         if (currentPath == null)
@@ -101,6 +100,7 @@ public partial class SdlCore : IDisposable
         {
             HandleEvents();
             RecalculateDisplayModeIfNecessary();
+            ApplyToneMappingIfNecessary();
             _renderer.Render();
             GLSwapWindow(_window);
 
@@ -151,6 +151,13 @@ public partial class SdlCore : IDisposable
         }
     }
 
+    // Also catches images that finished decoding after the last exposure/curve change.
+    private void ApplyToneMappingIfNecessary()
+    {
+        if (_composite != null)
+            ImageStore.ApplyToneMapping(_composite);
+    }
+
     private void ExitApplication()
     {
         Logger.Info("[Core] Exiting application...");
@@ -1,5 +1,7 @@
 using Lyra.Common;
 using Lyra.FileLoader;
+using Lyra.Imaging;
+using Lyra.Imaging.Content;
 using Lyra.SystemUtils;
 using SkiaSharp;
 using static SDL3.SDL;
@@ -19,6 +21,9 @@ public partial class SdlCore
     private const int MinZoom = 1;
     private const int MaxZoom = 10000;
 
+    private const float ExposureStep = 0.5f;
+    private const float MaxExposureStops = 16f;
+
     private void InitializeInput()
     {
         _scanActions = new Dictionary<Scancode, Action>
@@ -35,6 +40,10 @@ public partial class SdlCore
             { Scancode.Equals, ZoomIn },
             { Scancode.Alpha0, ToggleDisplayMode },
             { Scancode.S, ToggleSampling },
+            { Scancode.L, NextLayer },
+            { Scancode.Leftbracket, DecreaseExposure },
+            { Scancode.Rightbracket, IncreaseExposure },
+            { Scancode.T, NextToneCurve },
             { Scancode.H, ToggleHelp },
             { Scancode.Return, OpenFileExplorer }
         };
@@ -192,6 +201,40 @@ private int _lastWindowWidth;
         _renderer.ToggleInfo();
     }
 
+    private void NextLayer()
+    {
+        var path = DirectoryNavigator.GetCurrent();
+        if (_composite == null || path == null || _composite.Layers.Count < 2)
+            return;
+
+        // Same image, so keep zoom and pan; only the decoded layer changes.
+        var offset = _panHelper?.CurrentOffset ?? SKPoint.Empty;
+        _composite = ImageStore.SelectLayer(path, (_composite.LayerIndex + 1) % _composite.Layers.Count);
+        _panHelper = new PanHelper(_window, _composite, _zoomPercentage) { CurrentOffset = offset };
+
+        _renderer.SetComposite(_composite);
+        Logger.Debug($"[Input] Layer: {_composite.LayerIndex}");
+    }
+
+    private void DecreaseExposure() => AdjustExposure(-ExposureStep);
+
+    private void IncreaseExposure() => AdjustExposure(+ExposureStep);
+
+    private static void AdjustExposure(float stops)
+    {
+        var tone = ImageStore.ToneMapping;
+        ImageStore.ToneMapping = tone with { ExposureStops = Math.Clamp(tone.ExposureStops + stops, -MaxExposureStops, MaxExposureStops) };
+        Logger.Debug($"[Input] Exposure: {ImageStore.ToneMapping.ExposureStops:+0.0;-0.0;0.0} EV");
+    }
+
+    private static void NextToneCurve()
+    {
+        var tone = ImageStore.ToneMapping;
+        var curves = Enum.GetValues<ToneCurve>();
+        ImageStore.ToneMapping = tone with { Curve = curves[(Array.IndexOf(curves, tone.Curve) + 1) % curves.Length] };
+        Logger.Debug($"[Input] Tone curve: {ImageStore.ToneMapping.Curve}");
+    }
+
     private void ToggleHelp()
     {
         // TODO
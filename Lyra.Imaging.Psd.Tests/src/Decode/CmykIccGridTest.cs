@@ -0,0 +1,123 @@
+﻿using System.Buffers;
+using Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
+using Lyra.Imaging.Psd.Core.Decode.Pixel;
+using Xunit;
+
+namespace Lyra.Imaging.Psd.Tests.Decode;
+
+public sealed class CmykIccGridTest
+{
+    [NativeFact]
+    public void WriteCmyk_Grid_MatchesTetrahedralReference()
+    {
+        var random = new Random(45);
+        var format = new SurfaceFormat(PixelFormat.Rgba8888, AlphaType.Straight);
+
+        foreach (var size in new[] { 2, 5, 17 })
+        {
+            const int width = 101, height = 7;
+            var nodes = new byte[CmykIccGrid.NodeBytes(size)];
+            random.NextBytes(nodes);
+            var grid = new CmykIccGrid(size, nodes);
+
+            var planes = new byte[4][];
+            for (var ch = 0; ch < 4; ch++)
+            {
+                planes[ch] = new byte[width * height];
+                random.NextBytes(planes[ch]);
+            }
+
+            // Every corner of the sample range, where the last node is reached.
+            for (var x = 0; x < 16; x++)
+            for (var ch = 0; ch < 4; ch++)
+                planes[ch][x] = (x >> ch & 1) != 0 ? (byte)255 : (byte)0;
+
+            using var surface = NewSurface(width, height, format);
+            Assert.True(NativePlaneWriter.TryWriteCmyk(surface,
+                new Plane(PlaneRole.C, planes[0], width), new Plane(PlaneRole.M, planes[1], width),
+                new Plane(PlaneRole.Y, planes[2], width), new Plane(PlaneRole.K, planes[3], width),
+                default, hasAlpha: false, grid, CancellationToken.None));
+
+            for (var y = 0; y < height; y++)
+            {
+                var row = surface.GetRowSpan(y);
+                for (var x = 0; x < width; x++)
+                {
+                    var i = y * width + x;
+                    var expected = Reference(grid, planes[0][i], planes[1][i], planes[2][i], planes[3][i]);
+                    for (var ch = 0; ch < 3; ch++)
+                    {
+                        // The native path works in 8-bit fractions of a cell and rounds once.
+                        Assert.True(Math.Abs(expected[ch] - row[x * 4 + ch]) <= 1,
+                            $"size={size} ({x}, {y}) channel {ch}: expected {expected[ch]}, got {row[x * 4 + ch]}");
+                    }
+
+                    Assert.Equal(255, row[x * 4 + 3]);
+                }
+            }
+        }
+    }
+
+    [Fact]
+    public void Constructor_GridTooLargeForNodeBytes_Throws()
+    {
+        Assert.Throws<ArgumentOutOfRangeException>(() => new CmykIccGrid(CmykIccGrid.MaxSize + 1, []));
+    }
+
+    /// <summary>
+    /// Tetrahedral interpolation over C, M and Y in the two K slices around the sample, then linear along K, in
+    /// doubles at the exact grid position.
+    /// </summary>
+    private static int[] Reference(CmykIccGrid grid, byte c, byte m, byte y, byte k)
+    {
+        var size = grid.Size;
+        var index = new int[4];
+        var fraction = new double[4];
+        var samples = new[] { c, m, y, k };
+        for (var axis = 0; axis < 4; axis++)
+        {
+            var t = samples[axis] * (size - 1) / 255.0;
+            index[axis] = Math.Min((int)t, size - 2);
+            fraction[axis] = t - index[axis];
+        }
+
+        // Axes of the cube by decreasing fraction: the tetrahedron walks from the origin along them in turn.
+        var order = new[] { 0, 1, 2 };
+        Array.Sort(order, (a, b) => fraction[b].CompareTo(fraction[a]));
+
+        var rgb = new int[3];
+        for (var ch = 0; ch < 3; ch++)
+        {
+            var slices = new double[2];
+            for (var dk = 0; dk < 2; dk++)
+            {
+                var corner = new int[3];
+                var value = (1 - fraction[order[0]]) * Node(corner, dk);
+                for (var step = 0; step < 3; step++)
+                {
+                    corner[order[step]] = 1;
+                    var next = step < 2 ? fraction[order[step + 1]] : 0;
+                    value += (fraction[order[step]] - next) * Node(corner, dk);
+                }
+
+                slices[dk] = value;
+            }
+
+            rgb[ch] = (int)Math.Round(slices[0] * (1 - fraction[3]) + slices[1] * fraction[3]);
+
+            double Node(int[] corner, int dk)
+            {
+                var node = (((index[3] + dk) * size + index[2] + corner[2]) * size + index[1] + corner[1]) * size + index[0] + corner[0];
+                return grid.Nodes[node * CmykIccGrid.BytesPerNode + ch];
+            }
+        }
+
+        return rgb;
+    }
+
+    private static RgbaSurface NewSurface(int width, int height, SurfaceFormat format)
+    {
+        var stride = width * 4;
+        return new RgbaSurface(width, height, MemoryPool<byte>.Shared.Rent(stride * height), stride, format);
+    }
+}
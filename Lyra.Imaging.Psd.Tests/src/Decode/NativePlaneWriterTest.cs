@@ -0,0 +1,147 @@
+﻿using System.Buffers;
+using Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
+using Lyra.Imaging.Psd.Core.Decode.Pixel;
+using Xunit;
+
+namespace Lyra.Imaging.Psd.Tests.Decode;
+
+public sealed class NativePlaneWriterTest
+{
+    private static readonly int[] Widths = [1, 15, 16, 17, 31, 33, 101];
+
+    private static readonly SurfaceFormat[] Formats =
+    [
+        new(PixelFormat.Bgra8888, AlphaType.Premultiplied),
+        new(PixelFormat.Bgra8888, AlphaType.Straight),
+        new(PixelFormat.Rgba8888, AlphaType.Premultiplied),
+        new(PixelFormat.Rgba8888, AlphaType.Straight)
+    ];
+
+    [NativeFact]
+    public void WriteRgb_MatchesRowWriter()
+    {
+        var random = new Random(42);
+        var curves = RandomLuts(random);
+
+        foreach (var width in Widths)
+        foreach (var format in Formats)
+        foreach (var hasAlpha in new[] { false, true })
+        foreach (var useCalibration in new[] { false, true })
+        {
+            const int height = 5;
+            Plane r = RandomPlane(random, PlaneRole.R, width, height), g = RandomPlane(random, PlaneRole.G, width, height), b = RandomPlane(random, PlaneRole.B, width, height);
+            var a = hasAlpha ? RandomPlane(random, PlaneRole.A, width, height) : default;
+
+            using var expected = NewSurface(width, height, format);
+            for (var y = 0; y < height; y++)
+            {
+                PixelRowWriter.WriteRgbRow(expected.GetRowSpan(y), format.PixelFormat, format.AlphaType,
+                    Row(r, y, width), Row(g, y, width), Row(b, y, width), hasAlpha ? Row(a, y, width) : default,
+                    hasAlpha, useCalibration, curves);
+            }
+
+            using var actual = NewSurface(width, height, format);
+            Assert.True(NativePlaneWriter.TryWriteRgb(actual, r, g, b, a, hasAlpha, useCalibration, curves, CancellationToken.None));
+
+            AssertSamePixels(expected, actual, $"RGB width={width} {format} alpha={hasAlpha} calibration={useCalibration}");
+        }
+    }
+
+    [NativeFact]
+    public void WriteCmyk_MatchesRowWriter()
+    {
+        var random = new Random(43);
+        var curves = RandomLuts(random);
+        var gamma = RandomLuts(random).R;
+
+        foreach (var width in Widths)
+        foreach (var format in Formats)
+        foreach (var hasAlpha in new[] { false, true })
+        foreach (var (useHeuristicTuning, neutralBalance) in new[] { (false, false), (true, false), (true, true) })
+        {
+            const int height = 4;
+            var tuning = new PixelRowWriter.CmykHeuristicTuning(gamma, neutralBalance, 12, 3, -2, 5);
+            Plane c = RandomPlane(random, PlaneRole.C, width, height), m = RandomPlane(random, PlaneRole.M, width, height);
+            Plane y = RandomPlane(random, PlaneRole.Y, width, height), k = RandomPlane(random, PlaneRole.K, width, height);
+            var a = hasAlpha ? RandomPlane(random, PlaneRole.A, width, height) : default;
+
+            using var expected = NewSurface(width, height, format);
+            for (var row = 0; row < height; row++)
+            {
+                PixelRowWriter.WriteCmykRow(expected.GetRowSpan(row), format.PixelFormat, format.AlphaType,
+                    Row(c, row, width), Row(m, row, width), Row(y, row, width), Row(k, row, width), hasAlpha ? Row(a, row, width) : default,
+                    hasAlpha, useHeuristicTuning, tuning, curves);
+            }
+
+            using var actual = NewSurface(width, height, format);
+            Assert.True(NativePlaneWriter.TryWriteCmyk(actual, c, m, y, k, a, hasAlpha, useHeuristicTuning, tuning, curves, CancellationToken.None));
+
+            AssertSamePixels(expected, actual, $"CMYK width={width} {format} alpha={hasAlpha} heuristic={useHeuristicTuning} neutral={neutralBalance}");
+        }
+    }
+
+    [NativeFact]
+    public void WriteRgb_Cancelled_Throws()
+    {
+        using var cts = new CancellationTokenSource();
+        cts.Cancel();
+
+        var random = new Random(44);
+        var format = SurfaceFormat.Default;
+        using var surface = NewSurface(64, 64, format);
+        Plane r = RandomPlane(random, PlaneRole.R, 64, 64), g = RandomPlane(random, PlaneRole.G, 64, 64), b = RandomPlane(random, PlaneRole.B, 64, 64);
+
+        Assert.ThrowsAny<OperationCanceledException>(() =>
+            NativePlaneWriter.TryWriteRgb(surface, r, g, b, default, hasAlpha: false, useCalibration: false, RgbLuts.Identity(), cts.Token));
+    }
+
+    private static RgbaSurface NewSurface(int width, int height, SurfaceFormat format)
+    {
+        // Padded rows: writers must keep to their own row.
+        var stride = width * 4 + 12;
+        var owner = MemoryPool<byte>.Shared.Rent(stride * height);
+        owner.Memory.Span.Fill(0xEE);
+        return new RgbaSurface(width, height, owner, stride, format);
+    }
+
+    private static Plane RandomPlane(Random random, PlaneRole role, int width, int height)
+    {
+        // Odd padding after every row, as planes of tiles and previews have.
+        var bytesPerRow = width + 3;
+        var data = new byte[bytesPerRow * height];
+        random.NextBytes(data);
+        return new Plane(role, data, bytesPerRow);
+    }
+
+    private static ReadOnlySpan<byte> Row(Plane plane, int y, int width) => plane.Data.AsSpan(y * plane.BytesPerRow, width);
+
+    private static RgbLuts RandomLuts(Random random)
+    {
+        byte[] r = new byte[256], g = new byte[256], b = new byte[256];
+        random.NextBytes(r);
+        random.NextBytes(g);
+        random.NextBytes(b);
+        return new RgbLuts(r, g, b);
+    }
+
+    private static void AssertSamePixels(RgbaSurface expected, RgbaSurface actual, string what)
+    {
+        for (var y = 0; y < expected.Height; y++)
+        {
+            var e = expected.GetRowSpan(y).ToArray();
+            var a = actual.GetRowSpan(y).ToArray();
+            Assert.True(e.AsSpan().SequenceEqual(a), $"{what}: row {y} differs at byte {FirstDifference(e, a)}");
+        }
+    }
+
+    private static int FirstDifference(byte[] expected, byte[] actual)
+    {
+        for (var i = 0; i < expected.Length; i++)
+        {
+            if (expected[i] != actual[i])
+                return i;
+        }
+
+        return -1;
+    }
+}
@@ -0,0 +1,156 @@
+﻿using Lyra.Imaging.Psd.Core.Decode.Decompressors;
+using Lyra.Imaging.Psd.Core.Interop;
+using Xunit;
+
+namespace Lyra.Imaging.Psd.Tests.Decode;
+
+public sealed class PackBitsTest
+{
+    private const sbyte NoOp = -128;
+
+    [NativeFact]
+    public void UnpackRows_RandomRows_MatchManaged()
+    {
+        var random = new Random(1234);
+        foreach (var width in new[] { 1, 2, 3, 7, 17, 128, 129, 255, 1001 })
+        {
+            var rows = Enumerable.Range(0, 40).Select(_ => Pack(RandomRow(random, width), random)).ToArray();
+
+            var expected = new byte[rows.Length * width];
+            for (var i = 0; i < rows.Length; i++)
+                PsdRleDecompressor.PackBitsDecode(rows[i], expected.AsSpan(i * width, width));
+
+            // A padded stride checks that rows land at dst + i * stride and nothing is written past the width.
+            var stride = width + 5;
+            var actual = Unpack(rows, width, stride, out var ok);
+            Assert.True(ok, PsdNative.LastError());
+            for (var i = 0; i < rows.Length; i++)
+            {
+                Assert.Equal(expected.AsSpan(i * width, width).ToArray(), actual.AsSpan(i * stride, width).ToArray());
+                Assert.All(actual.AsSpan(i * stride + width, stride - width).ToArray(), b => Assert.Equal(0xEE, b));
+            }
+        }
+    }
+
+    [NativeFact]
+    public void UnpackRows_NoOpHeader_IsSkipped()
+    {
+        byte[] row = [unchecked((byte)NoOp), 0x01, 0x10, 0x20, unchecked((byte)NoOp), 0xFE, 0x30, unchecked((byte)NoOp)];
+        var expected = new byte[5];
+        PsdRleDecompressor.PackBitsDecode(row, expected);
+
+        var actual = Unpack([row], 5, 5, out var ok);
+        Assert.True(ok, PsdNative.LastError());
+        Assert.Equal(new byte[] { 0x10, 0x20, 0x30, 0x30, 0x30 }, expected);
+        Assert.Equal(expected, actual);
+    }
+
+    [NativeFact]
+    public void UnpackRows_TrailingBytes_AreIgnored()
+    {
+        byte[] row = [0x02, 1, 2, 3, 0x05, 9, 9];
+        var expected = new byte[3];
+        PsdRleDecompressor.PackBitsDecode(row, expected);
+
+        var actual = Unpack([row], 3, 3, out var ok);
+        Assert.True(ok, PsdNative.LastError());
+        Assert.Equal(expected, actual);
+    }
+
+    [NativeFact]
+    public void UnpackRows_TruncatedRows_FailLikeManaged()
+    {
+        var random = new Random(99);
+        foreach (var width in new[] { 1, 9, 64, 333 })
+        {
+            var packed = Pack(RandomRow(random, width), random);
+            for (var cut = 1; cut <= Math.Min(4, packed.Length); cut++)
+            {
+                var truncated = packed[..^cut];
+                Assert.ThrowsAny<Exception>(() => PsdRleDecompressor.PackBitsDecode(truncated, new byte[width]));
+
+                Unpack([packed, truncated], width, width, out var ok);
+                Assert.False(ok);
+            }
+        }
+    }
+
+    [NativeFact]
+    public void UnpackRows_Cancelled_Fails()
+    {
+        using var cts = new CancellationTokenSource();
+        cts.Cancel();
+
+        var random = new Random(7);
+        var rows = Enumerable.Range(0, 64).Select(_ => Pack(RandomRow(random, 100), random)).ToArray();
+
+        Unpack(rows, 100, 100, out var ok, cts.Token);
+        Assert.False(ok);
+        Assert.Contains("cancelled", PsdNative.LastError());
+    }
+
+    private static unsafe byte[] Unpack(byte[][] rows, int width, int stride, out bool ok, CancellationToken ct = default)
+    {
+        var packed = rows.SelectMany(r => r).ToArray();
+        var lengths = rows.Select(r => r.Length).ToArray();
+        var dst = new byte[rows.Length * stride];
+        dst.AsSpan().Fill(0xEE);
+
+        using var scope = new NativePsdControlScope(ct);
+        fixed (byte* src = packed)
+        fixed (int* len = lengths)
+        fixed (byte* output = dst)
+        {
+            ok = PsdNative.psd_unpack_rows(src, len, rows.Length, width, output, stride, scope.Control);
+        }
+
+        return dst;
+    }
+
+    /// <summary>Rows with long repeats and noise, so packing produces both run kinds at every length.</summary>
+    private static byte[] RandomRow(Random random, int width)
+    {
+        var row = new byte[width];
+        for (var x = 0; x < width;)
+        {
+            var run = Math.Min(width - x, random.Next(1, 200));
+            if (random.Next(2) == 0)
+                row.AsSpan(x, run).Fill((byte)random.Next(256));
+            else
+                random.NextBytes(row.AsSpan(x, run));
+            x += run;
+        }
+
+        return row;
+    }
+
+    /// <summary>PackBits with runs of every length up to 128, and -128 no-ops sprinkled between them.</summary>
+    private static byte[] Pack(byte[] row, Random random)
+    {
+        var packed = new List<byte>();
+        for (var x = 0; x < row.Length;)
+        {
+            if (random.Next(8) == 0)
+                packed.Add(unchecked((byte)NoOp));
+
+            var repeat = 1;
+            while (x + repeat < row.Length && repeat < 128 && row[x + repeat] == row[x])
+                repeat++;
+
+            if (repeat >= 2)
+            {
+                packed.Add(unchecked((byte)(1 - repeat)));
+                packed.Add(row[x]);
+                x += repeat;
+                continue;
+            }
+
+            var literal = Math.Min(Math.Min(row.Length - x, 128), random.Next(1, 130));
+            packed.Add((byte)(literal - 1));
+            packed.AddRange(row.AsSpan(x, literal).ToArray());
+            x += literal;
+        }
+
+        return packed.ToArray();
+    }
+}
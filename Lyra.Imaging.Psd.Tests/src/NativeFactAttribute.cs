@@ -0,0 +1,14 @@
+﻿using Lyra.Imaging.Psd.Core.Interop;
+using Xunit;
+
+namespace Lyra.Imaging.Psd.Tests;
+
+/// <summary>A fact comparing libpsd_native with the managed code; skipped when the library cannot be loaded.</summary>
+public sealed class NativeFactAttribute : FactAttribute
+{
+    public NativeFactAttribute()
+    {
+        if (!PsdNative.IsAvailable)
+            Skip = "libpsd_native not found next to the test assembly (build with -p:LyraNativeDir=...).";
+    }
+}
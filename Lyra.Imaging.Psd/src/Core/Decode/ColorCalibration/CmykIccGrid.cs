@@ -0,0 +1,80 @@
+using Wacton.Unicolour;
+
+namespace Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
+
+/// <summary>
+/// A CMYK profile baked into a 4D lookup table: <see cref="Size"/> nodes per axis, evenly spaced over the stored
+/// 0..255 sample range, each holding the profile's RGB output for that CMYK value. Unlike <see cref="RgbLuts"/>
+/// it captures the interaction between inks, so interpolating it (see libpsd_native) stays close to the full ICC
+/// transform at a fraction of its cost.
+/// <para>
+/// Nodes are indexed by stored PSD samples, which are inverted (255 = no ink). Layout: 4 bytes (R, G, B, 0) per
+/// node, C varying fastest, then M, Y and K.
+/// </para>
+/// </summary>
+public sealed class CmykIccGrid
+{
+    public const int BytesPerNode = 4;
+
+    /// <summary>Largest <see cref="Size"/> whose node bytes fit an int; libpsd_native rejects larger grids.</summary>
+    public const int MaxSize = 152;
+
+    public int Size { get; }
+    public byte[] Nodes { get; }
+
+    public CmykIccGrid(int size, byte[] nodes)
+    {
+        ArgumentOutOfRangeException.ThrowIfLessThan(size, 2);
+        ArgumentOutOfRangeException.ThrowIfGreaterThan(size, MaxSize);
+        ArgumentNullException.ThrowIfNull(nodes);
+
+        if (nodes.Length != NodeBytes(size))
+            throw new ArgumentException($"Expected {NodeBytes(size)} node bytes for a {size}^4 grid, got {nodes.Length}.", nameof(nodes));
+
+        Size = size;
+        Nodes = nodes;
+    }
+
+    public static int NodeBytes(int size) => checked(size * size * size * size * BytesPerNode);
+
+    /// <summary>
+    /// Samples the profile at every node. One (K, Y) slice of nodes per work item, spread over all cores.
+    /// </summary>
+    public static CmykIccGrid Bake(Configuration config, int size, CancellationToken ct)
+    {
+        ArgumentNullException.ThrowIfNull(config);
+        ArgumentOutOfRangeException.ThrowIfLessThan(size, 2);
+        ArgumentOutOfRangeException.ThrowIfGreaterThan(size, MaxSize);
+
+        var nodes = new byte[NodeBytes(size)];
+        var options = new ParallelOptions { CancellationToken = ct };
+
+        Parallel.For(0, size * size, options, slice =>
+        {
+            var k = slice / size;
+            var y = slice % size;
+
+            // Stored sample s at node i is i * 255 / (size - 1); its ink amount is 1 - s / 255.
+            var inkK = 1.0 - (double)k / (size - 1);
+            var inkY = 1.0 - (double)y / (size - 1);
+
+            var offset = slice * size * size * BytesPerNode;
+            for (var m = 0; m < size; m++)
+            {
+                var inkM = 1.0 - (double)m / (size - 1);
+                for (var c = 0; c < size; c++)
+                {
+                    var inkC = 1.0 - (double)c / (size - 1);
+                    var rgb = IccOracle.OracleIccRgb(config, inkC, inkM, inkY, inkK);
+
+                    nodes[offset + 0] = (byte)rgb.r;
+                    nodes[offset + 1] = (byte)rgb.g;
+                    nodes[offset + 2] = (byte)rgb.b;
+                    offset += BytesPerNode;
+                }
+            }
+        });
+
+        return new CmykIccGrid(size, nodes);
+    }
+}
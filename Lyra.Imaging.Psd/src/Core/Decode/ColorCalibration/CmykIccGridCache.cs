@@ -0,0 +1,95 @@
+using System.Buffers.Binary;
+
+namespace Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
+
+/// <summary>
+/// Baked <see cref="CmykIccGrid"/>s kept on disk, so a profile is only sampled once per machine rather than once per
+/// session. One file per profile and grid size, named by the profile's SHA-256: a 16-byte header followed by
+/// the nodes. Disabled while <see cref="Directory"/> is null; I/O failures only mean a miss or a grid that is not
+/// kept, the caller always has a baked grid to use.
+/// </summary>
+public static class CmykIccGridCache
+{
+    private const string EntryExtension = ".lcg";
+    private const uint Magic = 0x4743594C; // "LYCG"
+    private const int Version = 1;
+    private const int HeaderSize = 16;
+
+    /// <summary>Directory holding the entries; set by the host application. Null keeps grids in memory only.</summary>
+    public static string? Directory { get; set; }
+
+    public static CmykIccGrid? TryLoad(string profileHash, int size)
+    {
+        var path = EntryPath(profileHash, size);
+        if (path == null || !File.Exists(path))
+            return null;
+
+        try
+        {
+            var bytes = File.ReadAllBytes(path);
+            var nodeBytes = CmykIccGrid.NodeBytes(size);
+            if (bytes.Length != HeaderSize + nodeBytes
+                || BinaryPrimitives.ReadUInt32LittleEndian(bytes) != Magic
+                || BinaryPrimitives.ReadInt32LittleEndian(bytes.AsSpan(4)) != Version
+                || BinaryPrimitives.ReadInt32LittleEndian(bytes.AsSpan(8)) != size)
+            {
+                File.Delete(path);
+                return null;
+            }
+
+            return new CmykIccGrid(size, bytes.AsSpan(HeaderSize).ToArray());
+        }
+        catch (IOException)
+        {
+            return null;
+        }
+        catch (UnauthorizedAccessException)
+        {
+            return null;
+        }
+    }
+
+    public static void Store(string profileHash, CmykIccGrid grid)
+    {
+        var path = EntryPath(profileHash, grid.Size);
+        if (path == null)
+            return;
+
+        // Written aside and moved into place, so a concurrent reader never sees a partial entry.
+        var temp = path + "." + Environment.ProcessId + ".tmp";
+        try
+        {
+            System.IO.Directory.CreateDirectory(Path.GetDirectoryName(path)!);
+
+            var header = new byte[HeaderSize];
+            BinaryPrimitives.WriteUInt32LittleEndian(header, Magic);
+            BinaryPrimitives.WriteInt32LittleEndian(header.AsSpan(4), Version);
+            BinaryPrimitives.WriteInt32LittleEndian(header.AsSpan(8), grid.Size);
+
+            using (var stream = new FileStream(temp, FileMode.Create, FileAccess.Write, FileShare.None))
+            {
+                stream.Write(header);
+                stream.Write(grid.Nodes);
+            }
+
+            File.Move(temp, path, overwrite: true);
+        }
+        catch (Exception ex) when (ex is IOException or UnauthorizedAccessException)
+        {
+            try
+            {
+                File.Delete(temp);
+            }
+            catch (Exception cleanup) when (cleanup is IOException or UnauthorizedAccessException)
+            {
+                // Best effort; a stale temp file is harmless.
+            }
+        }
+    }
+
+    private static string? EntryPath(string profileHash, int size)
+    {
+        var directory = Directory;
+        return directory == null ? null : Path.Combine(directory, $"{profileHash}-{size}{EntryExtension}");
+    }
+}
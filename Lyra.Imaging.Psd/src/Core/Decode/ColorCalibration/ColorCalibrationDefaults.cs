@@ -3,4 +3,7 @@ namespace Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
 public static class ColorCalibrationDefaults
 {
     public const int GridSize = 48;
+
+    // Nodes per axis of the baked CMYK -> RGB grid; 17^4 nodes, one oracle call each.
+    public const int CmykGridSize = 17;
 }
\ No newline at end of file
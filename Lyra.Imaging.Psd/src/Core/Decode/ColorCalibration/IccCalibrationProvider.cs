@@ -9,44 +9,96 @@ public sealed class IccCalibrationProvider
 {
     private readonly ConcurrentDictionary<(string key, int grid), RgbLuts> _cache = new();
 
+    // One bake per profile and size; unrelated profiles bake side by side.
+    private static readonly ConcurrentDictionary<(string hash, int size), Lazy<Task<CmykIccGrid>>> Grids = new();
+    private static readonly ConcurrentDictionary<string, string> OsProfileHashes = new();
+
     public RgbLuts GetCalibration(ColorCalibrationRequest req, Func<Configuration, RgbLuts> buildLuts, out string? iccProfileUsed)
     {
         ArgumentNullException.ThrowIfNull(req);
         ArgumentNullException.ThrowIfNull(buildLuts);
 
-        iccProfileUsed = null;
-        
-        if (!req.PreferColorManagement)
-            return RgbLuts.Identity();
+        var profile = ResolveProfile(req);
+        iccProfileUsed = profile?.Name;
 
-        string profileKey;
-        Configuration config;
+        return profile is { } p
+            ? _cache.GetOrAdd((p.Key, req.GridSize), _ => buildLuts(p.Config.Value))
+            : RgbLuts.Identity();
+    }
 
-        if (req.EmbeddedIccProfile is { Length: > 0 })
-        {
-            profileKey = Hash(req.EmbeddedIccProfile);
-            config = new Configuration(iccConfig: new IccConfiguration(req.EmbeddedIccProfile, Intent.RelativeColorimetric));
+    /// <summary>
+    /// The CMYK profile for the request baked into a <see cref="CmykIccGrid"/> of <paramref name="size"/> nodes per
+    /// axis, or null when colour management is off or no profile applies. Grids are shared by every decode and
+    /// kept in <see cref="CmykIccGridCache"/>, keyed by the profile's hash; baking happens once, on first use.
+    /// The bake belongs to no decode: <paramref name="ct"/> only stops this caller waiting for it, and the grid is
+    /// still there for the next one.
+    /// </summary>
+    public CmykIccGrid? GetCmykGrid(ColorCalibrationRequest req, int size, out string? iccProfileUsed, CancellationToken ct)
+    {
+        ArgumentNullException.ThrowIfNull(req);
 
-            iccProfileUsed = "Embedded ICC Profile";
+        var profile = req.SourceColorMode == ColorMode.Cmyk ? ResolveProfile(req) : null;
+        iccProfileUsed = profile?.Name;
+        if (profile is not { } p)
+            return null;
+
+        var key = (p.Hash, size);
+        var bake = Grids.GetOrAdd(key, _ => new Lazy<Task<CmykIccGrid>>(() => Task.Run(() => LoadOrBake(p, size))));
+
+        try
+        {
+            return bake.Value.WaitAsync(ct).GetAwaiter().GetResult();
         }
-        else
+        catch when (bake.Value.IsFaulted)
+        {
+            // A failed bake is not kept; the next caller tries again.
+            Grids.TryRemove(KeyValuePair.Create(key, bake));
+            throw;
+        }
+    }
+
+    private static CmykIccGrid LoadOrBake(Profile profile, int size)
+    {
+        var grid = CmykIccGridCache.TryLoad(profile.Hash, size);
+        if (grid != null)
+            return grid;
+
+        grid = CmykIccGrid.Bake(profile.Config.Value, size, CancellationToken.None);
+        CmykIccGridCache.Store(profile.Hash, grid);
+        return grid;
+    }
+
+    // Parsing the profile is deferred until a calibration or grid actually has to be built.
+    private readonly record struct Profile(string Key, string Hash, Lazy<Configuration> Config, string Name);
+
+    private static Profile? ResolveProfile(ColorCalibrationRequest req)
+    {
+        if (!req.PreferColorManagement)
+            return null;
+
+        if (req.EmbeddedIccProfile is { Length: > 0 })
         {
-            // Only CMYK has a reasonable OS-default profile fallback at the moment.
-            // For RGB, if there's no embedded profile, treat it as already in output space (identity).
-            if (req.SourceColorMode != ColorMode.Cmyk)
-                return RgbLuts.Identity();
-
-            var path = OsCmykProfileLocator.TryGetDefaultCmykIccPath();
-            if (path == null)
-                return RgbLuts.Identity();
-
-            profileKey = path;
-            config = new Configuration(iccConfig: new IccConfiguration(path, Intent.RelativeColorimetric));
-            
-            iccProfileUsed = Path.GetFileNameWithoutExtension(path);
+            var hash = Hash(req.EmbeddedIccProfile);
+            var embedded = req.EmbeddedIccProfile;
+            var config = new Lazy<Configuration>(() => new Configuration(iccConfig: new IccConfiguration(embedded, Intent.RelativeColorimetric)));
+
+            return new Profile(hash, hash, config, "Embedded ICC Profile");
         }
 
-        return _cache.GetOrAdd((profileKey, req.GridSize), _ => buildLuts(config));
+        // Only CMYK has a reasonable OS-default profile fallback at the moment.
+        // For RGB, if there's no embedded profile, treat it as already in output space (identity).
+        if (req.SourceColorMode != ColorMode.Cmyk)
+            return null;
+
+        var path = OsCmykProfileLocator.TryGetDefaultCmykIccPath();
+        if (path == null)
+            return null;
+
+        return new Profile(
+            path,
+            OsProfileHashes.GetOrAdd(path, p => Hash(File.ReadAllBytes(p))),
+            new Lazy<Configuration>(() => new Configuration(iccConfig: new IccConfiguration(path, Intent.RelativeColorimetric))),
+            Path.GetFileNameWithoutExtension(path));
     }
 
     private static string Hash(byte[] data) =>
@@ -30,7 +30,13 @@ internal static class IccOracle
         var y0 = invert ? (255 - y) / 255.0 : y / 255.0;
         var k0 = invert ? (255 - k) / 255.0 : k / 255.0;
 
-        var u = new Unicolour(config, new Channels(c0, m0, y0, k0));
+        return OracleIccRgb(config, c0, m0, y0, k0);
+    }
+
+    /// <summary>Ink amounts in [0, 1], for sampling between byte values (e.g. the nodes of a <see cref="CmykIccGrid"/>).</summary>
+    public static (int r, int g, int b) OracleIccRgb(Configuration config, double c, double m, double y, double k)
+    {
+        var u = new Unicolour(config, new Channels(c, m, y, k));
         var rgb = u.Rgb.Byte255;
 
         return (Clamp0To255(rgb.R), Clamp0To255(rgb.G), Clamp0To255(rgb.B));
@@ -2,6 +2,7 @@ using System.Buffers;
 using Lyra.Imaging.Psd.Core.Common;
 using Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
 using Lyra.Imaging.Psd.Core.Decode.Pixel;
+using Lyra.Imaging.Psd.Core.Interop;
 using Lyra.Imaging.Psd.Core.SectionData;
 using Wacton.Unicolour;
 
@@ -52,6 +53,42 @@ public sealed class CmykProcessor : IColorModeProcessor
         var stride = checked(src.Width * 4);
         var size = checked(stride * src.Height);
 
+        var hasAlpha = a.Data != null && a.Data.Length != 0;
+
+        if (ctx.PreferColorManagement && PsdNative.IsAvailable)
+        {
+            // Colour managed through the profile baked into a 4D grid, when there is a profile to bake.
+            var grid = CalibrationProvider.GetCmykGrid(
+                new ColorCalibrationRequest(
+                    SourceColorMode: ColorMode.Cmyk,
+                    EmbeddedIccProfile: ctx.IccProfile,
+                    PreferColorManagement: true,
+                    GridSize: ColorCalibrationDefaults.CmykGridSize),
+                ColorCalibrationDefaults.CmykGridSize,
+                out var gridProfileUsed,
+                ct);
+
+            if (grid != null)
+            {
+                IccProfileUsed = gridProfileUsed;
+
+                var gridSurface = new RgbaSurface(src.Width, src.Height, MemoryPool<byte>.Shared.Rent(size), stride, ctx.OutputFormat);
+                try
+                {
+                    ct.ThrowIfCancellationRequested();
+                    if (NativePlaneWriter.TryWriteCmyk(gridSurface, c, m, y, k, a, hasAlpha, grid, ct))
+                        return gridSurface;
+                }
+                catch
+                {
+                    gridSurface.Dispose();
+                    throw;
+                }
+
+                gridSurface.Dispose();
+            }
+        }
+
         const int gridSize = ColorCalibrationDefaults.GridSize;
         var calibration = CalibrationProvider.GetCalibration(
             new ColorCalibrationRequest(
@@ -82,6 +119,10 @@ public sealed class CmykProcessor : IColorModeProcessor
 
         try
         {
+            ct.ThrowIfCancellationRequested();
+            if (NativePlaneWriter.TryWriteCmyk(surface, c, m, y, k, a, hasAlpha, useHeuristicTuning, tuning, calibration, ct))
+                return surface;
+
             for (var row = 0; row < src.Height; row++)
             {
                 ct.ThrowIfCancellationRequested();
@@ -92,7 +133,6 @@ public sealed class CmykProcessor : IColorModeProcessor
                 var kRow = k.Data.AsSpan(row * k.BytesPerRow, src.Width);
 
                 Span<byte> aRow = default;
-                var hasAlpha = a.Data != null && a.Data.Length != 0;
                 if (hasAlpha)
                     aRow = a.Data.AsSpan(row * a.BytesPerRow, src.Width);
 
@@ -52,6 +52,10 @@ public sealed class RgbProcessor : IColorModeProcessor
 
         try
         {
+            ct.ThrowIfCancellationRequested();
+            if (NativePlaneWriter.TryWriteRgb(surface, r, g, b, a, hasAlpha: a.Data != null, useCalibration, calibration, ct))
+                return surface;
+
             for (var y = 0; y < src.Height; y++)
             {
                 ct.ThrowIfCancellationRequested();
@@ -1,5 +1,6 @@
 using System.Buffers;
 using Lyra.Imaging.Psd.Core.Decode.Pixel;
+using Lyra.Imaging.Psd.Core.Interop;
 using Lyra.Imaging.Psd.Core.Readers;
 using Lyra.Imaging.Psd.Core.SectionData;
 
@@ -9,6 +10,9 @@ internal sealed class PsdRleDecompressor : PsdDecompressorBase
 {
     private const int MaxPackedRowBytes = 16 * 1024 * 1024;
 
+    // Unpacked bytes per native batch: large enough to keep every core busy, small next to the planes being filled.
+    private const int NativeBatchBytes = 16 * 1024 * 1024;
+
     protected override PlaneImage Decompress8(PsdBigEndianReader reader, FileHeader header, PlaneRole[] roles, CancellationToken ct)
     {
         var width = header.Width;
@@ -129,6 +133,12 @@ internal sealed class PsdRleDecompressor : PsdDecompressorBase
         // Shared: read + validate row-byte-count table
         var rowByteCounts = ReadAndValidateRowByteCounts(reader, header, planeCount, height, ct);
 
+        if (PsdNative.IsAvailable)
+        {
+            DecodeRowRegionNative(reader, width, height, planeCount, rowByteCounts, yStart, yEnd, consumer, ct);
+            return;
+        }
+
         var packedRent = ArrayPool<byte>.Shared.Rent(64 * 1024);
         var unpackedRent = ArrayPool<byte>.Shared.Rent(width);
         var state = new RleRowDecodeState(packedRent);
@@ -170,6 +180,96 @@ internal sealed class PsdRleDecompressor : PsdDecompressorBase
         }
     }
 
+    /// <summary>
+    /// Native variant of the row-region decode. Packed rows of the region are gathered in file order
+    /// (plane-major) into batches of up to <see cref="NativeBatchBytes"/> unpacked bytes, which may span
+    /// plane boundaries; libpsd_native expands each batch on all cores, and the rows are then handed to
+    /// the consumer in the same order as the managed path.
+    /// </summary>
+    private static unsafe void DecodeRowRegionNative(PsdBigEndianReader reader, int width, int height, int planeCount, int[] rowByteCounts,
+        int yStart, int yEnd, IPlaneRowConsumer consumer, CancellationToken ct)
+    {
+        var regionRows = planeCount * (yEnd - yStart);
+        if (regionRows == 0)
+            return;
+
+        var batchRows = Math.Clamp(NativeBatchBytes / width, 1, regionRows);
+        var lengths = new int[batchRows];
+        var rowPlanes = new int[batchRows];
+        var rowYs = new int[batchRows];
+        var packed = ArrayPool<byte>.Shared.Rent(256 * 1024);
+        var unpacked = ArrayPool<byte>.Shared.Rent(batchRows * width);
+        var packedUsed = 0;
+        var pending = 0;
+
+        try
+        {
+            var rowIndex = 0;
+            for (var p = 0; p < planeCount; p++)
+            {
+                for (var y = 0; y < height; y++)
+                {
+                    var packedLen = rowByteCounts[rowIndex++];
+
+                    // Outside requested region: skip packed bytes without decoding.
+                    if (y < yStart || y >= yEnd)
+                    {
+                        reader.Skip(packedLen);
+                        continue;
+                    }
+
+                    if (packedUsed + packedLen > packed.Length)
+                    {
+                        var grown = ArrayPool<byte>.Shared.Rent(Math.Max(packed.Length * 2, packedUsed + packedLen));
+                        packed.AsSpan(0, packedUsed).CopyTo(grown);
+                        ArrayPool<byte>.Shared.Return(packed);
+                        packed = grown;
+                    }
+
+                    reader.ReadExactly(packed.AsSpan(packedUsed, packedLen));
+                    packedUsed += packedLen;
+                    lengths[pending] = packedLen;
+                    rowPlanes[pending] = p;
+                    rowYs[pending] = y;
+
+                    if (++pending == batchRows)
+                    {
+                        FlushBatch();
+                        pending = 0;
+                        packedUsed = 0;
+                    }
+                }
+            }
+
+            if (pending > 0)
+                FlushBatch();
+        }
+        finally
+        {
+            ArrayPool<byte>.Shared.Return(packed);
+            ArrayPool<byte>.Shared.Return(unpacked);
+        }
+
+        void FlushBatch()
+        {
+            ct.ThrowIfCancellationRequested();
+
+            using (var scope = new NativePsdControlScope(ct))
+            fixed (byte* src = packed)
+            fixed (int* len = lengths)
+            fixed (byte* dst = unpacked)
+            {
+                if (!PsdNative.psd_unpack_rows(src, len, pending, width, dst, width, scope.Control))
+                {
+                    ct.ThrowIfCancellationRequested();
+                    throw new InvalidOperationException(PsdNative.LastError());
+                }
+            }
+
+            for (var i = 0; i < pending; i++)
+                consumer.ConsumeRow(rowPlanes[i], rowYs[i], unpacked.AsSpan(i * width, width));
+        }
+    }
 
     private sealed class RleRowDecodeState(byte[] initialPackedBuffer)
     {
@@ -218,7 +318,7 @@ internal sealed class PsdRleDecompressor : PsdDecompressorBase
         PackBitsDecode(state.PackedBuffer.AsSpan(0, packedLen), unpackedRent.AsSpan(0, rowWidth));
     }
 
-    private static void PackBitsDecode(ReadOnlySpan<byte> src, Span<byte> dst)
+    internal static void PackBitsDecode(ReadOnlySpan<byte> src, Span<byte> dst)
     {
         var si = 0;
         var di = 0;
@@ -0,0 +1,134 @@
+using Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
+using Lyra.Imaging.Psd.Core.Interop;
+
+namespace Lyra.Imaging.Psd.Core.Decode.Pixel;
+
+/// <summary>
+/// Whole-surface counterpart of <see cref="PixelRowWriter"/> backed by libpsd_native: converts all rows
+/// of a plane image at once, spread over threads and vectorized. The curve-based paths produce output
+/// identical to the row writer; the grid path has no managed equivalent.
+/// Each method returns false without touching the surface when the native library is unavailable
+/// or the planes are too short, leaving the caller to fall back to the row writer.
+/// </summary>
+internal static class NativePlaneWriter
+{
+    public static bool TryWriteRgb(RgbaSurface dst, Plane r, Plane g, Plane b, Plane a, bool hasAlpha, bool useCalibration, RgbLuts cal, CancellationToken ct)
+    {
+        if (!PsdNative.IsAvailable)
+            return false;
+
+        var parameters = new NativePsdInterleaveParams
+        {
+            ColorPlanes = NativePsdColorPlanes.Rgb,
+            NeutralThreshold = -1
+        };
+
+        return Write(dst, [r, g, b], hasAlpha ? a : default, parameters, useCalibration ? cal : null, ct);
+    }
+
+    public static bool TryWriteCmyk(RgbaSurface dst, Plane c, Plane m, Plane y, Plane k, Plane a, bool hasAlpha,
+        bool useHeuristicTuning, PixelRowWriter.CmykHeuristicTuning tuning, RgbLuts cal, CancellationToken ct)
+    {
+        if (!PsdNative.IsAvailable)
+            return false;
+
+        var parameters = new NativePsdInterleaveParams
+        {
+            ColorPlanes = NativePsdColorPlanes.Cmyk,
+            NeutralThreshold = useHeuristicTuning && tuning.EnableNeutralBalance ? tuning.NeutralThreshold : -1,
+            NeutralRAdd = tuning.NeutralRAdd,
+            NeutralGAdd = tuning.NeutralGAdd,
+            NeutralBAdd = tuning.NeutralBAdd
+        };
+
+        var curves = useHeuristicTuning ? new RgbLuts(tuning.GammaLut, tuning.GammaLut, tuning.GammaLut) : cal;
+        return Write(dst, [c, m, y, k], hasAlpha ? a : default, parameters, curves, ct);
+    }
+
+    /// <summary>
+    /// Colour-managed CMYK through a baked profile grid, interpolated per pixel; no curves or neutral balance.
+    /// </summary>
+    public static unsafe bool TryWriteCmyk(RgbaSurface dst, Plane c, Plane m, Plane y, Plane k, Plane a, bool hasAlpha, CmykIccGrid grid, CancellationToken ct)
+    {
+        if (!PsdNative.IsAvailable)
+            return false;
+
+        fixed (byte* nodes = grid.Nodes)
+        {
+            var parameters = new NativePsdInterleaveParams
+            {
+                ColorPlanes = NativePsdColorPlanes.Cmyk,
+                NeutralThreshold = -1,
+                CmykGrid = (IntPtr)nodes,
+                CmykGridSize = grid.Size
+            };
+
+            return Write(dst, [c, m, y, k], hasAlpha ? a : default, parameters, null, ct);
+        }
+    }
+
+    private static unsafe bool Write(RgbaSurface dst, Plane[] color, Plane alpha, NativePsdInterleaveParams parameters, RgbLuts? curves, CancellationToken ct)
+    {
+        foreach (var plane in color)
+        {
+            if (!CoversSurface(plane, dst))
+                return false;
+        }
+
+        if (alpha.Data != null && alpha.Data.Length != 0 && !CoversSurface(alpha, dst))
+            return false;
+
+        parameters.Bgra = dst.Format.PixelFormat == PixelFormat.Bgra8888 ? 1 : 0;
+        parameters.Premultiply = dst.Format.AlphaType == AlphaType.Premultiplied ? 1 : 0;
+
+        Span<byte> curveTable = stackalloc byte[3 * 256];
+        if (curves is { } luts)
+        {
+            if (luts.R is null || luts.G is null || luts.B is null || luts.R.Length < 256 || luts.G.Length < 256 || luts.B.Length < 256)
+                return false;
+
+            luts.R.AsSpan(0, 256).CopyTo(curveTable);
+            luts.G.AsSpan(0, 256).CopyTo(curveTable[256..]);
+            luts.B.AsSpan(0, 256).CopyTo(curveTable[512..]);
+        }
+
+        var c3 = color.Length > 3 ? color[3] : default;
+        fixed (byte* p0 = color[0].Data, p1 = color[1].Data, p2 = color[2].Data, p3 = c3.Data, pa = alpha.Data)
+        fixed (byte* table = curveTable)
+        {
+            var planes = new NativePsdPlanes
+            {
+                Color0 = (IntPtr)p0,
+                Color1 = (IntPtr)p1,
+                Color2 = (IntPtr)p2,
+                Color3 = (IntPtr)p3,
+                Alpha = (IntPtr)pa,
+                ColorStride0 = color[0].BytesPerRow,
+                ColorStride1 = color[1].BytesPerRow,
+                ColorStride2 = color[2].BytesPerRow,
+                ColorStride3 = c3.BytesPerRow,
+                AlphaStride = alpha.BytesPerRow,
+                Width = dst.Width,
+                Height = dst.Height
+            };
+            parameters.Curves = curves is null ? IntPtr.Zero : (IntPtr)table;
+
+            using var pin = dst.Memory.Pin();
+            using var scope = new NativePsdControlScope(ct);
+            if (!PsdNative.psd_interleave_planes(planes, parameters, (byte*)pin.Pointer, dst.Stride, scope.Control))
+            {
+                ct.ThrowIfCancellationRequested();
+                throw new InvalidOperationException($"Native PSD conversion failed: {PsdNative.LastError()}");
+            }
+        }
+
+        return true;
+    }
+
+    private static bool CoversSurface(Plane plane, RgbaSurface dst)
+    {
+        return plane.Data != null
+               && plane.BytesPerRow >= dst.Width
+               && (long)plane.BytesPerRow * (dst.Height - 1) + dst.Width <= plane.Data.Length;
+    }
+}
@@ -0,0 +1,130 @@
+using System.Runtime.InteropServices;
+
+namespace Lyra.Imaging.Psd.Core.Interop;
+
+/// <summary>Mirrors psd_planes in native/PSDWrapper/psd_native.cpp: planar 8-bit channels of one image or tile.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativePsdPlanes
+{
+    public IntPtr Color0;
+    public IntPtr Color1;
+    public IntPtr Color2;
+    public IntPtr Color3;
+    public IntPtr Alpha;
+    public int ColorStride0;
+    public int ColorStride1;
+    public int ColorStride2;
+    public int ColorStride3;
+    public int AlphaStride;
+    public int Width;
+    public int Height;
+}
+
+/// <summary>Mirrors psd_color_planes.</summary>
+internal enum NativePsdColorPlanes
+{
+    Rgb = 0,
+    Cmyk = 1
+}
+
+/// <summary>Mirrors psd_interleave_params.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativePsdInterleaveParams
+{
+    public NativePsdColorPlanes ColorPlanes;
+    public int Bgra;
+    public int Premultiply;
+    public IntPtr Curves;
+    public int NeutralThreshold;
+    public int NeutralRAdd;
+    public int NeutralGAdd;
+    public int NeutralBAdd;
+    public IntPtr CmykGrid;
+    public int CmykGridSize;
+}
+
+/// <summary>
+/// Mirrors lyra_decode_control in native/Common/lyra_decode.h. PSD conversions fill only the cancel flag and the
+/// priority; the other fields stay null.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativePsdDecodeControl
+{
+    public IntPtr Cancel;
+    public IntPtr Progress;
+    public IntPtr User;
+    public int Priority; // lyra_decode_priority: 0 foreground, 1 background
+    public int MaxThreads;
+    public IntPtr Stats;
+    public IntPtr ImageStats;
+    public IntPtr Session;
+}
+
+/// <summary>
+/// Owns the native cancel flag for one native PSD call and raises it when the token is cancelled, so a stale
+/// preload stops inside the native row loops. The priority is read from <see cref="PsdDecodePriority"/> when created.
+/// </summary>
+internal sealed class NativePsdControlScope : IDisposable
+{
+    private readonly IntPtr _cancelFlag;
+    private readonly CancellationTokenRegistration _registration;
+
+    public NativePsdDecodeControl Control { get; }
+
+    public NativePsdControlScope(CancellationToken ct)
+    {
+        _cancelFlag = Marshal.AllocHGlobal(sizeof(int));
+        Marshal.WriteInt32(_cancelFlag, ct.IsCancellationRequested ? 1 : 0);
+        _registration = ct.Register(() => Marshal.WriteInt32(_cancelFlag, 1));
+
+        Control = new NativePsdDecodeControl
+        {
+            Cancel = _cancelFlag,
+            Priority = PsdDecodePriority.IsBackground ? 1 : 0
+        };
+    }
+
+    public void Dispose()
+    {
+        // Waits for a running cancel callback, so the flag is never written after it is freed.
+        _registration.Dispose();
+        Marshal.FreeHGlobal(_cancelFlag);
+    }
+}
+
+internal static class PsdNative
+{
+    private static readonly Lazy<bool> Available = new(Probe);
+
+    /// <summary>
+    /// True when libpsd_native can be loaded. Callers keep their managed path for when it cannot,
+    /// so a missing library only costs speed.
+    /// </summary>
+    public static bool IsAvailable => Available.Value;
+
+    [DllImport("libpsd_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr get_last_psd_error();
+
+    [DllImport("libpsd_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern unsafe bool psd_unpack_rows(byte* packed, int* lengths, int rows, int width, byte* dst, int dstStride, in NativePsdDecodeControl control);
+
+    [DllImport("libpsd_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern unsafe bool psd_interleave_planes(in NativePsdPlanes src, in NativePsdInterleaveParams parameters, byte* dst, int dstStride, in NativePsdDecodeControl control);
+
+    public static string LastError() => Marshal.PtrToStringAnsi(get_last_psd_error()) ?? "<null>";
+
+    private static bool Probe()
+    {
+        try
+        {
+            get_last_psd_error();
+            return true;
+        }
+        catch (Exception ex) when (ex is DllNotFoundException or EntryPointNotFoundException or BadImageFormatException)
+        {
+            return false;
+        }
+    }
+}
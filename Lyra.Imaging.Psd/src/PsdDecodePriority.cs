@@ -0,0 +1,29 @@
+namespace Lyra.Imaging.Psd;
+
+/// <summary>
+/// Thread priority of the native PSD work started on the current async flow. The host wraps each decode in
+/// <see cref="Use"/> with a callback that reports whether the image is only preloaded; native calls read it when they
+/// start, so an image becoming current gets every core from its next call on. Work started outside any scope runs
+/// in the foreground.
+/// </summary>
+public static class PsdDecodePriority
+{
+    private static readonly AsyncLocal<Func<bool>?> Background = new();
+
+    internal static bool IsBackground => Background.Value?.Invoke() == true;
+
+    /// <summary>
+    /// Applies <paramref name="isBackground"/> to PSD decodes on this flow, including tasks it starts, until disposed.
+    /// </summary>
+    public static IDisposable Use(Func<bool> isBackground)
+    {
+        var previous = Background.Value;
+        Background.Value = isBackground;
+        return new Scope(previous);
+    }
+
+    private sealed class Scope(Func<bool>? previous) : IDisposable
+    {
+        public void Dispose() => Background.Value = previous;
+    }
+}
@@ -1,5 +1,7 @@
 using System.Runtime.InteropServices;
 using Lyra.Common;
+using Lyra.Imaging.ConstraintsProvider;
+using Lyra.Imaging.Content;
 using Lyra.Imaging.Interop;
 
 namespace Lyra.Imaging.Codecs;
@@ -8,18 +10,157 @@ internal class ExrDecoder : FloatRgbaDecoderBase
 {
     public override bool CanDecode(ImageFormatType format) => format == ImageFormatType.Exr;
 
-    protected override bool LoadPixels(string path, out IntPtr ptr, out int width, out int height)
+    protected override bool Probe(string path, out NativeImageProbe probe)
     {
-        var result = ExrNative.load_exr_rgba(path, out ptr, out width, out height);
+        var result = ExrNative.probe_exr(path, out probe);
         if (!result)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override bool LoadPixels(string path, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        var result = ExrNative.load_exr_pixels(path, in target, in control, out isGrayscale);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override bool ReadPreviewSize(string path, int maxWidth, int maxHeight, out int width, out int height)
+    {
+        var result = ExrNative.read_exr_preview_size(path, maxWidth, maxHeight, out width, out height);
+        if (!result)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override bool LoadPreview(string path, int maxWidth, int maxHeight, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        var result = ExrNative.load_exr_preview(path, maxWidth, maxHeight, in target, in control, out isGrayscale);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override NativeImageLayer[] ListLayers(string path)
+    {
+        if (!ExrNative.list_exr_layers(path, null, 0, out var count))
+        {
+            LogNativeError();
+            return [];
+        }
+
+        var layers = new NativeImageLayer[count];
+        if (count > 0 && !ExrNative.list_exr_layers(path, layers, count, out _))
         {
-            var errorPtr = ExrNative.get_last_exr_error();
-            var error = Marshal.PtrToStringAnsi(errorPtr) ?? "<null>";
-            Logger.Error($"[ExrDecoder] Native error: {error}");
+            LogNativeError();
+            return [];
         }
 
+        return layers;
+    }
+
+    protected override bool LoadLayer(string path, in NativeImageLayer layer, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        var result = ExrNative.load_exr_layer(path, layer.Part, layer.Channels, in target, in control, out isGrayscale);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
         return result;
     }
 
-    protected override void FreePixels(IntPtr ptr) => ExrNative.free_exr_pixels(ptr);
-}
\ No newline at end of file
+    protected override IntPtr OpenBandReader(string path)
+    {
+        var reader = ExrNative.exr_scanline_open(path);
+        if (reader == IntPtr.Zero)
+            LogNativeError();
+
+        return reader;
+    }
+
+    protected override bool ReadBand(IntPtr reader, int firstRow, in NativeDecodeTarget target, in NativeDecodeControl control)
+    {
+        var result = ExrNative.exr_scanline_read(reader, firstRow, in target, in control, out _);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override void CloseBandReader(IntPtr reader) => ExrNative.exr_scanline_close(reader);
+
+    protected override NativeDecodeSession Session => NativeDecodeSession.Exr;
+
+    /// <summary>
+    /// Mipmapped/ripmapped tiled files already carry every zoom level, so nothing is decoded up front beyond
+    /// the level that fits the display; finer levels are read tile by tile as the view needs them.
+    /// </summary>
+    protected override bool TryDecodeLarge(Composite composite, string path, NativeImageProbe probe, CancellationToken ct)
+    {
+        if (!probe.Tiled || probe.LevelMode == NativeLevelMode.One)
+            return false;
+
+        var constraints = DecodeConstraintsProvider.Current;
+        if (constraints.Width <= 0 || constraints.Height <= 0)
+            return false;
+
+        var handle = ExrNative.exr_tiled_open(path);
+        if (handle == IntPtr.Zero)
+        {
+            LogNativeError();
+            return false;
+        }
+
+        ExrTiledTileSource tileSource;
+        try
+        {
+            tileSource = new ExrTiledTileSource(handle, path, probe.TileWidth, probe.TileHeight);
+        }
+        catch (Exception ex)
+        {
+            ExrNative.exr_tiled_close(handle);
+            Logger.Warning($"[ExrDecoder] Tiled read unavailable, decoding whole image: {path}\n{ex.Message}");
+            return false;
+        }
+
+        try
+        {
+            var fitScale = MathF.Min((float)constraints.Width / probe.Width, (float)constraints.Height / probe.Height);
+            var previewImage = tileSource.DecodePreview(fitScale, PriorityOf(composite), ct, out composite.IsGrayscale);
+            if (previewImage == null)
+            {
+                tileSource.Dispose();
+                return false;
+            }
+
+            var rasterLarge = new RasterLargeContent(probe.Width, probe.Height);
+            rasterLarge.SetPreview(previewImage);
+            rasterLarge.SetTiles(tileSource);
+
+            composite.FullWidth = probe.Width;
+            composite.FullHeight = probe.Height;
+            composite.Content = rasterLarge;
+            composite.SignalReady();
+
+            // Tiles stream on demand for as long as the image is shown; there is no "all tiles done" to wait for.
+            composite.SignalComplete();
+            return true;
+        }
+        catch
+        {
+            tileSource.Dispose();
+            throw;
+        }
+    }
+
+    private static void LogNativeError()
+    {
+        var errorPtr = ExrNative.get_last_exr_error();
+        var error = Marshal.PtrToStringAnsi(errorPtr) ?? "<null>";
+        Logger.Error($"[ExrDecoder] Native error: {error}");
+    }
+}
@@ -0,0 +1,324 @@
+using System.Runtime.InteropServices;
+using Lyra.Common;
+using Lyra.Imaging.Content;
+using Lyra.Imaging.Interop;
+using SkiaSharp;
+
+namespace Lyra.Imaging.Codecs;
+
+/// <summary>
+/// On-demand tiles for a mipmapped/ripmapped tiled EXR. Only the level matching the current zoom and
+/// only the tiles in view are read, nearest the focus first; decoded tiles are kept in an LRU under a byte budget.
+/// Owns the native reader handle.
+/// </summary>
+internal sealed class ExrTiledTileSource : ITileSource
+{
+    // EXR tiles are often 32-128 px; group them into display tiles of about this edge so one read covers several.
+    private const int DisplayTileEdge = 512;
+
+    private const long CacheBudgetBytes = 256L * 1024 * 1024;
+
+    private readonly record struct Level(int Width, int Height, int TilesX, int TilesY, int GroupsX, int GroupsY);
+    private readonly record struct TileKey(int Level, int X, int Y);
+    private readonly record struct ViewKey(int Level, int MinX, int MinY, int MaxX, int MaxY);
+    private sealed record CachedTile(TileKey Key, SKImage Image, long Bytes);
+
+    private readonly string _path;
+    private readonly int _tileWidth;
+    private readonly int _tileHeight;
+    private readonly int _groupX;
+    private readonly int _groupY;
+    private readonly Level[] _levels;
+
+    private readonly TileDecodeScheduler _scheduler = new();
+    private readonly object _gate = new();
+    private readonly Dictionary<TileKey, LinkedListNode<CachedTile>> _cache = new();
+    private readonly LinkedList<CachedTile> _lru = new(); // most recently drawn first
+    private long _cachedBytes;
+
+    private List<TileKey> _wanted = [];
+    private ViewKey? _view;
+    private int _viewGeneration;
+    private SKSize _imageSize;
+
+    private readonly SemaphoreSlim _signal = new(0);
+    private readonly CancellationTokenSource _cts = new();
+    private readonly Task _worker;
+    private IntPtr _handle;
+
+    public ExrTiledTileSource(IntPtr handle, string path, int tileWidth, int tileHeight)
+    {
+        _path = path;
+        _tileWidth = tileWidth;
+        _tileHeight = tileHeight;
+        _groupX = Math.Max(1, DisplayTileEdge / tileWidth);
+        _groupY = Math.Max(1, DisplayTileEdge / tileHeight);
+
+        var levelCount = ExrNative.exr_tiled_level_count(handle);
+        _levels = new Level[levelCount];
+        for (var i = 0; i < levelCount; i++)
+        {
+            if (!ExrNative.exr_tiled_level_info(handle, i, out var width, out var height, out var tilesX, out var tilesY))
+                throw new InvalidOperationException($"[ExrTiledTileSource] Failed to read level {i}: {LastError()}");
+
+            _levels[i] = new Level(width, height, tilesX, tilesY, (tilesX + _groupX - 1) / _groupX, (tilesY + _groupY - 1) / _groupY);
+        }
+
+        if (levelCount == 0)
+            throw new InvalidOperationException($"[ExrTiledTileSource] No readable levels: {path}");
+
+        _handle = handle;
+        _worker = Task.Factory.StartNew(Run, TaskCreationOptions.LongRunning);
+    }
+
+    public int FullWidth => _levels[0].Width;
+    public int FullHeight => _levels[0].Height;
+
+    /// <summary>
+    /// Reads the whole coarsest level that still provides <paramref name="pixelsPerFullUnit"/>, as an RGBA8 preview.
+    /// </summary>
+    public SKImage? DecodePreview(float pixelsPerFullUnit, NativeDecodePriority priority, CancellationToken ct, out bool isGrayscale)
+    {
+        var level = SelectLevel(pixelsPerFullUnit);
+        var info = _levels[level];
+        Logger.Debug($"[ExrTiledTileSource] Preview from level {level} ({info.Width}x{info.Height}) of {FullWidth}x{FullHeight}: {_path}");
+
+        return ReadRegion(level, 0, 0, info.TilesX - 1, info.TilesY - 1, priority, ct, out isGrayscale);
+    }
+
+    public IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize, float pixelsPerFullUnit)
+    {
+        if (visibleFullRect.IsEmpty || _handle == IntPtr.Zero)
+            return [];
+
+        _scheduler.UpdateFocus(visibleFullRect);
+
+        var levelIndex = SelectLevel(pixelsPerFullUnit);
+        var level = _levels[levelIndex];
+        var unitsX = imageSize.Width / level.Width; // full units per level pixel
+        var unitsY = imageSize.Height / level.Height;
+        var groupW = _groupX * _tileWidth * unitsX;
+        var groupH = _groupY * _tileHeight * unitsY;
+
+        var view = new ViewKey(
+            levelIndex,
+            Math.Clamp((int)MathF.Floor(visibleFullRect.Left / groupW), 0, level.GroupsX - 1),
+            Math.Clamp((int)MathF.Floor(visibleFullRect.Top / groupH), 0, level.GroupsY - 1),
+            Math.Clamp((int)MathF.Floor((visibleFullRect.Right - 1) / groupW), 0, level.GroupsX - 1),
+            Math.Clamp((int)MathF.Floor((visibleFullRect.Bottom - 1) / groupH), 0, level.GroupsY - 1));
+
+        var tiles = new List<RasterTile>();
+        var missing = new List<TileKey>();
+
+        lock (_gate)
+        {
+            for (var y = view.MinY; y <= view.MaxY; y++)
+            for (var x = view.MinX; x <= view.MaxX; x++)
+            {
+                var key = new TileKey(levelIndex, x, y);
+                if (!_cache.TryGetValue(key, out var node))
+                {
+                    missing.Add(key);
+                    continue;
+                }
+
+                _lru.Remove(node);
+                _lru.AddFirst(node);
+
+                var image = node.Value.Image;
+                tiles.Add(new RasterTile(image, SKRect.Create(x * groupW, y * groupH, image.Width * unitsX, image.Height * unitsY)));
+            }
+
+            // Only a new view replaces the request list; stale requests are dropped by the worker.
+            if (_view != view)
+            {
+                _view = view;
+                _imageSize = imageSize;
+                _wanted = missing;
+                _viewGeneration++;
+
+                if (missing.Count > 0 && _signal.CurrentCount == 0)
+                    _signal.Release();
+            }
+        }
+
+        return tiles;
+    }
+
+    /// <summary>Coarsest level that still provides the requested pixels per full-image unit (5% upscale tolerated).</summary>
+    private int SelectLevel(float pixelsPerFullUnit)
+    {
+        for (var i = _levels.Length - 1; i > 0; i--)
+        {
+            var scale = MathF.Min((float)_levels[i].Width / FullWidth, (float)_levels[i].Height / FullHeight);
+            if (scale * 1.05f >= pixelsPerFullUnit)
+                return i;
+        }
+
+        return 0;
+    }
+
+    private void Run()
+    {
+        var ct = _cts.Token;
+        try
+        {
+            while (true)
+            {
+                _signal.Wait(ct);
+
+                List<TileKey> batch;
+                List<SKRect> rects;
+                SKSize imageSize;
+                int generation;
+                lock (_gate)
+                {
+                    batch = _wanted;
+                    generation = _viewGeneration;
+                    imageSize = _imageSize;
+                    _wanted = [];
+                    rects = batch.Select(key => GroupRect(key, imageSize)).ToList();
+                }
+
+                foreach (var index in _scheduler.BuildTileOrder(rects, imageSize))
+                {
+                    if (Volatile.Read(ref _viewGeneration) != generation)
+                        break;
+
+                    DecodeTile(batch[index], ct);
+                }
+            }
+        }
+        catch (OperationCanceledException)
+        {
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"[ExrTiledTileSource] Tile decode failed: {_path}\n{ex}");
+        }
+    }
+
+    private SKRect GroupRect(TileKey key, SKSize imageSize)
+    {
+        var level = _levels[key.Level];
+        var groupW = _groupX * _tileWidth * imageSize.Width / level.Width;
+        var groupH = _groupY * _tileHeight * imageSize.Height / level.Height;
+        return SKRect.Create(key.X * groupW, key.Y * groupH, groupW, groupH);
+    }
+
+    private void DecodeTile(TileKey key, CancellationToken ct)
+    {
+        lock (_gate)
+        {
+            if (_cache.ContainsKey(key))
+                return;
+        }
+
+        var level = _levels[key.Level];
+        var tx0 = key.X * _groupX;
+        var ty0 = key.Y * _groupY;
+        var tx1 = Math.Min(tx0 + _groupX, level.TilesX) - 1;
+        var ty1 = Math.Min(ty0 + _groupY, level.TilesY) - 1;
+
+        // Tiles are only requested while the image is drawn.
+        var image = ReadRegion(key.Level, tx0, ty0, tx1, ty1, NativeDecodePriority.Foreground, ct, out _);
+        if (image == null)
+            return;
+
+        lock (_gate)
+        {
+            var bytes = (long)image.Width * image.Height * 4;
+            _cache[key] = _lru.AddFirst(new CachedTile(key, image, bytes));
+            _cachedBytes += bytes;
+
+            // Evict least recently drawn tiles, but never those of the current view.
+            while (_cachedBytes > CacheBudgetBytes && _lru.Last is { } last && !IsInView(last.Value.Key))
+            {
+                _lru.RemoveLast();
+                _cache.Remove(last.Value.Key);
+                _cachedBytes -= last.Value.Bytes;
+                last.Value.Image.Dispose();
+            }
+        }
+    }
+
+    private bool IsInView(TileKey key) =>
+        _view is { } v && key.Level == v.Level && key.X >= v.MinX && key.X <= v.MaxX && key.Y >= v.MinY && key.Y <= v.MaxY;
+
+    private SKImage? ReadRegion(int level, int tx0, int ty0, int tx1, int ty1, NativeDecodePriority priority, CancellationToken ct, out bool isGrayscale)
+    {
+        isGrayscale = false;
+
+        var info = _levels[level];
+        var width = Math.Min((tx1 + 1) * _tileWidth, info.Width) - tx0 * _tileWidth;
+        var height = Math.Min((ty1 + 1) * _tileHeight, info.Height) - ty0 * _tileHeight;
+
+        var bitmap = new SKBitmap(new SKImageInfo(width, height, SKColorType.Rgba8888, SKAlphaType.Unpremul));
+        if (bitmap.GetPixels() == IntPtr.Zero)
+        {
+            bitmap.Dispose();
+            return null;
+        }
+
+        var target = new NativeDecodeTarget
+        {
+            Pixels = bitmap.GetPixels(),
+            Width = width,
+            Height = height,
+            Stride = bitmap.RowBytes,
+            Format = NativePixelFormat.Rgba8
+        };
+
+        bool loaded;
+        using (var scope = new NativeDecodeControlScope(ct, priority: priority, session: NativeDecodeSession.Exr.Handle))
+        {
+            var control = scope.Control;
+            loaded = ExrNative.exr_tiled_read(_handle, level, tx0, ty0, tx1, ty1, in target, in control, out isGrayscale);
+            if (!loaded && !control.IsCancelled)
+                Logger.Error($"[ExrTiledTileSource] Native error: {LastError()}");
+        }
+
+        if (!loaded)
+        {
+            bitmap.Dispose();
+            ct.ThrowIfCancellationRequested();
+            return null;
+        }
+
+        bitmap.SetImmutable();
+        using var pixmap = new SKPixmap(bitmap.Info, bitmap.GetPixels(), bitmap.RowBytes);
+        return SKImage.FromPixels(pixmap, FloatRgbaDecoderBase.ReleaseBitmapOnImageDispose, bitmap);
+    }
+
+    private static string LastError() => Marshal.PtrToStringAnsi(ExrNative.get_last_exr_error()) ?? "<null>";
+
+    public void Dispose()
+    {
+        // Raises the native cancel flag of an in-flight read, then waits for the worker before closing the handle.
+        _cts.Cancel();
+        try
+        {
+            _worker.Wait();
+        }
+        catch (AggregateException)
+        {
+        }
+
+        var handle = Interlocked.Exchange(ref _handle, IntPtr.Zero);
+        if (handle != IntPtr.Zero)
+            ExrNative.exr_tiled_close(handle);
+
+        lock (_gate)
+        {
+            foreach (var tile in _lru)
+                tile.Image.Dispose();
+
+            _lru.Clear();
+            _cache.Clear();
+            _cachedBytes = 0;
+        }
+
+        _cts.Dispose();
+        _signal.Dispose();
+    }
+}
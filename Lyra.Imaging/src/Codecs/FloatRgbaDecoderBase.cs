@@ -1,16 +1,99 @@
 using Lyra.Common;
 using Lyra.Common.SystemExtensions;
+using Lyra.Imaging.ConstraintsProvider;
 using Lyra.Imaging.Content;
+using Lyra.Imaging.Interop;
 using SkiaSharp;
 using static System.Threading.Thread;
 
 namespace Lyra.Imaging.Codecs;
 
+/// <summary>
+/// Base for float HDR formats decoded by a native library. The native side writes straight
+/// into the bitmap's pixel memory, so no intermediate buffer ever crosses into managed code.
+/// </summary>
 internal abstract class FloatRgbaDecoderBase : IImageDecoder
 {
+    private const float PreviewSizeMultiplier = 2.0f;
+
+    // Float decodes cost far more per pixel than PSD, so previews start well below PsdDecoder's 256 MB.
+    private const long PreviewThresholdBytes = 64L * 1024 * 1024;
+
+    // Above this (RGBA8 bytes) the image is streamed into tiles band by band instead of one monolithic bitmap.
+    private const long StreamThresholdBytes = 256L * 1024 * 1024;
+    private const int StreamTileEdge = 1024;
+
+    // RGBA8 band plus the native side's worst-case float32 RGBA conversion scratch.
+    private const int StreamBytesPerPixel = 4 + 16;
+
+    // Largest retained copy (half float or RGBE bytes) kept for re-tonemapping; 16k x 8k RGBE or 8k x 8k half floats.
+    private const long RetainMaxBytes = 512L * 1024 * 1024;
+
     public abstract bool CanDecode(ImageFormatType format);
-    protected abstract bool LoadPixels(string path, out IntPtr ptr, out int width, out int height);
-    protected abstract void FreePixels(IntPtr ptr);
+    protected abstract bool Probe(string path, out NativeImageProbe probe);
+    protected abstract bool LoadPixels(string path, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale);
+    protected abstract bool ReadPreviewSize(string path, int maxWidth, int maxHeight, out int width, out int height);
+    protected abstract bool LoadPreview(string path, int maxWidth, int maxHeight, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale);
+
+    /// <summary>Opens a native reader for decoding row bands in any order; <see cref="IntPtr.Zero"/> if the file cannot be read by band.</summary>
+    protected abstract IntPtr OpenBandReader(string path);
+    protected abstract bool ReadBand(IntPtr reader, int firstRow, in NativeDecodeTarget target, in NativeDecodeControl control);
+    protected abstract void CloseBandReader(IntPtr reader);
+
+    /// <summary>Scratch pool of the format's native library, shared by all of its decodes.</summary>
+    protected abstract NativeDecodeSession Session { get; }
+
+    /// <summary>The native decoder can write the file's own RGBE samples (<see cref="NativePixelFormat.Rgbe8"/>).</summary>
+    protected virtual bool CanDecodeRgbe => false;
+
+    /// <summary>Layers of multi-layer formats (EXR parts/AOVs). Empty when the format has none.</summary>
+    protected virtual NativeImageLayer[] ListLayers(string path) => [];
+
+    /// <summary>Decodes only the channels of <paramref name="layer"/> into a target of the layer's size.</summary>
+    protected virtual bool LoadLayer(string path, in NativeImageLayer layer, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        isGrayscale = false;
+        return false;
+    }
+
+    /// <summary>
+    /// Keep EXR/HDR content as linear half floats (8 B/px) instead of tone-mapping it to RGBA8.
+    /// Preserves the dynamic range at half the memory of float32.
+    /// </summary>
+    public static bool RetainHalfFloat { get; set; }
+
+    /// <summary>
+    /// Keep a linear copy (half floats, 8 B/px) of images decoded to RGBA8, so <see cref="ToneMapping"/> changes
+    /// re-encode them instead of decoding again. Off by default: RGBA8 is then decoded directly at 4 B/px.
+    /// </summary>
+    public static bool RetainForToneMapping { get; set; }
+
+    /// <summary>
+    /// Retain Radiance images as their RGBE samples (4 B/px) rather than half floats (8 B/px), even without
+    /// <see cref="RetainForToneMapping"/>. Cached images not on screen then keep only those, and are tone-mapped
+    /// again when shown.
+    /// </summary>
+    public static bool RetainRgbe { get; set; }
+
+    /// <summary>
+    /// Upper bound on the transient memory of a streamed decode: the band being decoded plus native scratch.
+    /// Decoded tiles are retained content and not counted.
+    /// </summary>
+    public static long StreamBandBudgetBytes { get; set; } = 64L * 1024 * 1024;
+
+    /// <summary>
+    /// Display transform for images decoded to RGBA8. Only retained images follow it (see <see cref="Retains"/>): they
+    /// are decoded to half floats (or RGBE) first and kept, so later changes re-encode them (<see cref="RetainedHdr"/>)
+    /// instead of decoding again. Large ones are then shown as a preview plus the visible tiles. Others keep the
+    /// load-time curve.
+    /// </summary>
+    public static ToneMapSettings ToneMapping { get; set; } = ToneMapSettings.Default;
+
+    /// <summary>Layout retained images are decoded to before tone mapping.</summary>
+    private NativePixelFormat RetainedFormat => RetainRgbe && CanDecodeRgbe ? NativePixelFormat.Rgbe8 : NativePixelFormat.RgbaF16;
+
+    /// <summary>Layout the native decoder writes. RGBA8 is tone-mapped for display; float formats stay linear.</summary>
+    protected virtual NativePixelFormat OutputFormat => RetainHalfFloat ? NativePixelFormat.RgbaF16 : NativePixelFormat.Rgba8;
 
     public Task DecodeAsync(Composite composite, CancellationToken ct)
     {
@@ -20,78 +103,515 @@ internal abstract class FloatRgbaDecoderBase : IImageDecoder
 
         ct.ThrowIfCancellationRequested();
 
-        var success = LoadPixels(path, out var ptr, out var width, out var height);
-        if (!success || ptr == IntPtr.Zero)
-            throw new InvalidOperationException($"[{GetType().Name}] Failed to load native pixels or got null pointer for: {path}");
+        if (!Probe(path, out var probe))
+            throw new InvalidOperationException($"[{GetType().Name}] Failed to read image header for: {path}");
+
+        ProcessProbe(probe, composite);
+
+        // A non-default layer is decoded on its own; the large-image paths below only know the default layer.
+        if (ProcessLayers(ListLayers(path), composite) is { } layer)
+            return DecodeLayer(composite, path, layer, ct);
+
+        var width = probe.Width;
+        var height = probe.Height;
+        var format = OutputFormat;
+        var retain = Retains(format, width, height);
+
+        // Large image: use the format's own large-image path where it has one. Otherwise publish a
+        // box-filtered preview first, then either stream tiles band by band or replace it with the full decode.
+        // Retained images are always decoded whole, since re-tonemapping needs every pixel.
+        // A preview from the on-disk cache is already on screen; it is reused rather than decoded again and
+        // stays owned by ImageLoader.
+        RasterLargeContent? previewContent = null;
+        RasterLargeContent? cachedPreview = null;
+        if ((long)width * height * 4L >= PreviewThresholdBytes)
+        {
+            if (TryDecodeLarge(composite, path, probe, ct))
+                return Task.CompletedTask;
+
+            if (composite.Content is RasterLargeContent { HasPreview: true, HasTiles: false } cached && (int)cached.FullWidth == width && (int)cached.FullHeight == height)
+                cachedPreview = cached;
+
+            previewContent = cachedPreview ?? TryPublishPreview(composite, path, width, height, ct);
+            if (previewContent != null && !retain && TryStreamBands(composite, path, width, height, previewContent, ct))
+                return Task.CompletedTask;
+        }
+
+        var decodeFormat = retain ? RetainedFormat : format;
+        var info = new SKImageInfo(width, height, ToColorType(decodeFormat), SKAlphaType.Unpremul);
+        var bitmap = new SKBitmap(info);
 
         try
         {
-            ct.ThrowIfCancellationRequested();
+            if (bitmap.GetPixels() == IntPtr.Zero)
+                throw new InvalidOperationException($"[{GetType().Name}] Failed to allocate {width}x{height} bitmap for: {path}");
 
-            var totalPixels = checked(width * height);
-            var floatCount = checked(totalPixels * 4);
+            ct.ThrowIfCancellationRequested();
 
-            var info = new SKImageInfo(width, height, SKColorType.Rgba8888, SKAlphaType.Unpremul);
-            var bitmap = new SKBitmap(info);
+            var target = new NativeDecodeTarget
+            {
+                Pixels = bitmap.GetPixels(),
+                Width = width,
+                Height = height,
+                Stride = bitmap.RowBytes,
+                Format = decodeFormat
+            };
 
-            unsafe
+            bool loaded;
+            using (var scope = new NativeDecodeControlScope(ct, (rowsDone, rowsTotal) => composite.LoadProgress = (double)rowsDone / rowsTotal, PriorityOf(composite), collectStats: true,
+                       collectImageStats: true, session: Session.Handle))
             {
-                var floatSpan = new Span<float>((void*)ptr, floatCount);
-                var byteSpan = new Span<byte>((void*)bitmap.GetPixels(), checked(width * height * 4));
+                var control = scope.Control;
+                loaded = LoadPixels(path, in target, in control, out composite.IsGrayscale);
+                RecordStages(composite, scope, "Decode", path);
+                RecordStatistics(composite, scope, "Decode", path);
+            }
 
-                ConvertPixels(floatSpan, byteSpan, width, height, ct, out composite.IsGrayscale);
+            if (!loaded)
+            {
+                ct.ThrowIfCancellationRequested();
+                throw new InvalidOperationException($"[{GetType().Name}] Failed to load native pixels for: {path}");
             }
 
             ct.ThrowIfCancellationRequested();
 
             bitmap.SetImmutable();
-            var image = SKImage.FromBitmap(bitmap);
-
-            composite.Content = new RasterContent(bitmap, image);
+            PublishRaster(composite, bitmap, format, decodeFormat);
+            if (!ReferenceEquals(previewContent, cachedPreview))
+                previewContent?.Dispose();
         }
-        finally
+        catch
         {
-            FreePixels(ptr);
+            bitmap.Dispose();
+            throw;
         }
 
         return Task.CompletedTask;
     }
 
-    private void ConvertPixels(Span<float> floatSpan, Span<byte> byteSpan, int width, int height, CancellationToken ct, out bool isGrayscale)
+    /// <summary>
+    /// Publishes a large image as preview plus on-demand tiles instead of decoding it whole.
+    /// Returns false to fall back to the preview + full decode path.
+    /// </summary>
+    protected virtual bool TryDecodeLarge(Composite composite, string path, NativeImageProbe probe, CancellationToken ct) => false;
+
+    public long? ProbeDecodeCost(string path) => Probe(path, out var probe) ? probe.DecodeCost : null;
+
+    private static void ProcessProbe(NativeImageProbe probe, Composite composite)
     {
-        var totalPixels = width * height;
+        composite.FormatSpecific.Add("Channels", $"{probe.ChannelCount} ({probe.Channels.Replace(";", ", ")})");
+        composite.FormatSpecific.Add("Compression", probe.Compression);
 
-        isGrayscale = true;
-        for (var i = 0; i < totalPixels && isGrayscale; i++)
+        if (!probe.DataWindow.SequenceEqual(probe.DisplayWindow))
         {
-            if ((i & 0xFFFF) == 0)
-                ct.ThrowIfCancellationRequested();
+            composite.FormatSpecific.Add("Data Window", WindowToStr(probe.DataWindow));
+            composite.FormatSpecific.Add("Display Window", WindowToStr(probe.DisplayWindow));
+        }
 
-            if (floatSpan[i * 4 + 1] != 0f || floatSpan[i * 4 + 2] != 0f)
-                isGrayscale = false;
+        if (probe.Tiled)
+        {
+            var levels = probe.LevelMode == NativeLevelMode.One ? "single level" : $"{probe.LevelCount} {probe.LevelMode.ToString().ToLower()} levels";
+            composite.FormatSpecific.Add("Tiles", $"{probe.TileWidth}x{probe.TileHeight}, {levels}");
         }
 
-        for (var i = 0; i < totalPixels; i++)
+        if (probe.PartCount > 1)
+            composite.FormatSpecific.Add("Parts", $"{probe.PartCount}");
+    }
+
+    /// <summary>Publishes the layer list and returns the selected layer unless it is the default one.</summary>
+    private static NativeImageLayer? ProcessLayers(NativeImageLayer[] layers, Composite composite)
+    {
+        if (layers.Length < 2)
+            return null;
+
+        composite.LayerIndex = Math.Clamp(composite.LayerIndex, 0, layers.Length - 1);
+        composite.Layers = layers.Select(l => l.DisplayName).ToArray();
+
+        var layer = layers[composite.LayerIndex];
+        composite.FormatSpecific.Add("Layer", $"{layer.DisplayName} ({composite.LayerIndex + 1}/{layers.Length}, {layer.ChannelCount} ch)");
+
+        return layer.IsDefault ? null : layer;
+    }
+
+    private Task DecodeLayer(Composite composite, string path, NativeImageLayer layer, CancellationToken ct)
+    {
+        var format = OutputFormat;
+        var retain = Retains(format, layer.Width, layer.Height);
+        var decodeFormat = retain ? RetainedFormat : format;
+        var bitmap = new SKBitmap(new SKImageInfo(layer.Width, layer.Height, ToColorType(decodeFormat), SKAlphaType.Unpremul));
+
+        try
         {
-            if ((i & 0xFFFF) == 0)
+            if (bitmap.GetPixels() == IntPtr.Zero)
+                throw new InvalidOperationException($"[{GetType().Name}] Failed to allocate {layer.Width}x{layer.Height} bitmap for layer {layer.DisplayName}: {path}");
+
+            ct.ThrowIfCancellationRequested();
+
+            var target = new NativeDecodeTarget
+            {
+                Pixels = bitmap.GetPixels(),
+                Width = layer.Width,
+                Height = layer.Height,
+                Stride = bitmap.RowBytes,
+                Format = decodeFormat
+            };
+
+            bool loaded;
+            using (var scope = new NativeDecodeControlScope(ct, (rowsDone, rowsTotal) => composite.LoadProgress = (double)rowsDone / rowsTotal, PriorityOf(composite), collectStats: true,
+                       collectImageStats: true, session: Session.Handle))
+            {
+                var control = scope.Control;
+                loaded = LoadLayer(path, in layer, in target, in control, out composite.IsGrayscale);
+                RecordStages(composite, scope, $"Layer {layer.DisplayName}", path);
+                RecordStatistics(composite, scope, $"Layer {layer.DisplayName}", path);
+            }
+
+            if (!loaded)
+            {
                 ct.ThrowIfCancellationRequested();
+                throw new InvalidOperationException($"[{GetType().Name}] Failed to load layer {layer.DisplayName} for: {path}");
+            }
+
+            ct.ThrowIfCancellationRequested();
+
+            bitmap.SetImmutable();
+            PublishRaster(composite, bitmap, format, decodeFormat);
+        }
+        catch
+        {
+            bitmap.Dispose();
+            throw;
+        }
+
+        return Task.CompletedTask;
+    }
+
+    /// <summary>
+    /// True when an image decoded for <paramref name="format"/> keeps a linear copy for re-tonemapping: only when
+    /// retention is switched on and the copy fits <see cref="RetainMaxBytes"/>.
+    /// </summary>
+    private bool Retains(NativePixelFormat format, int width, int height)
+    {
+        if (format != NativePixelFormat.Rgba8)
+            return false;
+
+        var rgbe = RetainedFormat == NativePixelFormat.Rgbe8;
+        return (RetainForToneMapping || rgbe) && (long)width * height * (rgbe ? 4 : 8) <= RetainMaxBytes;
+    }
+
+    /// <summary>
+    /// Publishes a decoded bitmap as raster content. A bitmap decoded to another format than the output one is retained:
+    /// tone-mapped to RGBA8 for display and kept on the composite for re-tonemapping; a large one is shown as a preview
+    /// with tiles. Otherwise the bitmap itself is shown. Images whose alpha is constant 1 are drawn as opaque, which
+    /// skips blending.
+    /// </summary>
+    private static void PublishRaster(Composite composite, SKBitmap bitmap, NativePixelFormat format, NativePixelFormat decodeFormat)
+    {
+        var opaque = composite.Statistics?.AlphaOpaque == true;
+        if (decodeFormat == format)
+        {
+            composite.Content = new RasterContent(bitmap, opaque ? OpaqueImage(bitmap) : SKImage.FromBitmap(bitmap), isLinear: format != NativePixelFormat.Rgba8);
+            return;
+        }
+
+        var previewSize = RetainedPreviewSize(bitmap.Width, bitmap.Height);
+        var retained = new RetainedHdr(bitmap, decodeFormat, opaque, previewSize);
+        if (previewSize != null)
+        {
+            composite.FullWidth = bitmap.Width;
+            composite.FullHeight = bitmap.Height;
+        }
+
+        composite.Content = retained.ToneMap(ToneMapping);
+        composite.RetainedHdr = retained; // after Content: the render thread re-tonemaps only composites with both
+    }
+
+    /// <summary>
+    /// Preview size of a retained image above the preview threshold: the whole box-filter factor that fits it into the
+    /// preview constraints, as the native previews compute it. Null when the image is shown whole.
+    /// </summary>
+    private static SKSizeI? RetainedPreviewSize(int width, int height)
+    {
+        if ((long)width * height * 4L < PreviewThresholdBytes)
+            return null;
 
-            var r = floatSpan[i * 4 + 0];
-            var g = isGrayscale ? r : floatSpan[i * 4 + 1];
-            var b = isGrayscale ? r : floatSpan[i * 4 + 2];
-            var a = floatSpan[i * 4 + 3];
+        var constraints = DecodeConstraintsProvider.Current;
+        var maxWidth = (int)(constraints.Width * PreviewSizeMultiplier);
+        var maxHeight = (int)(constraints.Height * PreviewSizeMultiplier);
+        if (maxWidth <= 0 || maxHeight <= 0)
+            return null;
 
-            var idx = i * 4;
-            byteSpan[idx + 0] = ToneMap(r);
-            byteSpan[idx + 1] = ToneMap(g);
-            byteSpan[idx + 2] = ToneMap(b);
-            byteSpan[idx + 3] = ToneMap(a);
+        var factor = Math.Max(Math.Max(1, (width + maxWidth - 1) / maxWidth), (height + maxHeight - 1) / maxHeight);
+        return factor > 1 ? new SKSizeI((width + factor - 1) / factor, (height + factor - 1) / factor) : null;
+    }
+
+    /// <summary>An image over the bitmap's pixels (not a copy) that declares them opaque; the bitmap must outlive it.</summary>
+    private static SKImage OpaqueImage(SKBitmap bitmap)
+    {
+        using var pixmap = bitmap.PeekPixels();
+        using var opaque = pixmap.WithAlphaType(SKAlphaType.Opaque);
+        return SKImage.FromPixels(opaque);
+    }
+
+    /// <summary>
+    /// Re-encodes a composite's retained pixels with <see cref="ToneMapping"/> when its content was made with other
+    /// settings or released while cached. Runs on the thread that draws the composite, which owns swapping its content.
+    /// </summary>
+    /// <returns>True when the content was replaced.</returns>
+    internal static bool ApplyToneMapping(Composite composite)
+    {
+        var retained = composite.RetainedHdr;
+        if (retained == null || retained.Faulted || composite.State == CompositeState.Disposed || (composite.Content != null && retained.Applied == ToneMapping))
+            return false;
+
+        ICompositeContent content;
+        try
+        {
+            content = retained.ToneMap(ToneMapping);
+        }
+        catch (Exception ex)
+        {
+            // Keep showing the current pixels, and stop retrying every frame. They live in the retained output, so the
+            // retained copy stays until the composite goes. Released content cannot come back.
+            Logger.Warning($"[{nameof(FloatRgbaDecoderBase)}] Re-tonemapping failed, keeping current settings: {composite.FileInfo.FullName}\n{ex.Message}");
+            retained.Faulted = true;
+            if (composite.Content == null)
+            {
+                composite.State = CompositeState.Failed;
+                composite.RetainedHdr = null;
+                retained.Dispose();
+            }
+
+            return false;
         }
+
+        var previous = composite.Content;
+        composite.Content = content;
+        previous?.Dispose();
+        return true;
+    }
+
+    /// <summary>
+    /// Drops the RGBA8 content of a cached composite whose retained pixels are compact, leaving only those.
+    /// Only for complete composites not on screen, from the thread that draws; <see cref="ApplyToneMapping"/> restores it.
+    /// </summary>
+    internal static void ReleaseToneMapped(Composite composite)
+    {
+        if (composite.RetainedHdr is not { IsCompact: true, Faulted: false } || composite.State != CompositeState.Complete || composite.Content == null)
+            return;
+
+        var content = composite.Content;
+        composite.Content = null;
+        content.Dispose();
+        composite.RetainedHdr.ReleaseOutput();
     }
 
-    private static byte ToneMap(float value)
+    internal static NativeDecodePriority PriorityOf(Composite composite) =>
+        composite.IsBackground ? NativeDecodePriority.Background : NativeDecodePriority.Foreground;
+
+    private void RecordStages(Composite composite, NativeDecodeControlScope scope, string what, string path)
     {
-        value = MathF.Pow(MathF.Max(value, 0), 1f / 2.2f) * 255f;
-        return (byte)Math.Clamp(value, 0, 255);
+        var stages = scope.ReadStats();
+        if (stages == null)
+            return;
+
+        composite.DecodeStages = stages;
+        Logger.Debug($"[{GetType().Name}] {what} stages: {stages}: {path}");
     }
-}
\ No newline at end of file
+
+    /// <summary>Keeps the decoder's sample statistics; an image with R == G == B everywhere is shown as grayscale.</summary>
+    private void RecordStatistics(Composite composite, NativeDecodeControlScope scope, string what, string path)
+    {
+        var statistics = scope.ReadImageStats();
+        composite.Statistics = statistics;
+        if (statistics == null)
+            return;
+
+        composite.IsGrayscale |= statistics.RgbEqual;
+        Logger.Debug($"[{GetType().Name}] {what} statistics: {statistics}: {path}");
+    }
+
+    private static string WindowToStr(int[] window) => $"({window[0]}, {window[1]}) - ({window[2]}, {window[3]})";
+
+    private RasterLargeContent? TryPublishPreview(Composite composite, string path, int width, int height, CancellationToken ct)
+    {
+        var constraints = DecodeConstraintsProvider.Current;
+        var maxWidth = (int)(constraints.Width * PreviewSizeMultiplier);
+        var maxHeight = (int)(constraints.Height * PreviewSizeMultiplier);
+        if (maxWidth <= 0 || maxHeight <= 0)
+            return null;
+
+        if (!ReadPreviewSize(path, maxWidth, maxHeight, out var previewWidth, out var previewHeight))
+            return null;
+
+        if (previewWidth == width && previewHeight == height)
+            return null;
+
+        ct.ThrowIfCancellationRequested();
+
+        var bitmap = new SKBitmap(new SKImageInfo(previewWidth, previewHeight, SKColorType.Rgba8888, SKAlphaType.Unpremul));
+        if (bitmap.GetPixels() == IntPtr.Zero)
+        {
+            bitmap.Dispose();
+            return null;
+        }
+
+        var target = new NativeDecodeTarget
+        {
+            Pixels = bitmap.GetPixels(),
+            Width = previewWidth,
+            Height = previewHeight,
+            Stride = bitmap.RowBytes,
+            Format = NativePixelFormat.Rgba8
+        };
+
+        bool loaded;
+        using (var scope = new NativeDecodeControlScope(ct, priority: PriorityOf(composite), collectStats: true, session: Session.Handle))
+        {
+            var control = scope.Control;
+            loaded = LoadPreview(path, maxWidth, maxHeight, in target, in control, out composite.IsGrayscale);
+            RecordStages(composite, scope, "Preview", path);
+        }
+
+        // A failed preview is not fatal; the full decode still follows.
+        if (!loaded)
+        {
+            bitmap.Dispose();
+            ct.ThrowIfCancellationRequested();
+            return null;
+        }
+
+        bitmap.SetImmutable();
+        using var pixmap = new SKPixmap(bitmap.Info, bitmap.GetPixels(), bitmap.RowBytes);
+        var previewImage = SKImage.FromPixels(pixmap, ReleaseBitmapOnImageDispose, bitmap);
+
+        var rasterLarge = new RasterLargeContent(width, height);
+        rasterLarge.SetPreview(previewImage);
+
+        composite.FullWidth = width;
+        composite.FullHeight = height;
+        composite.Content = rasterLarge;
+        composite.SignalReady();
+
+        Logger.Debug($"[{GetType().Name}] Preview {previewWidth}x{previewHeight} published for {width}x{height}: {path}");
+        return rasterLarge;
+    }
+
+    /// <summary>
+    /// Streams a huge image into a <see cref="RasterTileSource"/> behind the published preview. Bands of tile
+    /// height are decoded into one reusable RGBA8 buffer and cut into tiles, so peak transient memory stays
+    /// within <see cref="StreamBandBudgetBytes"/> however large the file is.
+    /// </summary>
+    private bool TryStreamBands(Composite composite, string path, int width, int height, RasterLargeContent rasterLarge, CancellationToken ct)
+    {
+        if ((long)width * height * 4L < StreamThresholdBytes)
+            return false;
+
+        var reader = OpenBandReader(path);
+        if (reader == IntPtr.Zero)
+            return false;
+
+        var bandRows = (int)Math.Clamp(StreamBandBudgetBytes / ((long)width * StreamBytesPerPixel), 16, StreamTileEdge);
+        var tileWidth = Math.Min(width, StreamTileEdge);
+        var tileHeight = Math.Min(height, bandRows);
+        var tilesX = (width + tileWidth - 1) / tileWidth;
+        var tilesY = (height + tileHeight - 1) / tileHeight;
+
+        var scheduler = new TileDecodeScheduler();
+        var tileSource = new RasterTileSource(tilesX, tilesY, tileWidth, tileHeight, scheduler);
+        rasterLarge.SetTiles(tileSource);
+        rasterLarge.SetTilesTotal(tilesX * tilesY);
+
+        Logger.Debug($"[{GetType().Name}] Streaming: {tilesX}x{tilesY}, tile={tileWidth}x{tileHeight}");
+
+        // Decode tiles on a background thread (keep DecodeAsync non-blocking for large images).
+        // Not bound to ct: the task must always run to close the reader, and it checks ct per band.
+        _ = Task.Run(() =>
+        {
+            using var band = new SKBitmap(new SKImageInfo(width, tileHeight, SKColorType.Rgba8888, SKAlphaType.Unpremul));
+            try
+            {
+                if (band.GetPixels() == IntPtr.Zero)
+                    throw new InvalidOperationException($"[{GetType().Name}] Failed to allocate {width}x{tileHeight} band for: {path}");
+
+                var done = new bool[tilesY];
+                for (var bandsDone = 0; bandsDone < tilesY; bandsDone++)
+                {
+                    ct.ThrowIfCancellationRequested();
+
+                    // Re-planned per band so the current view (fed to the scheduler by the tile source) resolves first.
+                    var ty = scheduler.BuildBandOrder(tilesX, tilesY, tileWidth, tileHeight).First(y => !done[y]);
+                    var firstRow = ty * tileHeight;
+                    var rows = Math.Min(tileHeight, height - firstRow);
+
+                    var target = new NativeDecodeTarget
+                    {
+                        Pixels = band.GetPixels(),
+                        Width = width,
+                        Height = rows,
+                        Stride = band.RowBytes,
+                        Format = NativePixelFormat.Rgba8
+                    };
+
+                    bool loaded;
+                    using (var scope = new NativeDecodeControlScope(ct, priority: PriorityOf(composite), session: Session.Handle))
+                    {
+                        var control = scope.Control;
+                        loaded = ReadBand(reader, firstRow, in target, in control);
+                    }
+
+                    if (!loaded)
+                    {
+                        ct.ThrowIfCancellationRequested();
+                        throw new InvalidOperationException($"[{GetType().Name}] Failed to load rows {firstRow}-{firstRow + rows - 1} of: {path}");
+                    }
+
+                    for (var tx = 0; tx < tilesX; tx++)
+                    {
+                        var left = tx * tileWidth;
+                        var info = new SKImageInfo(Math.Min(tileWidth, width - left), rows, SKColorType.Rgba8888, SKAlphaType.Unpremul);
+                        var tileImage = SKImage.FromPixelCopy(info, band.GetPixels() + left * 4, band.RowBytes);
+
+                        tileSource.SetTile(tx, ty, tileImage);
+                        rasterLarge.IncrementTileReady();
+                    }
+
+                    done[ty] = true;
+                    composite.LoadProgress = (double)(bandsDone + 1) / tilesY;
+                }
+
+                composite.SignalComplete();
+            }
+            catch (OperationCanceledException)
+            {
+                composite.SignalComplete();
+            }
+            catch (Exception ex)
+            {
+                Logger.Warning($"[{GetType().Name}] Band streaming failed: {path}\n{ex}");
+                composite.SignalComplete();
+            }
+            finally
+            {
+                CloseBandReader(reader);
+            }
+        });
+
+        return true;
+    }
+
+    internal static readonly SKImageRasterReleaseDelegate ReleaseBitmapOnImageDispose = (_, ctx) =>
+    {
+        if (ctx is SKBitmap bmp && bmp.Handle != IntPtr.Zero)
+            bmp.Dispose();
+    };
+
+    private static SKColorType ToColorType(NativePixelFormat format) => format switch
+    {
+        NativePixelFormat.Rgba8 => SKColorType.Rgba8888,
+        NativePixelFormat.RgbaF32 => SKColorType.RgbaF32,
+        NativePixelFormat.RgbaF16 => SKColorType.RgbaF16,
+        NativePixelFormat.Rgbe8 => SKColorType.Rgba8888, // 4 B/px storage for RetainedHdr, never drawn
+        _ => throw new NotSupportedException($"Unsupported native pixel format: {format}.")
+    };
+}
@@ -8,18 +8,70 @@ internal class HdrDecoder : FloatRgbaDecoderBase
 {
     public override bool CanDecode(ImageFormatType format) => format == ImageFormatType.Hdr;
 
-    protected override bool LoadPixels(string path, out IntPtr ptr, out int width, out int height)
+    protected override bool Probe(string path, out NativeImageProbe probe)
     {
-        var result = HdrNative.load_hdr_rgba(path, out ptr, out width, out height);
+        var result = HdrNative.probe_hdr(path, out probe);
         if (!result)
-        {
-            var errorPtr = HdrNative.get_last_hdr_error();
-            var error = Marshal.PtrToStringAnsi(errorPtr) ?? "<null>";
-            Logger.Error($"[HdrDecoder] Native error: {error}");
-        }
+            LogNativeError();
 
         return result;
     }
 
-    protected override void FreePixels(IntPtr ptr) => HdrNative.free_hdr_pixels(ptr);
-}
\ No newline at end of file
+    protected override bool LoadPixels(string path, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        var result = HdrNative.load_hdr_pixels(path, in target, in control, out isGrayscale);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override bool ReadPreviewSize(string path, int maxWidth, int maxHeight, out int width, out int height)
+    {
+        var result = HdrNative.read_hdr_preview_size(path, maxWidth, maxHeight, out width, out height);
+        if (!result)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override bool LoadPreview(string path, int maxWidth, int maxHeight, in NativeDecodeTarget target, in NativeDecodeControl control, out bool isGrayscale)
+    {
+        var result = HdrNative.load_hdr_preview(path, maxWidth, maxHeight, in target, in control, out isGrayscale);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override IntPtr OpenBandReader(string path)
+    {
+        var reader = HdrNative.hdr_scanline_open(path);
+        if (reader == IntPtr.Zero)
+            LogNativeError();
+
+        return reader;
+    }
+
+    protected override bool ReadBand(IntPtr reader, int firstRow, in NativeDecodeTarget target, in NativeDecodeControl control)
+    {
+        var result = HdrNative.hdr_scanline_read(reader, firstRow, in target, in control);
+        if (!result && !control.IsCancelled)
+            LogNativeError();
+
+        return result;
+    }
+
+    protected override void CloseBandReader(IntPtr reader) => HdrNative.hdr_scanline_close(reader);
+
+    protected override NativeDecodeSession Session => NativeDecodeSession.Hdr;
+
+    protected override bool CanDecodeRgbe => true;
+
+    private static void LogNativeError()
+    {
+        var errorPtr = HdrNative.get_last_hdr_error();
+        var error = Marshal.PtrToStringAnsi(errorPtr) ?? "<null>";
+        Logger.Error($"[HdrDecoder] Native error: {error}");
+    }
+}
@@ -8,4 +8,10 @@ internal interface IImageDecoder
     bool CanDecode(ImageFormatType format);
     
     Task DecodeAsync(Composite composite, CancellationToken ct);
+
+    /// <summary>
+    /// Decode cost in bytes of stored samples, read from the header only. Null when the decoder
+    /// cannot tell cheaply; load-time estimates then fall back to the file size.
+    /// </summary>
+    long? ProbeDecodeCost(string path) => null;
 }
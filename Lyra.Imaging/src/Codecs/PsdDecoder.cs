@@ -3,6 +3,7 @@ using Lyra.Common.SystemExtensions;
 using Lyra.Imaging.ConstraintsProvider;
 using Lyra.Imaging.Content;
 using Lyra.Imaging.Psd;
+using Lyra.Imaging.Psd.Core.Decode.ColorCalibration;
 using Lyra.Imaging.Psd.Core.Decode.Pixel;
 using Lyra.Imaging.Psd.Core.SectionData;
 using SkiaSharp;
@@ -16,6 +17,12 @@ internal class PsdDecoder : IImageDecoder
 
     private readonly TileDecodeScheduler _tileDecodeScheduler = new();
 
+    static PsdDecoder()
+    {
+        // Baked CMYK profile grids outlive the session, next to the preview cache in the data directory.
+        CmykIccGridCache.Directory = Path.Combine(LyraDataDirectory.GetDataDirectory(), "icc_cache");
+    }
+
     public bool CanDecode(ImageFormatType format) => format is ImageFormatType.Psd or ImageFormatType.Psb;
 
     public Task DecodeAsync(Composite composite, CancellationToken ct)
@@ -26,6 +33,9 @@ internal class PsdDecoder : IImageDecoder
 
         ct.ThrowIfCancellationRequested();
 
+        // Native conversions follow the composite's priority; the tile task started below inherits it.
+        using var priority = PsdDecodePriority.Use(() => composite.IsBackground);
+
         try
         {
             using var file = DecoderIO.OpenRandomAccessRead(path);
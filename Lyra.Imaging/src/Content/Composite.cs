@@ -32,6 +32,12 @@ public sealed class Composite : IDisposable
     private int _readySignaled;
     private int _completeSignaled;
     public double LoadTimeEstimated;
+    public double? LoadProgress; // 0..1, reported by decoders that stream rows (EXR/HDR)
+    public DecodeStages? DecodeStages; // stage breakdown of the last native decode (EXR/HDR)
+    public ImageStatistics? Statistics; // sample statistics of the decoded image (EXR/HDR full decodes)
+
+    // True while the image is only preloaded; its decodes then use spare cores only. Read at each native call.
+    internal volatile bool IsBackground;
     
     public event Action<Composite>? Completed;
 
@@ -43,12 +49,38 @@ public sealed class Composite : IDisposable
     public readonly Dictionary<string, string> FormatSpecific = new();
     public bool IsGrayscale;
 
+    // Layers of multi-layer files (EXR parts/AOVs); LayerIndex selects the one decoded
+    public IReadOnlyList<string> Layers = [];
+    public int LayerIndex;
+
+    // Linear pixels of an HDR image shown as RGBA8, kept for re-tonemapping (see ImageStore.ApplyToneMapping).
+    // Content is null while only compact retained pixels are cached.
+    internal RetainedHdr? RetainedHdr;
+    public ToneMapSettings? ToneMapping => RetainedHdr?.Applied;
+
     // Derived sizes for UI/zoom/pan: always prefer Full dims, else fall back to best known dims from content.
     public float LogicalWidth  => FullWidth  ?? Content?.DecodedWidth  ?? 0f;
     public float LogicalHeight => FullHeight ?? Content?.DecodedHeight ?? 0f;
 
     public bool IsEmpty => Content is null;
 
+    // Decoded pixel memory while cached off screen, counted against ImageStore.CacheBudgetBytes. Compact
+    // retained pixels are all that stays then; streamed tiles are counted at their full size, tiles tone-mapped
+    // from retained pixels at what they currently hold.
+    internal long CachedBytes => RetainedHdr is { IsCompact: true } compact
+        ? compact.ByteSize
+        : (RetainedHdr?.ByteSize ?? 0) + Content switch
+        {
+            RasterContent raster => raster.Image.Info.BytesSize64,
+            RasterLargeContent large => (large.PreviewImage?.Info.BytesSize64 ?? 0) + (large.FullImage?.Info.BytesSize64 ?? 0) + large.TileSource switch
+            {
+                RetainedTileSource retainedTiles => retainedTiles.CachedBytes,
+                null => 0,
+                _ => (long)large.FullWidth * (long)large.FullHeight * 4
+            },
+            _ => 0
+        };
+
     internal void BeginLoadTiming()
     {
         _loadStopwatch = Stopwatch.StartNew();
@@ -90,6 +122,8 @@ public sealed class Composite : IDisposable
     {
         Content?.Dispose();
         Content = null;
+        RetainedHdr?.Dispose();
+        RetainedHdr = null;
 
         State = CompositeState.Disposed;
         GC.SuppressFinalize(this);
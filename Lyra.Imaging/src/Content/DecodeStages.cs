@@ -0,0 +1,21 @@
+namespace Lyra.Imaging.Content;
+
+/// <summary>
+/// Where the time of one native decode went, as reported by the decoder (see lyra_decode_stats).
+/// Decompress, convert and tonemap are summed over worker threads, so they can exceed <see cref="TotalMs"/>.
+/// </summary>
+public sealed record DecodeStages(
+    double TotalMs,
+    double OpenMs,
+    double HeaderMs,
+    double DecompressMs,
+    double ConvertMs,
+    double TonemapMs,
+    long IoBytes,
+    long PeakScratchBytes,
+    int Threads)
+{
+    public override string ToString() =>
+        $"total {TotalMs:0.0}, open {OpenMs:0.0}, header {HeaderMs:0.0}, decompress {DecompressMs:0.0}, convert {ConvertMs:0.0}, " +
+        $"tonemap {TonemapMs:0.0} ms; {IoBytes / 1024} kB read, {PeakScratchBytes / 1024} kB scratch, {Threads} threads";
+}
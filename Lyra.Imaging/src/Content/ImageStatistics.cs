@@ -0,0 +1,51 @@
+namespace Lyra.Imaging.Content;
+
+/// <summary>
+/// Statistics of the decoded linear samples, gathered by the native decoder while it converted the rows
+/// (see lyra_image_stats). Min, max and mean are per channel (R, G, B, A) over finite samples only.
+/// </summary>
+public sealed record ImageStatistics(
+    double[] Min,
+    double[] Max,
+    double[] Mean,
+    ulong[] Histogram,
+    long Pixels,
+    long NanCount,
+    long InfCount,
+    bool AlphaOpaque,
+    bool RgbEqual)
+{
+    // Histogram layout, see LYRA_HISTOGRAM_* in lyra_decode.h: bin i starts at 2^(Log2Min + i / BinsPerStop).
+    public const int Bins = 256;
+    public const int Log2Min = -16;
+    public const int BinsPerStop = 8;
+
+    /// <summary>Lower luminance bound of histogram bin <paramref name="bin"/>; bin 0 also counts zero and negative luminance.</summary>
+    public static double BinLuminance(int bin) => Math.Pow(2.0, Log2Min + (double)bin / BinsPerStop);
+
+    /// <summary>Luminance below which <paramref name="fraction"/> of the histogrammed pixels fall, e.g. 0.5 for the median.</summary>
+    public double LuminancePercentile(double fraction)
+    {
+        ulong total = 0;
+        foreach (var count in Histogram)
+            total += count;
+        if (total == 0)
+            return 0;
+
+        var wanted = (ulong)Math.Ceiling(Math.Clamp(fraction, 0, 1) * total);
+        ulong seen = 0;
+        for (var i = 0; i < Histogram.Length; i++)
+        {
+            seen += Histogram[i];
+            if (seen >= wanted && seen > 0)
+                return BinLuminance(i + 1);
+        }
+
+        return BinLuminance(Histogram.Length);
+    }
+
+    public override string ToString() =>
+        $"{Pixels} px, RGB min {Min[0]:0.###}/{Min[1]:0.###}/{Min[2]:0.###}, max {Max[0]:0.###}/{Max[1]:0.###}/{Max[2]:0.###}, " +
+        $"mean {Mean[0]:0.###}/{Mean[1]:0.###}/{Mean[2]:0.###}, {NanCount} NaN, {InfCount} Inf" +
+        (AlphaOpaque ? ", opaque" : "") + (RgbEqual ? ", gray" : "");
+}
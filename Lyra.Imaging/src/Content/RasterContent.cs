@@ -9,15 +9,19 @@ public sealed class RasterContent : ICompositeContent
         Image = image ?? throw new ArgumentNullException(nameof(image));
     }
 
-    public RasterContent(SKBitmap backingBitmap, SKImage image)
+    public RasterContent(SKBitmap backingBitmap, SKImage image, bool isLinear = false)
     {
         Image = image ?? throw new ArgumentNullException(nameof(image));
         _backingBitmap = backingBitmap ?? throw new ArgumentNullException(nameof(backingBitmap));
+        IsLinear = isLinear;
     }
 
     public CompositeContentKind Kind => CompositeContentKind.Raster;
 
     public SKImage Image { get; }
+
+    // Pixels hold linear (HDR) values and need a transfer curve when drawn.
+    public bool IsLinear { get; }
     
     private readonly SKBitmap? _backingBitmap;
     
@@ -83,7 +83,8 @@ public sealed class RasterLargeContent : ICompositeContent
 
 public interface ITileSource : IDisposable
 {
-    IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize);
+    /// <param name="pixelsPerFullUnit">Screen pixels per full-image unit; lets multi-resolution sources pick a level.</param>
+    IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize, float pixelsPerFullUnit);
 }
 
 public readonly record struct RasterTile(SKImage Image, SKRect DestRect);
\ No newline at end of file
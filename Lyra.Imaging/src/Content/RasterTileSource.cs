@@ -8,15 +8,18 @@ public sealed class RasterTileSource : ITileSource
     private readonly int _tilesY;
     private readonly float _tileW;
     private readonly float _tileH;
+    private readonly TileDecodeScheduler? _scheduler;
 
     private SKImage?[] _tiles; // fixed slots
 
-    public RasterTileSource(int tilesX, int tilesY, float tileWidth, float tileHeight)
+    /// <param name="scheduler">Optional; receives the visible rect on every draw so the producer can decode it first.</param>
+    public RasterTileSource(int tilesX, int tilesY, float tileWidth, float tileHeight, TileDecodeScheduler? scheduler = null)
     {
         _tilesX = tilesX;
         _tilesY = tilesY;
         _tileW = tileWidth;
         _tileH = tileHeight;
+        _scheduler = scheduler;
 
         _tiles = new SKImage?[tilesX * tilesY];
     }
@@ -33,10 +36,12 @@ public sealed class RasterTileSource : ITileSource
         old?.Dispose();
     }
 
-    public IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize)
+    public IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize, float pixelsPerFullUnit)
     {
         if (visibleFullRect.IsEmpty)
             yield break;
+
+        _scheduler?.UpdateFocus(visibleFullRect);
         
         // Compute index range that overlaps the visible rect
         var minX = Math.Clamp((int)MathF.Floor(visibleFullRect.Left / _tileW), 0, _tilesX - 1);
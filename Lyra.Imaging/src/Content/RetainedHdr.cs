@@ -0,0 +1,187 @@
+using Lyra.Imaging.Codecs;
+using Lyra.Imaging.Interop;
+using SkiaSharp;
+
+namespace Lyra.Imaging.Content;
+
+/// <summary>
+/// Linear pixels kept next to the displayed RGBA8 content of an HDR image, so exposure and curve changes
+/// re-encode them natively instead of decoding the file again. Held as half floats (8 B/px), or for Radiance
+/// files as their RGBE samples (4 B/px) in a bitmap used only as storage. A large image also keeps a box-filtered
+/// half float preview and is shown as that preview plus tiles of the visible region, so no full-size RGBA8 copy
+/// is ever made. Owns the bitmaps.
+/// </summary>
+internal sealed class RetainedHdr : IDisposable
+{
+    private readonly SKBitmap _bitmap;
+    private readonly NativePixelFormat _format;
+    private readonly SKAlphaType _alphaType;
+    private readonly SKBitmap? _preview;
+    private SKBitmap? _output;
+
+    /// <param name="format"><see cref="NativePixelFormat.RgbaF16"/> or <see cref="NativePixelFormat.Rgbe8"/> pixels in <paramref name="bitmap"/>.</param>
+    /// <param name="opaque">Every alpha sample is 1; the tone-mapped content is then drawn as opaque.</param>
+    /// <param name="previewSize">
+    /// For a large image, the size its pixels box-filter down to with a whole factor (the native preview size); the content
+    /// is then a preview with tiles. Null shows the whole image as one raster.
+    /// </param>
+    public RetainedHdr(SKBitmap bitmap, NativePixelFormat format, bool opaque = false, SKSizeI? previewSize = null)
+    {
+        _bitmap = bitmap;
+        _format = format;
+        _alphaType = opaque || format == NativePixelFormat.Rgbe8 ? SKAlphaType.Opaque : SKAlphaType.Unpremul;
+        if (previewSize is { } size)
+            _preview = Downsample(size);
+    }
+
+    /// <summary>
+    /// RGBE pixels expand fast enough that a cached image not on screen keeps only them; its RGBA8 content is
+    /// released and made again by <see cref="ToneMap"/> when the image is shown.
+    /// </summary>
+    public bool IsCompact => _format == NativePixelFormat.Rgbe8;
+
+    public int Width => _bitmap.Width;
+    public int Height => _bitmap.Height;
+
+    public long ByteSize => _bitmap.ByteCount + (_preview?.ByteCount ?? 0);
+
+    /// <summary>A re-tonemap failed; the content already shown stays and no further attempts are made.</summary>
+    public bool Faulted { get; set; }
+
+    /// <summary>Settings of the RGBA8 content last produced by <see cref="ToneMap"/>.</summary>
+    public ToneMapSettings Applied { get; private set; }
+
+    /// <summary>
+    /// Tone-maps the retained pixels (for a large image, its preview) into the RGBA8 output bitmap, which is allocated
+    /// once and rewritten by every call. The content returned by the previous call shows the same memory, so it must be
+    /// replaced and disposed before the next frame is drawn; the thread that draws the composite does both. Tiles of a
+    /// large image are tone-mapped with the same settings as they come into view.
+    /// </summary>
+    public ICompositeContent ToneMap(ToneMapSettings settings)
+    {
+        var output = _output ??= AllocateRgba8(_preview?.Width ?? Width, _preview?.Height ?? Height);
+        var source = _preview is { } preview ? Target(preview, NativePixelFormat.RgbaF16) : Target(_bitmap, _format);
+        var target = Target(output, NativePixelFormat.Rgba8);
+        var toneParams = ToneParams(settings);
+
+        var toneMapped = source.Format == NativePixelFormat.Rgbe8
+            ? NativeRuntime.tonemap_rgbe_pixels(in source, in target, in toneParams)
+            : NativeRuntime.tonemap_half_pixels(in source, in target, in toneParams);
+        if (!toneMapped)
+            ThrowNativeError();
+
+        Applied = settings;
+
+        // A new image over the same pixels each time: Skia keys uploaded textures by image, not by memory.
+        using var pixmap = output.PeekPixels();
+        var image = SKImage.FromPixels(pixmap);
+        if (_preview == null)
+            return new RasterContent(image);
+
+        var large = new RasterLargeContent(Width, Height, image);
+        large.SetTiles(new RetainedTileSource(this, settings));
+        return large;
+    }
+
+    /// <summary>Tone-maps one region of the full-size retained pixels into a new RGBA8 image that owns its memory.</summary>
+    public SKImage ToneMapRegion(SKRectI region, ToneMapSettings settings) => ToneMapImage(_bitmap, _format, region, settings);
+
+    /// <summary>
+    /// Tone-maps the preview of a large image, else the whole image, into a new RGBA8 image that owns its memory. Reads
+    /// only the retained pixels, never the output shown by the current content, so it may run on any thread.
+    /// </summary>
+    public SKImage ToneMapCopy(ToneMapSettings settings) => _preview is { } preview
+        ? ToneMapImage(preview, NativePixelFormat.RgbaF16, new SKRectI(0, 0, preview.Width, preview.Height), settings)
+        : ToneMapImage(_bitmap, _format, new SKRectI(0, 0, Width, Height), settings);
+
+    private SKImage ToneMapImage(SKBitmap bitmap, NativePixelFormat format, SKRectI region, ToneMapSettings settings)
+    {
+        var tile = AllocateRgba8(region.Width, region.Height);
+        try
+        {
+            var source = Target(bitmap, format);
+            var target = Target(tile, NativePixelFormat.Rgba8);
+            var toneParams = ToneParams(settings);
+
+            var toneMapped = format == NativePixelFormat.Rgbe8
+                ? NativeRuntime.tonemap_rgbe_region(in source, region.Left, region.Top, in target, in toneParams)
+                : NativeRuntime.tonemap_half_region(in source, region.Left, region.Top, in target, in toneParams);
+            if (!toneMapped)
+                ThrowNativeError();
+
+            tile.SetImmutable();
+            using var pixmap = tile.PeekPixels();
+            return SKImage.FromPixels(pixmap, FloatRgbaDecoderBase.ReleaseBitmapOnImageDispose, tile);
+        }
+        catch
+        {
+            tile.Dispose();
+            throw;
+        }
+    }
+
+    /// <summary>Frees the RGBA8 output once the content showing it was disposed; the next <see cref="ToneMap"/> allocates it again.</summary>
+    public void ReleaseOutput()
+    {
+        _output?.Dispose();
+        _output = null;
+    }
+
+    private SKBitmap Downsample(SKSizeI size)
+    {
+        var preview = new SKBitmap(new SKImageInfo(size.Width, size.Height, SKColorType.RgbaF16, SKAlphaType.Unpremul));
+        try
+        {
+            if (preview.GetPixels() == IntPtr.Zero)
+                throw new InvalidOperationException($"[RetainedHdr] Failed to allocate {size.Width}x{size.Height} preview");
+
+            var source = Target(_bitmap, _format);
+            var target = Target(preview, NativePixelFormat.RgbaF16);
+            if (!NativeRuntime.downsample_retained_pixels(in source, in target))
+                ThrowNativeError();
+
+            preview.SetImmutable();
+            return preview;
+        }
+        catch
+        {
+            preview.Dispose();
+            throw;
+        }
+    }
+
+    private SKBitmap AllocateRgba8(int width, int height)
+    {
+        var output = new SKBitmap(new SKImageInfo(width, height, SKColorType.Rgba8888, _alphaType));
+        if (output.GetPixels() != IntPtr.Zero)
+            return output;
+
+        output.Dispose();
+        throw new InvalidOperationException($"[RetainedHdr] Failed to allocate {width}x{height} bitmap");
+    }
+
+    private static NativeDecodeTarget Target(SKBitmap bitmap, NativePixelFormat format) => new()
+    {
+        Pixels = bitmap.GetPixels(),
+        Width = bitmap.Width,
+        Height = bitmap.Height,
+        Stride = bitmap.RowBytes,
+        Format = format
+    };
+
+    private static NativeToneParams ToneParams(ToneMapSettings settings) =>
+        new() { Exposure = settings.ExposureStops, Gamma = settings.Gamma, Curve = settings.Curve };
+
+    private static void ThrowNativeError()
+    {
+        throw new InvalidOperationException($"[RetainedHdr] Native error: {NativeRuntime.LastError()}");
+    }
+
+    public void Dispose()
+    {
+        ReleaseOutput();
+        _preview?.Dispose();
+        if (_bitmap.Handle != IntPtr.Zero)
+            _bitmap.Dispose();
+    }
+}
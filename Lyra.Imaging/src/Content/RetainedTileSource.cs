@@ -0,0 +1,167 @@
+using System.Diagnostics;
+using Lyra.Common;
+using SkiaSharp;
+
+namespace Lyra.Imaging.Content;
+
+/// <summary>
+/// Full-resolution tiles of a large <see cref="RetainedHdr"/> image, tone-mapped from its retained pixels with one set of
+/// settings as they come into view. Tone-mapping a tile is a table lookup per pixel, so it runs on the drawing thread
+/// within a small time budget per frame, nearest the view centre first; tiles still missing show the preview beneath.
+/// Tiles are kept in an LRU under a byte budget. A settings change replaces the whole source.
+/// </summary>
+internal sealed class RetainedTileSource : ITileSource
+{
+    private const int TileEdge = 512;
+
+    private const long CacheBudgetBytes = 128L * 1024 * 1024;
+
+    // Time spent tone-mapping missing tiles per frame; the rest follow on the next frames.
+    private const double FrameBudgetMs = 8.0;
+
+    private readonly record struct TileKey(int X, int Y);
+    private sealed record CachedTile(TileKey Key, SKImage Image, long Bytes);
+
+    private readonly RetainedHdr _retained;
+    private readonly ToneMapSettings _settings;
+    private readonly int _tilesX;
+    private readonly int _tilesY;
+
+    private readonly object _gate = new();
+    private readonly Dictionary<TileKey, LinkedListNode<CachedTile>> _cache = new();
+    private readonly LinkedList<CachedTile> _lru = new(); // most recently drawn first
+    private long _cachedBytes;
+    private bool _failed;
+    private bool _disposed;
+
+    public RetainedTileSource(RetainedHdr retained, ToneMapSettings settings)
+    {
+        _retained = retained;
+        _settings = settings;
+        _tilesX = (retained.Width + TileEdge - 1) / TileEdge;
+        _tilesY = (retained.Height + TileEdge - 1) / TileEdge;
+    }
+
+    /// <summary>Bytes of the tiles currently kept.</summary>
+    public long CachedBytes
+    {
+        get
+        {
+            lock (_gate)
+                return _cachedBytes;
+        }
+    }
+
+    public IEnumerable<RasterTile> GetTiles(SKRect visibleFullRect, SKSize imageSize, float pixelsPerFullUnit)
+    {
+        if (visibleFullRect.IsEmpty)
+            return [];
+
+        // Retained pixels are the full image, so one full unit is one pixel whatever the logical size.
+        var unitsX = imageSize.Width / _retained.Width;
+        var unitsY = imageSize.Height / _retained.Height;
+        var tileW = TileEdge * unitsX;
+        var tileH = TileEdge * unitsY;
+
+        var minX = Math.Clamp((int)MathF.Floor(visibleFullRect.Left / tileW), 0, _tilesX - 1);
+        var minY = Math.Clamp((int)MathF.Floor(visibleFullRect.Top / tileH), 0, _tilesY - 1);
+        var maxX = Math.Clamp((int)MathF.Floor((visibleFullRect.Right - 1) / tileW), 0, _tilesX - 1);
+        var maxY = Math.Clamp((int)MathF.Floor((visibleFullRect.Bottom - 1) / tileH), 0, _tilesY - 1);
+
+        var tiles = new List<RasterTile>();
+        var missing = new List<TileKey>();
+
+        lock (_gate)
+        {
+            if (_disposed)
+                return [];
+
+            for (var y = minY; y <= maxY; y++)
+            for (var x = minX; x <= maxX; x++)
+            {
+                var key = new TileKey(x, y);
+                if (!_cache.TryGetValue(key, out var node))
+                {
+                    missing.Add(key);
+                    continue;
+                }
+
+                _lru.Remove(node);
+                _lru.AddFirst(node);
+                tiles.Add(ToRasterTile(key, node.Value.Image, unitsX, unitsY));
+            }
+
+            if (missing.Count == 0 || _failed)
+                return tiles;
+
+            var centerX = visibleFullRect.MidX / tileW - 0.5f;
+            var centerY = visibleFullRect.MidY / tileH - 0.5f;
+            missing.Sort((a, b) => Distance(a, centerX, centerY).CompareTo(Distance(b, centerX, centerY)));
+
+            var stopwatch = Stopwatch.StartNew();
+            foreach (var key in missing)
+            {
+                if (stopwatch.Elapsed.TotalMilliseconds >= FrameBudgetMs)
+                    break;
+
+                SKImage image;
+                try
+                {
+                    image = _retained.ToneMapRegion(TileRegion(key), _settings);
+                }
+                catch (Exception ex)
+                {
+                    // The preview stays on screen; no further tiles are attempted with these settings.
+                    Logger.Warning($"[RetainedTileSource] Tile tone mapping failed: {ex.Message}");
+                    _failed = true;
+                    break;
+                }
+
+                var bytes = (long)image.Width * image.Height * 4;
+                _cache[key] = _lru.AddFirst(new CachedTile(key, image, bytes));
+                _cachedBytes += bytes;
+                tiles.Add(ToRasterTile(key, image, unitsX, unitsY));
+            }
+
+            // Evict least recently drawn tiles, but never those of the current view.
+            while (_cachedBytes > CacheBudgetBytes && _lru.Last is { } last && !IsInRange(last.Value.Key, minX, minY, maxX, maxY))
+            {
+                _lru.RemoveLast();
+                _cache.Remove(last.Value.Key);
+                _cachedBytes -= last.Value.Bytes;
+                last.Value.Image.Dispose();
+            }
+        }
+
+        return tiles;
+    }
+
+    private SKRectI TileRegion(TileKey key)
+    {
+        var left = key.X * TileEdge;
+        var top = key.Y * TileEdge;
+        return new SKRectI(left, top, Math.Min(left + TileEdge, _retained.Width), Math.Min(top + TileEdge, _retained.Height));
+    }
+
+    private static RasterTile ToRasterTile(TileKey key, SKImage image, float unitsX, float unitsY) =>
+        new(image, SKRect.Create(key.X * TileEdge * unitsX, key.Y * TileEdge * unitsY, image.Width * unitsX, image.Height * unitsY));
+
+    private static float Distance(TileKey key, float x, float y) => (key.X - x) * (key.X - x) + (key.Y - y) * (key.Y - y);
+
+    private static bool IsInRange(TileKey key, int minX, int minY, int maxX, int maxY) =>
+        key.X >= minX && key.X <= maxX && key.Y >= minY && key.Y <= maxY;
+
+    public void Dispose()
+    {
+        lock (_gate)
+        {
+            _disposed = true;
+            foreach (var tile in _lru)
+                tile.Image.Dispose();
+
+            _lru.Clear();
+            _cache.Clear();
+            _cachedBytes = 0;
+        }
+    }
+}
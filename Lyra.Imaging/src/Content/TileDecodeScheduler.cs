@@ -3,8 +3,8 @@ using SkiaSharp;
 namespace Lyra.Imaging.Content;
 
 /// <summary>
-/// Produces a decode priority for tiled images. Currently, yields a band (tileY) order
-/// derived from a spiral tile order around a focus point.
+/// Produces a decode priority for tiled images: a band (tileY) order derived from a spiral
+/// tile order around a focus point, or a per-tile order by distance from the focus.
 /// </summary>
 public sealed class TileDecodeScheduler
 {
@@ -17,7 +17,7 @@ public sealed class TileDecodeScheduler
     /// Updates the scheduler focus in full-image coordinates.
     /// For PSD, this should typically be the current visibleFullRect.
     /// </summary>
-    public void UpdateFocus(SKRect focusFullRect) // TODO wire this up
+    public void UpdateFocus(SKRect focusFullRect)
     {
         lock (_gate)
             _focusFullRect = focusFullRect;
@@ -78,4 +78,29 @@ public sealed class TileDecodeScheduler
 
         return bandOrder;
     }
+
+    /// <summary>
+    /// Orders arbitrary tiles (given as full-image rects) by distance of their centers from the focus rect center.
+    /// Returns indices into <paramref name="tileRects"/> in the desired decode order.
+    /// </summary>
+    public List<int> BuildTileOrder(IReadOnlyList<SKRect> tileRects, SKSize imageSize)
+    {
+        SKRect? focus;
+        lock (_gate) focus = _focusFullRect;
+
+        var center = focus is { } r && !r.IsEmpty
+            ? new SKPoint(r.MidX, r.MidY)
+            : new SKPoint(imageSize.Width * 0.5f, imageSize.Height * 0.5f);
+
+        var order = Enumerable.Range(0, tileRects.Count).ToList();
+        order.Sort((a, b) => DistanceSquared(tileRects[a], center).CompareTo(DistanceSquared(tileRects[b], center)));
+        return order;
+    }
+
+    private static float DistanceSquared(SKRect rect, SKPoint point)
+    {
+        var dx = rect.MidX - point.X;
+        var dy = rect.MidY - point.Y;
+        return dx * dx + dy * dy;
+    }
 }
@@ -0,0 +1,15 @@
+namespace Lyra.Imaging.Content;
+
+/// <summary>Mirrors lyra_tone_curve: curve applied to exposed linear samples before gamma.</summary>
+public enum ToneCurve
+{
+    Clip = 0,
+    Reinhard = 1,
+    Aces = 2
+}
+
+/// <summary>Display transform for HDR pixels shown as RGBA8. The default matches the load-time encoding.</summary>
+public readonly record struct ToneMapSettings(float ExposureStops = 0f, float Gamma = 2.2f, ToneCurve Curve = ToneCurve.Clip)
+{
+    public static ToneMapSettings Default => new();
+}
@@ -1,5 +1,7 @@
+using Lyra.Imaging.Codecs;
 using Lyra.Imaging.ConstraintsProvider;
 using Lyra.Imaging.Content;
+using Lyra.Imaging.Interop;
 using Lyra.Imaging.Pipeline;
 
 namespace Lyra.Imaging;
@@ -8,6 +10,58 @@ public static class ImageStore
 {
     private static readonly ImageLoader ImageLoader = new();
 
+    /// <summary>Decode EXR/HDR to linear half floats instead of tone-mapped RGBA8 (applies to new loads).</summary>
+    public static bool RetainHdrAsHalfFloat
+    {
+        get => FloatRgbaDecoderBase.RetainHalfFloat;
+        set => FloatRgbaDecoderBase.RetainHalfFloat = value;
+    }
+
+    /// <summary>
+    /// Keep linear half floats of EXR/HDR images shown as RGBA8, so <see cref="ToneMapping"/> changes re-encode them
+    /// without decoding again (applies to new loads). Costs 8 B/px on top of the RGBA8 output for every loaded and
+    /// preloaded image; off, images are decoded straight to RGBA8 and keep the load-time curve.
+    /// </summary>
+    public static bool RetainHdrForToneMapping
+    {
+        get => FloatRgbaDecoderBase.RetainForToneMapping;
+        set => FloatRgbaDecoderBase.RetainForToneMapping = value;
+    }
+
+    /// <summary>
+    /// Retain Radiance (.hdr) images as 4 B/px RGBE instead of half floats (applies to new loads). Cached images
+    /// not on screen then hold only those and are re-encoded when shown, so a budget keeps about three times as many.
+    /// </summary>
+    public static bool RetainHdrAsRgbe
+    {
+        get => FloatRgbaDecoderBase.RetainRgbe;
+        set => FloatRgbaDecoderBase.RetainRgbe = value;
+    }
+
+    /// <summary>
+    /// Decoded pixel memory the images kept around the current one may take (see <see cref="Cleanup"/>). It limits only
+    /// the images beyond the preload window: those are always kept, up to seven images at the viewer's preload depth of
+    /// three, and their memory counts first, so the budget may be exceeded by the window alone.
+    /// </summary>
+    public static long CacheBudgetBytes { get; set; } = 1024L * 1024 * 1024;
+
+    /// <summary>
+    /// Exposure, gamma and curve for HDR images shown as RGBA8. Applied by <see cref="ApplyToneMapping"/> to images
+    /// retained for it (<see cref="RetainHdrForToneMapping"/>, <see cref="RetainHdrAsRgbe"/>).
+    /// </summary>
+    public static ToneMapSettings ToneMapping
+    {
+        get => FloatRgbaDecoderBase.ToneMapping;
+        set => FloatRgbaDecoderBase.ToneMapping = value;
+    }
+
+    /// <summary>Idle scratch memory each native EXR/HDR decoder keeps between decodes (applies from the next cleanup).</summary>
+    public static long DecodeScratchRetainBytes
+    {
+        get => NativeDecodeSession.RetainBytes;
+        set => NativeDecodeSession.RetainBytes = value;
+    }
+
     public static void Initialize()
     {
         _ = DecodeConstraintsProvider.Current;
@@ -26,9 +80,31 @@ public static class ImageStore
         ImageLoader.PreloadAdjacent(paths);
     }
 
-    public static void Cleanup(string[] keep)
+    public static Composite SelectLayer(string path, int layerIndex)
+    {
+        return ImageLoader.SelectLayer(path, layerIndex);
+    }
+
+    /// <summary>
+    /// Re-encodes a loaded HDR image with the current <see cref="ToneMapping"/> if it was shown with other settings,
+    /// or restores the content released while it was cached (<see cref="RetainHdrAsRgbe"/>).
+    /// Cheap when nothing changed; call from the thread that draws the composite, as the old content is disposed here.
+    /// </summary>
+    /// <returns>True when the content was replaced.</returns>
+    public static bool ApplyToneMapping(Composite composite)
+    {
+        return FloatRgbaDecoderBase.ApplyToneMapping(composite);
+    }
+
+    /// <summary>
+    /// Drops loaded images outside the window: every path in <paramref name="keep"/> stays whatever its size, then finished
+    /// images from <paramref name="nearest"/> (ordered nearest first) stay while all kept images fit in
+    /// <see cref="CacheBudgetBytes"/>. Pass the preload window as <paramref name="keep"/>: evicting images that are preloaded
+    /// again on the next navigation would only decode them twice.
+    /// </summary>
+    public static void Cleanup(string[] keep, string[] nearest)
     {
-        ImageLoader.Cleanup(keep);
+        ImageLoader.Cleanup(keep, nearest, CacheBudgetBytes);
     }
 
     public static void SaveAndDispose()
@@ -5,11 +5,74 @@ namespace Lyra.Imaging.Interop;
 internal static class ExrNative
 {
     [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
-    public static extern bool load_exr_rgba(string path, out IntPtr pixels, out int width, out int height);
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_exr_size(string path, out int width, out int height);
 
     [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
-    public static extern void free_exr_pixels(IntPtr ptr);
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool probe_exr(string path, out NativeImageProbe probe);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_exr_pixels(string path, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_exr_size_from_memory(IntPtr data, nuint size, out int width, out int height);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_exr_pixels_from_memory(IntPtr data, nuint size, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_exr_preview_size(string path, int maxWidth, int maxHeight, out int width, out int height);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_exr_preview(string path, int maxWidth, int maxHeight, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool list_exr_layers(string path, [In, Out] NativeImageLayer[]? layers, int capacity, out int count);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_exr_layer(string path, int part, string channels, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr exr_scanline_open(string path);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void exr_scanline_close(IntPtr handle);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool exr_scanline_read(IntPtr handle, int firstRow, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr exr_tiled_open(string path);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void exr_tiled_close(IntPtr handle);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int exr_tiled_level_count(IntPtr handle);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool exr_tiled_level_info(IntPtr handle, int level, out int width, out int height, out int tilesX, out int tilesY);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool exr_tiled_read(IntPtr handle, int level, int tileX0, int tileY0, int tileX1, int tileY1, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
 
     [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
     public static extern IntPtr get_last_exr_error();
-}
\ No newline at end of file
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr exr_session_create(long retainBytes);
+
+    [DllImport("libexr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern long exr_session_trim(IntPtr session, long retainBytes);
+}
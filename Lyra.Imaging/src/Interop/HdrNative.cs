@@ -5,11 +5,49 @@ namespace Lyra.Imaging.Interop;
 internal static class HdrNative
 {
     [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
-    public static extern bool load_hdr_rgba(string path, out IntPtr pixels, out int width, out int height);
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_hdr_size(string path, out int width, out int height);
 
     [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
-    public static extern void free_hdr_pixels(IntPtr ptr);
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool probe_hdr(string path, out NativeImageProbe probe);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_hdr_pixels(string path, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_hdr_size_from_memory(IntPtr data, nuint size, out int width, out int height);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_hdr_pixels_from_memory(IntPtr data, nuint size, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool read_hdr_preview_size(string path, int maxWidth, int maxHeight, out int width, out int height);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool load_hdr_preview(string path, int maxWidth, int maxHeight, in NativeDecodeTarget target, in NativeDecodeControl control, [MarshalAs(UnmanagedType.U1)] out bool isGrayscale);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr hdr_scanline_open(string path);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void hdr_scanline_close(IntPtr handle);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool hdr_scanline_read(IntPtr handle, int firstRow, in NativeDecodeTarget target, in NativeDecodeControl control);
 
     [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
     public static extern IntPtr get_last_hdr_error();
-}
\ No newline at end of file
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr hdr_session_create(long retainBytes);
+
+    [DllImport("libhdr_native", CallingConvention = CallingConvention.Cdecl)]
+    public static extern long hdr_session_trim(IntPtr session, long retainBytes);
+}
@@ -0,0 +1,233 @@
+using System.Runtime.InteropServices;
+using Lyra.Imaging.Content;
+
+namespace Lyra.Imaging.Interop;
+
+/// <summary>Mirrors lyra_pixel_format in native/Common/lyra_decode.h.</summary>
+internal enum NativePixelFormat
+{
+    Rgba8 = 0,
+    RgbaF32 = 1,
+    RgbaF16 = 2,
+    Rgbe8 = 3 // planar Radiance rows, HDR full decodes only; kept for tonemap_rgbe_pixels
+}
+
+/// <summary>Mirrors lyra_decode_target: caller-owned pixel memory the native decoder writes into.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeDecodeTarget
+{
+    public IntPtr Pixels;
+    public int Width;
+    public int Height;
+    public int Stride;
+    public NativePixelFormat Format;
+}
+
+/// <summary>Mirrors lyra_level_mode.</summary>
+internal enum NativeLevelMode
+{
+    One = 0,
+    Mipmap = 1,
+    Ripmap = 2
+}
+
+/// <summary>Mirrors lyra_image_probe: file layout read from the header alone.</summary>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+internal struct NativeImageProbe
+{
+    public int Width;
+    public int Height;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)] public int[] DataWindow;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)] public int[] DisplayWindow;
+    public int ChannelCount;
+    public int StoredBytesPerPixel;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 1024)] public string Channels;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)] public string Compression;
+    [MarshalAs(UnmanagedType.U4)] public bool Tiled;
+    public int TileWidth;
+    public int TileHeight;
+    public NativeLevelMode LevelMode;
+    public int LevelCount;
+    public int PartCount;
+
+    /// <summary>Bytes of stored samples the decoder has to touch; tracks decode time far better than file size.</summary>
+    public readonly long DecodeCost => (long)Width * Height * StoredBytesPerPixel;
+}
+
+/// <summary>Mirrors lyra_image_layer: one selectable layer (EXR part default layer or AOV).</summary>
+[StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+internal struct NativeImageLayer
+{
+    public int Part;
+    public int Width;
+    public int Height;
+    public int ChannelCount;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 64)] public string PartName;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 128)] public string Name;
+    [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 512)] public string Channels;
+
+    /// <summary>True for the first part's default layer, which the regular decode path already shows.</summary>
+    public readonly bool IsDefault => Part == 0 && Name.Length == 0;
+
+    public readonly string DisplayName
+    {
+        get
+        {
+            var layer = Name.Length > 0 ? Name : Channels.Replace(";", "");
+            return PartName.Length > 0 ? $"{PartName}/{layer}" : layer;
+        }
+    }
+}
+
+/// <summary>Mirrors lyra_tone_params: exposure (stops), gamma and curve for re-encoding linear pixels to RGBA8.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeToneParams
+{
+    public float Exposure;
+    public float Gamma;
+    public ToneCurve Curve;
+}
+
+/// <summary>Mirrors lyra_decode_priority: foreground decodes get every core, background ones only spare capacity.</summary>
+internal enum NativeDecodePriority
+{
+    Foreground = 0,
+    Background = 1
+}
+
+/// <summary>Mirrors lyra_decode_stats: per-stage costs the native decoder fills in when asked.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeDecodeStats
+{
+    public double TotalMs;
+    public double OpenMs;
+    public double HeaderMs;
+    public double DecompressMs;
+    public double ConvertMs;
+    public double TonemapMs;
+    public long IoBytes;
+    public long PeakScratchBytes;
+    public int Threads;
+
+    public readonly DecodeStages ToStages() =>
+        new(TotalMs, OpenMs, HeaderMs, DecompressMs, ConvertMs, TonemapMs, IoBytes, PeakScratchBytes, Threads);
+}
+
+/// <summary>Mirrors lyra_image_stats: statistics of the decoded samples, filled by whole-image decodes when asked.</summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeImageStats
+{
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)] public double[] Min;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)] public double[] Max;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)] public double[] Mean;
+    [MarshalAs(UnmanagedType.ByValArray, SizeConst = ImageStatistics.Bins)] public ulong[] Histogram;
+    public long Pixels;
+    public long NanCount;
+    public long InfCount;
+    public int AlphaOpaque;
+    public int RgbEqual;
+
+    public readonly ImageStatistics ToStatistics() =>
+        new(Min, Max, Mean, Histogram, Pixels, NanCount, InfCount, AlphaOpaque != 0, RgbEqual != 0);
+}
+
+/// <summary>Mirrors lyra_progress_fn. Invoked from native worker threads, serialised.</summary>
+[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+internal delegate void NativeProgressCallback(int rowsDone, int rowsTotal, IntPtr user);
+
+/// <summary>
+/// Mirrors lyra_decode_control: cancel flag polled by the native decoder, an optional progress callback,
+/// the priority class that sizes the decode's share of the process-wide thread budget, optional
+/// <see cref="NativeDecodeStats"/> and <see cref="NativeImageStats"/> blocks the decoder fills in on return,
+/// and the <see cref="NativeDecodeSession"/> whose scratch pool the decode draws from.
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+internal struct NativeDecodeControl
+{
+    public IntPtr Cancel;
+    public IntPtr Progress;
+    public IntPtr User;
+    public NativeDecodePriority Priority;
+    public int MaxThreads; // 0 = decided by Priority
+    public IntPtr Stats;
+    public IntPtr ImageStats;
+    public IntPtr Session;
+
+    public readonly bool IsCancelled => Cancel != IntPtr.Zero && Marshal.ReadInt32(Cancel) != 0;
+}
+
+/// <summary>
+/// Owns the native cancel flag for one decode and raises it when the token is cancelled,
+/// so a stale preload stops inside the native row loops instead of running to completion.
+/// </summary>
+internal sealed class NativeDecodeControlScope : IDisposable
+{
+    private readonly IntPtr _cancelFlag;
+    private readonly CancellationTokenRegistration _registration;
+    private readonly NativeProgressCallback? _progressCallback; // rooted for as long as native code may call it
+    private readonly IntPtr _stats;
+    private readonly IntPtr _imageStats;
+
+    public NativeDecodeControl Control { get; }
+
+    public NativeDecodeControlScope(CancellationToken ct, Action<int, int>? progress = null, NativeDecodePriority priority = NativeDecodePriority.Foreground,
+        bool collectStats = false, bool collectImageStats = false, IntPtr session = default)
+    {
+        _cancelFlag = Marshal.AllocHGlobal(sizeof(int));
+        Marshal.WriteInt32(_cancelFlag, ct.IsCancellationRequested ? 1 : 0);
+        _registration = ct.Register(() => Marshal.WriteInt32(_cancelFlag, 1));
+
+        if (progress != null)
+            _progressCallback = (rowsDone, rowsTotal, _) => progress(rowsDone, rowsTotal);
+
+        if (collectStats)
+        {
+            _stats = Marshal.AllocHGlobal(Marshal.SizeOf<NativeDecodeStats>());
+            Marshal.StructureToPtr(new NativeDecodeStats(), _stats, false);
+        }
+
+        if (collectImageStats)
+        {
+            // Zeroed: Pixels stays 0 unless the decoder publishes statistics.
+            var size = Marshal.SizeOf<NativeImageStats>();
+            _imageStats = Marshal.AllocHGlobal(size);
+            unsafe { new Span<byte>((void*)_imageStats, size).Clear(); }
+        }
+
+        Control = new NativeDecodeControl
+        {
+            Cancel = _cancelFlag,
+            Progress = _progressCallback != null ? Marshal.GetFunctionPointerForDelegate(_progressCallback) : IntPtr.Zero,
+            User = IntPtr.Zero,
+            Priority = priority,
+            Stats = _stats,
+            ImageStats = _imageStats,
+            Session = session
+        };
+    }
+
+    /// <summary>Stage breakdown of the last native call made with <see cref="Control"/>; null unless collecting.</summary>
+    public DecodeStages? ReadStats() => _stats != IntPtr.Zero ? Marshal.PtrToStructure<NativeDecodeStats>(_stats).ToStages() : null;
+
+    /// <summary>Sample statistics of the last successful whole-image decode made with <see cref="Control"/>; null when not collected.</summary>
+    public ImageStatistics? ReadImageStats()
+    {
+        if (_imageStats == IntPtr.Zero)
+            return null;
+
+        var stats = Marshal.PtrToStructure<NativeImageStats>(_imageStats);
+        return stats.Pixels > 0 ? stats.ToStatistics() : null;
+    }
+
+    public void Dispose()
+    {
+        // Waits for a running cancel callback, so the flag is never written after it is freed.
+        _registration.Dispose();
+        Marshal.FreeHGlobal(_cancelFlag);
+        if (_stats != IntPtr.Zero)
+            Marshal.FreeHGlobal(_stats);
+        if (_imageStats != IntPtr.Zero)
+            Marshal.FreeHGlobal(_imageStats);
+        GC.KeepAlive(_progressCallback);
+    }
+}
@@ -0,0 +1,77 @@
+using Lyra.Common;
+
+namespace Lyra.Imaging.Interop;
+
+/// <summary>
+/// One native library's lyra_decode_session: a pool of band and scanline buffers shared by every decode made
+/// through that library, so flicking through similar images reuses scratch memory instead of allocating and
+/// faulting it in again per decode. Created on first use and kept for the life of the process, as preloads may
+/// still be decoding with it at shutdown. A session that cannot be created leaves decodes allocating per call.
+/// </summary>
+internal sealed class NativeDecodeSession
+{
+    private readonly string _name;
+    private readonly Func<long, IntPtr> _create;
+    private readonly Func<IntPtr, long, long> _trim;
+    private readonly object _lock = new();
+    private IntPtr _handle;
+    private bool _created;
+
+    public static NativeDecodeSession Exr { get; } = new("EXR", ExrNative.exr_session_create, ExrNative.exr_session_trim);
+    public static NativeDecodeSession Hdr { get; } = new("HDR", HdrNative.hdr_session_create, HdrNative.hdr_session_trim);
+
+    /// <summary>Idle scratch each session keeps between decodes. Changes apply at the next <see cref="TrimAll"/>.</summary>
+    public static long RetainBytes { get; set; } = 128L * 1024 * 1024;
+
+    private NativeDecodeSession(string name, Func<long, IntPtr> create, Func<IntPtr, long, long> trim)
+    {
+        _name = name;
+        _create = create;
+        _trim = trim;
+    }
+
+    /// <summary>Handle for <see cref="NativeDecodeControl.Session"/>; <see cref="IntPtr.Zero"/> when there is none.</summary>
+    public IntPtr Handle
+    {
+        get
+        {
+            lock (_lock)
+            {
+                if (!_created)
+                {
+                    _created = true;
+                    _handle = _create(RetainBytes);
+                    if (_handle == IntPtr.Zero)
+                        Logger.Warning($"[NativeDecodeSession] {_name} session unavailable, decodes allocate their own scratch.");
+                }
+
+                return _handle;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Frees scratch no decode has reused since the previous call, and any beyond <see cref="RetainBytes"/>.
+    /// Called whenever the loader drops images, so buffers sized for images the user navigated away from go too.
+    /// </summary>
+    public static void TrimAll()
+    {
+        Exr.Trim();
+        Hdr.Trim();
+    }
+
+    private void Trim()
+    {
+        long freed;
+        lock (_lock)
+        {
+            if (_handle == IntPtr.Zero)
+                return;
+
+            freed = _trim(_handle, RetainBytes);
+        }
+
+        if (freed > 0)
+            Logger.Debug($"[NativeDecodeSession] {_name} trimmed {freed / 1024} kB of idle scratch.");
+    }
+}
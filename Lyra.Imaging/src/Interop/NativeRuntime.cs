@@ -0,0 +1,35 @@
+using System.Runtime.InteropServices;
+
+namespace Lyra.Imaging.Interop;
+
+/// <summary>
+/// Exports of liblyra_native_runtime, the library every native wrapper loads (see native/Common/retained.h). Retained
+/// pixels are re-encoded here whichever decoder produced them, so showing an EXR needs no Radiance wrapper.
+/// </summary>
+internal static class NativeRuntime
+{
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr get_last_runtime_error();
+
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool tonemap_half_pixels(in NativeDecodeTarget source, in NativeDecodeTarget target, in NativeToneParams toneParams);
+
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool tonemap_rgbe_pixels(in NativeDecodeTarget source, in NativeDecodeTarget target, in NativeToneParams toneParams);
+
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool tonemap_half_region(in NativeDecodeTarget source, int x, int y, in NativeDecodeTarget target, in NativeToneParams toneParams);
+
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool tonemap_rgbe_region(in NativeDecodeTarget source, int x, int y, in NativeDecodeTarget target, in NativeToneParams toneParams);
+
+    [DllImport("liblyra_native_runtime", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool downsample_retained_pixels(in NativeDecodeTarget source, in NativeDecodeTarget target);
+
+    public static string LastError() => Marshal.PtrToStringAnsi(get_last_runtime_error()) ?? "<null>";
+}
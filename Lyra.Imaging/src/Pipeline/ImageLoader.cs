@@ -1,7 +1,9 @@
 using System.Collections.Concurrent;
 using Lyra.Common;
 using Lyra.Common.SystemExtensions;
+using Lyra.Imaging.Codecs;
 using Lyra.Imaging.Content;
+using Lyra.Imaging.Interop;
 
 namespace Lyra.Imaging.Pipeline;
 
@@ -32,6 +34,7 @@ internal class ImageLoader
     #region Fields
 
     private readonly ConcurrentDictionary<string, Lazy<ImageJob>> _images = new();
+    private readonly ConcurrentDictionary<string, int> _layerSelection = new();
     private readonly TaskFactory _preloadTaskFactory = new(new PreloadTaskScheduler(2));
     private volatile Composite? _currentImage;
 
@@ -58,7 +61,14 @@ internal class ImageLoader
             throw;
         }
 
+        // The image on screen gets the foreground thread budget; one navigated away from drops back.
+        var previous = _currentImage;
+        if (previous != null && !ReferenceEquals(previous, job.Composite))
+            previous.IsBackground = true;
+
+        job.Composite.IsBackground = false;
         _currentImage = job.Composite;
+        SwapCompactContent(job.Composite);
         return job.Composite;
     }
 
@@ -69,11 +79,54 @@ internal class ImageLoader
             TryPreload(path);
     }
 
-    /// <summary>Remove everything not in 'keep' array. Cancels in-flight work and disposes completed images not current.</summary>
-    public void Cleanup(string[] keep)
+    /// <summary>
+    /// Remove everything outside the keep-window. Paths in 'keep' always stay, even past 'budgetBytes'; finished images in
+    /// 'nearest' (nearest first) are added while the window's cached pixels fit in 'budgetBytes', and the first that does
+    /// not fit ends it. The budget thus limits only what is kept beyond 'keep'.
+    /// Cancels in-flight work and disposes completed images not current, then releases native decode scratch that has
+    /// sat unused since the previous cleanup.
+    /// </summary>
+    public void Cleanup(string[] keep, string[] nearest, long budgetBytes)
     {
         var keepSet = new HashSet<string>(keep);
+        var usedBytes = 0L;
+        foreach (var path in keepSet)
+            usedBytes += FinishedComposite(path)?.CachedBytes ?? 0;
+
+        foreach (var path in nearest)
+        {
+            if (keepSet.Contains(path) || FinishedComposite(path) is not { } composite)
+                continue;
+
+            usedBytes += composite.CachedBytes;
+            if (usedBytes > budgetBytes)
+                break;
+
+            keepSet.Add(path);
+        }
+
         RemoveMatching(key => !keepSet.Contains(key), "Cleanup:");
+        NativeDecodeSession.TrimAll();
+    }
+
+    /// <summary>
+    /// Re-decodes the image with another layer (EXR part/AOV) selected and returns the new Composite.
+    /// The selection is remembered for the path, so navigating back keeps it.
+    /// </summary>
+    public Composite SelectLayer(string path, int layerIndex)
+    {
+        _layerSelection[path] = layerIndex;
+
+        var previous = _currentImage;
+        RemoveMatching(key => key == path, "Layer switch:");
+
+        var composite = GetImage(path);
+
+        // RemoveMatching skipped it while it was current; an in-flight job disposes it on completion instead.
+        if (previous != null && previous.State is not (CompositeState.Pending or CompositeState.Loading))
+            DisposeIfNotCurrent(previous);
+
+        return composite;
     }
 
     /// <summary>Disposes everything and cancels in-flight jobs.</summary>
@@ -88,7 +141,7 @@ internal class ImageLoader
 
     private ImageJob StartJob(string path, bool isPreload)
     {
-        var composite = new Composite(new FileInfo(path));
+        var composite = new Composite(new FileInfo(path)) { LayerIndex = _layerSelection.GetValueOrDefault(path), IsBackground = isPreload };
         var cts = new CancellationTokenSource();
 
         var task = isPreload
@@ -103,6 +156,32 @@ internal class ImageLoader
         };
     }
 
+    /// <summary>A composite whose load has finished, so no decoder thread touches its content any more.</summary>
+    private Composite? FinishedComposite(string path)
+    {
+        if (!_images.TryGetValue(path, out var lazy) || !lazy.IsValueCreated)
+            return null;
+
+        var job = lazy.Value;
+        return job.Task.IsCompleted && job.Composite.State == CompositeState.Complete ? job.Composite : null;
+    }
+
+    /// <summary>
+    /// Cached images off screen keep only compact retained pixels (RGBE), and the one becoming current gets its
+    /// display content back before it is drawn. Runs on the thread that draws, like re-tonemapping.
+    /// </summary>
+    private void SwapCompactContent(Composite current)
+    {
+        foreach (var (path, _) in _images)
+        {
+            if (FinishedComposite(path) is { } composite && !ReferenceEquals(composite, current))
+                FloatRgbaDecoderBase.ReleaseToneMapped(composite);
+        }
+
+        if (current.IsEmpty)
+            FloatRgbaDecoderBase.ApplyToneMapping(current);
+    }
+
     private Lazy<ImageJob> CreateLazyJob(string path, bool isPreload) =>
         new(() => StartJob(path, isPreload), LazyThreadSafetyMode.ExecutionAndPublication);
 
@@ -133,18 +212,30 @@ internal class ImageLoader
         var fileSize = composite.FileInfo.Length;
 
         composite.ImageFormatType = ImageFormat.GetImageFormat(extension);
-        composite.LoadTimeEstimated = LoadTimeEstimator.EstimateLoadTime(extension, fileSize);
 
+        long? decodeCost = null;
+        RasterLargeContent? cachedPreview = null;
         composite.Completed += OnCompleted;
 
         try
         {
             var decoder = DecoderManager.GetDecoder(composite.ImageFormatType);
+
+            // Header-only probe where the decoder supports it: decode cost predicts load time better than file size.
+            decodeCost = decoder.ProbeDecodeCost(composite.FileInfo.FullName);
+            composite.LoadTimeEstimated = decodeCost.HasValue
+                ? LoadTimeEstimator.EstimateLoadTime(extension, decodeCost.Value, isDecodeCost: true)
+                : LoadTimeEstimator.EstimateLoadTime(extension, fileSize);
+
             composite.State = CompositeState.Loading;
             composite.BeginLoadTiming();
 
             ct.ThrowIfCancellationRequested();
 
+            // Show the cached preview at once, for preloads as well as the current image. The decoder
+            // then replaces it with the full image, or streams tiles into it.
+            cachedPreview = PreviewCache.TryPublish(composite);
+
             await decoder.DecodeAsync(composite, ct).ConfigureAwait(false);
 
             ct.ThrowIfCancellationRequested();
@@ -167,6 +258,9 @@ internal class ImageLoader
                 if (composite.Content is not RasterLargeContent large || !large.HasTiles || (large.TilesTotal is int total && large.TilesReady >= total))
                     composite.SignalComplete();
             }
+
+            if (cachedPreview == null)
+                PreviewCache.Store(composite);
         }
         catch (OperationCanceledException)
         {
@@ -177,13 +271,24 @@ internal class ImageLoader
             Logger.Error($"[ImageLoader] Failed to load image {composite.FileInfo.FullName}: {ex}");
             composite.State = CompositeState.Failed;
         }
+        finally
+        {
+            // Still the content if the decode was cancelled or reused it; the composite disposes it then.
+            if (cachedPreview != null && !ReferenceEquals(composite.Content, cachedPreview))
+                cachedPreview.Dispose();
+        }
 
         return;
 
         void OnCompleted(Composite c)
         {
             if (c.LoadTimeComplete is double time)
-                LoadTimeEstimator.RecordLoadTime(extension, fileSize, time);
+            {
+                if (decodeCost.HasValue)
+                    LoadTimeEstimator.RecordLoadTime(extension, decodeCost.Value, time, isDecodeCost: true);
+                else
+                    LoadTimeEstimator.RecordLoadTime(extension, fileSize, time);
+            }
 
             c.Completed -= OnCompleted;
         }
@@ -20,9 +20,9 @@ internal static class LoadTimeEstimator
         LoadTimeDataFromFile();
     }
 
-    public static void RecordLoadTime(string extension, long sizeInBytes, double loadTime)
+    public static void RecordLoadTime(string extension, long sizeInBytes, double loadTime, bool isDecodeCost = false)
     {
-        if (!TryGetKey(extension, sizeInBytes, out var key))
+        if (!TryGetKey(extension, sizeInBytes, isDecodeCost, out var key))
             return;
 
         var list = LoadTimeData.GetOrAdd(key, _ => []);
@@ -43,9 +43,9 @@ internal static class LoadTimeEstimator
         }
     }
 
-    public static double EstimateLoadTime(string extension, long sizeInBytes)
+    public static double EstimateLoadTime(string extension, long sizeInBytes, bool isDecodeCost = false)
     {
-        if (!TryGetKey(extension, sizeInBytes, out var key))
+        if (!TryGetKey(extension, sizeInBytes, isDecodeCost, out var key))
             return 0;
 
         if (LoadTimeData.TryGetValue(key, out var loadTimes))
@@ -142,14 +142,17 @@ internal static class LoadTimeEstimator
         return Math.Max(bucket, 1); // Ensure minimum bucket of 1
     }
 
-    private static bool TryGetKey(string extension, long sizeInBytes, out (string Format, int SizeBucket) key)
+    // Decode-cost samples (bytes of stored samples, from a header probe) are kept apart from
+    // file-size samples of the same format, since the two scales are not comparable.
+    private static bool TryGetKey(string extension, long sizeInBytes, bool isDecodeCost, out (string Format, int SizeBucket) key)
     {
         key = default;
         var formatType = ImageFormat.GetImageFormat(extension);
         if (formatType == ImageFormatType.Unknown)
             return false;
 
-        key = (formatType.ToString().ToUpper(), GetSizeBucket(sizeInBytes));
+        var format = formatType.ToString().ToUpper();
+        key = (isDecodeCost ? format + "-DECODED" : format, GetSizeBucket(sizeInBytes));
         return true;
     }
 
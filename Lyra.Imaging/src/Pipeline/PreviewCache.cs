@@ -0,0 +1,343 @@
+using System.Buffers.Binary;
+using System.IO.MemoryMappedFiles;
+using System.Security.Cryptography;
+using System.Text;
+using Lyra.Common;
+using Lyra.Imaging.ConstraintsProvider;
+using Lyra.Imaging.Content;
+using SkiaSharp;
+
+namespace Lyra.Imaging.Pipeline;
+
+/// <summary>
+/// Display-sized RGBA8 previews of slow-to-decode images, kept on disk across sessions so revisiting a folder
+/// shows every image at once while the full decode runs behind it. One file per entry, named by a hash of
+/// path, size and modification time; a fixed header followed by tightly packed rows, read by mapping the file.
+/// Least recently used entries are evicted once the directory exceeds <see cref="MaxBytes"/>.
+/// </summary>
+internal static class PreviewCache
+{
+    private static readonly string CacheDirectory = Path.Combine(LyraDataDirectory.GetDataDirectory(), "preview_cache");
+
+    private const string EntryExtension = ".lpc";
+    private const uint Magic = 0x4350594C; // "LYPC"
+    // 2: HDR entries hold the default tone mapping, never the exposure active when they were stored.
+    private const int Version = 2;
+    private const int HeaderSize = 48;
+
+    // Files below this size decode faster than the cache round trip is worth, unless they are float formats.
+    private const long MinFileBytes = 32L * 1024 * 1024;
+
+    // Longest preview edge when no display size is known yet.
+    private const int FallbackEdge = 2048;
+
+    private static readonly object IndexLock = new();
+    private static Dictionary<string, (long Bytes, DateTime LastUsed)>? _index;
+    private static long _totalBytes;
+
+    /// <summary>Upper bound on the cache directory size.</summary>
+    public static long MaxBytes { get; set; } = 1024L * 1024 * 1024;
+
+    /// <summary>
+    /// Publishes the cached preview of the file as a <see cref="RasterLargeContent"/> and signals Ready.
+    /// Returns the published content, or null when there is no current entry.
+    /// </summary>
+    public static RasterLargeContent? TryPublish(Composite composite)
+    {
+        if (composite.LayerIndex != 0)
+            return null;
+
+        var fileInfo = composite.FileInfo;
+        var name = EntryName(fileInfo);
+        var path = Path.Combine(CacheDirectory, name);
+        if (!File.Exists(path))
+            return null;
+
+        try
+        {
+            var image = ReadEntry(path, fileInfo, out var fullWidth, out var fullHeight, out var isGrayscale);
+            if (image == null)
+            {
+                Remove(name, path);
+                return null;
+            }
+
+            var content = new RasterLargeContent(fullWidth, fullHeight, image);
+            composite.FullWidth = fullWidth;
+            composite.FullHeight = fullHeight;
+            composite.IsGrayscale = isGrayscale;
+            composite.Content = content;
+            composite.SignalReady();
+
+            Touch(name, path);
+            Logger.Debug($"[PreviewCache] Hit {image.Width}x{image.Height} for {fullWidth}x{fullHeight}: {fileInfo.FullName}");
+            return content;
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"[PreviewCache] Dropping unreadable entry for {fileInfo.FullName}: {ex.Message}");
+            Remove(name, path);
+            return null;
+        }
+    }
+
+    /// <summary>
+    /// Stores a display-sized copy of a freshly decoded image, if it is worth caching and not cached yet. Entries hold the
+    /// encoding a decode produces: an image with retained HDR pixels is tone-mapped from those with the default settings
+    /// into its own copy, since its content belongs to the drawing thread, which re-tonemaps and releases it at any time.
+    /// Other content is only replaced by its decoder, which has finished.
+    /// </summary>
+    public static void Store(Composite composite)
+    {
+        if (composite.LayerIndex != 0 || composite.State == CompositeState.Disposed || !IsWorthCaching(composite))
+            return;
+
+        var retained = composite.RetainedHdr;
+        var source = retained != null ? null : composite.Content switch
+        {
+            RasterContent { IsLinear: false } raster => raster.Image,   // linear (half float) pixels need the display curve first
+            RasterLargeContent large => large.FullImage ?? large.PreviewImage,
+            _ => null
+        };
+
+        if ((retained == null && source == null) || composite.LogicalWidth <= 0 || composite.LogicalHeight <= 0)
+            return;
+
+        var fileInfo = composite.FileInfo;
+        var name = EntryName(fileInfo);
+        var path = Path.Combine(CacheDirectory, name);
+        if (File.Exists(path))
+            return;
+
+        SKImage? copy = null;
+        try
+        {
+            if (retained != null)
+                source = copy = retained.ToneMapCopy(ToneMapSettings.Default);
+
+            using var bitmap = ScaleToDisplay(source!);
+            var bytes = WriteEntry(path, fileInfo, bitmap, (int)composite.LogicalWidth, (int)composite.LogicalHeight, composite.IsGrayscale);
+            Add(name, bytes);
+            Logger.Debug($"[PreviewCache] Stored {bitmap.Width}x{bitmap.Height} ({bytes / 1024} kB): {fileInfo.FullName}");
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"[PreviewCache] Failed to store preview for {fileInfo.FullName}: {ex.Message}");
+        }
+        finally
+        {
+            copy?.Dispose();
+        }
+    }
+
+    private static bool IsWorthCaching(Composite composite) =>
+        composite.ImageFormatType is ImageFormatType.Exr or ImageFormatType.Hdr ||
+        composite.Content is RasterLargeContent ||
+        composite.FileInfo.Length >= MinFileBytes;
+
+    private static string EntryName(FileInfo fileInfo)
+    {
+        var key = $"{fileInfo.FullName}|{fileInfo.Length}|{fileInfo.LastWriteTimeUtc.Ticks}";
+        return Convert.ToHexString(SHA1.HashData(Encoding.UTF8.GetBytes(key))) + EntryExtension;
+    }
+
+    private static SKBitmap ScaleToDisplay(SKImage source)
+    {
+        var constraints = DecodeConstraintsProvider.Current;
+        var maxWidth = constraints.Width > 0 ? constraints.Width : FallbackEdge;
+        var maxHeight = constraints.Height > 0 ? constraints.Height : FallbackEdge;
+        var scale = MathF.Min(1f, MathF.Min((float)maxWidth / source.Width, (float)maxHeight / source.Height));
+
+        var width = Math.Max(1, (int)MathF.Round(source.Width * scale));
+        var height = Math.Max(1, (int)MathF.Round(source.Height * scale));
+        var bitmap = new SKBitmap(new SKImageInfo(width, height, SKColorType.Rgba8888, SKAlphaType.Unpremul));
+
+        using var pixmap = bitmap.PeekPixels();
+        if (!source.ScalePixels(pixmap, new SKSamplingOptions(SKFilterMode.Linear, SKMipmapMode.Linear)))
+        {
+            bitmap.Dispose();
+            throw new InvalidOperationException($"Failed to scale {source.Width}x{source.Height} to {width}x{height}.");
+        }
+
+        return bitmap;
+    }
+
+    // Header (little endian): magic, version, width, height, full width, full height, grayscale flag, padding,
+    // source file length, source mtime ticks. Rows follow at HeaderSize with stride width * 4.
+    private static long WriteEntry(string path, FileInfo fileInfo, SKBitmap bitmap, int fullWidth, int fullHeight, bool isGrayscale)
+    {
+        Directory.CreateDirectory(CacheDirectory);
+
+        Span<byte> header = stackalloc byte[HeaderSize];
+        header.Clear();
+        BinaryPrimitives.WriteUInt32LittleEndian(header, Magic);
+        BinaryPrimitives.WriteInt32LittleEndian(header[4..], Version);
+        BinaryPrimitives.WriteInt32LittleEndian(header[8..], bitmap.Width);
+        BinaryPrimitives.WriteInt32LittleEndian(header[12..], bitmap.Height);
+        BinaryPrimitives.WriteInt32LittleEndian(header[16..], fullWidth);
+        BinaryPrimitives.WriteInt32LittleEndian(header[20..], fullHeight);
+        header[24] = isGrayscale ? (byte)1 : (byte)0;
+        BinaryPrimitives.WriteInt64LittleEndian(header[32..], fileInfo.Length);
+        BinaryPrimitives.WriteInt64LittleEndian(header[40..], fileInfo.LastWriteTimeUtc.Ticks);
+
+        // Written under a temporary name and moved into place, so a reader never maps a half-written entry.
+        var tempPath = path + "." + Environment.CurrentManagedThreadId + ".tmp";
+        using (var stream = new FileStream(tempPath, FileMode.Create, FileAccess.Write, FileShare.None))
+        {
+            stream.Write(header);
+            var rowBytes = bitmap.Width * 4;
+            var pixels = bitmap.GetPixelSpan();
+            for (var y = 0; y < bitmap.Height; y++)
+                stream.Write(pixels.Slice(y * bitmap.RowBytes, rowBytes));
+        }
+
+        File.Move(tempPath, path, overwrite: true);
+        return HeaderSize + (long)bitmap.Width * bitmap.Height * 4;
+    }
+
+    private static unsafe SKImage? ReadEntry(string path, FileInfo fileInfo, out int fullWidth, out int fullHeight, out bool isGrayscale)
+    {
+        fullWidth = fullHeight = 0;
+        isGrayscale = false;
+
+        using var mapped = MemoryMappedFile.CreateFromFile(path, FileMode.Open, null, 0, MemoryMappedFileAccess.Read);
+        using var view = mapped.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+
+        byte* pointer = null;
+        view.SafeMemoryMappedViewHandle.AcquirePointer(ref pointer);
+        try
+        {
+            var length = (long)view.SafeMemoryMappedViewHandle.ByteLength;
+            if (length < HeaderSize)
+                return null;
+
+            var data = pointer + view.PointerOffset;
+            var header = new ReadOnlySpan<byte>(data, HeaderSize);
+            var width = BinaryPrimitives.ReadInt32LittleEndian(header[8..]);
+            var height = BinaryPrimitives.ReadInt32LittleEndian(header[12..]);
+
+            if (BinaryPrimitives.ReadUInt32LittleEndian(header) != Magic ||
+                BinaryPrimitives.ReadInt32LittleEndian(header[4..]) != Version ||
+                BinaryPrimitives.ReadInt64LittleEndian(header[32..]) != fileInfo.Length ||
+                BinaryPrimitives.ReadInt64LittleEndian(header[40..]) != fileInfo.LastWriteTimeUtc.Ticks ||
+                width <= 0 || height <= 0 || length < HeaderSize + (long)width * height * 4)
+                return null;
+
+            fullWidth = BinaryPrimitives.ReadInt32LittleEndian(header[16..]);
+            fullHeight = BinaryPrimitives.ReadInt32LittleEndian(header[20..]);
+            isGrayscale = header[24] != 0;
+            if (fullWidth <= 0 || fullHeight <= 0)
+                return null;
+
+            // One copy out of the page cache; the mapping is released as soon as this returns.
+            var info = new SKImageInfo(width, height, SKColorType.Rgba8888, SKAlphaType.Unpremul);
+            return SKImage.FromPixelCopy(info, (IntPtr)(data + HeaderSize), width * 4);
+        }
+        finally
+        {
+            view.SafeMemoryMappedViewHandle.ReleasePointer();
+        }
+    }
+
+    #region LRU index
+
+    private static Dictionary<string, (long Bytes, DateTime LastUsed)> EnsureIndex()
+    {
+        if (_index != null)
+            return _index;
+
+        _index = new Dictionary<string, (long Bytes, DateTime LastUsed)>();
+        _totalBytes = 0;
+
+        if (Directory.Exists(CacheDirectory))
+        {
+            foreach (var file in new DirectoryInfo(CacheDirectory).EnumerateFiles("*" + EntryExtension))
+            {
+                _index[file.Name] = (file.Length, file.LastWriteTimeUtc);
+                _totalBytes += file.Length;
+            }
+        }
+
+        return _index;
+    }
+
+    // Entry mtimes record last use, so the order survives restarts.
+    private static void Touch(string name, string path)
+    {
+        var now = DateTime.UtcNow;
+        lock (IndexLock)
+        {
+            var index = EnsureIndex();
+            if (index.TryGetValue(name, out var entry))
+                index[name] = (entry.Bytes, now);
+        }
+
+        try
+        {
+            File.SetLastWriteTimeUtc(path, now);
+        }
+        catch (IOException)
+        {
+            /* best effort */
+        }
+    }
+
+    private static void Add(string name, long bytes)
+    {
+        List<string> evicted = [];
+        lock (IndexLock)
+        {
+            var index = EnsureIndex();
+            if (index.TryGetValue(name, out var existing))
+                _totalBytes -= existing.Bytes;
+
+            index[name] = (bytes, DateTime.UtcNow);
+            _totalBytes += bytes;
+
+            if (_totalBytes > MaxBytes)
+            {
+                foreach (var (oldName, entry) in index.Where(e => e.Key != name).OrderBy(e => e.Value.LastUsed).ToList())
+                {
+                    if (_totalBytes <= MaxBytes)
+                        break;
+
+                    index.Remove(oldName);
+                    _totalBytes -= entry.Bytes;
+                    evicted.Add(oldName);
+                }
+            }
+        }
+
+        foreach (var oldName in evicted)
+            TryDelete(Path.Combine(CacheDirectory, oldName));
+
+        if (evicted.Count > 0)
+            Logger.Debug($"[PreviewCache] Evicted {evicted.Count} entries.");
+    }
+
+    private static void Remove(string name, string path)
+    {
+        lock (IndexLock)
+        {
+            var index = EnsureIndex();
+            if (index.Remove(name, out var entry))
+                _totalBytes -= entry.Bytes;
+        }
+
+        TryDelete(path);
+    }
+
+    private static void TryDelete(string path)
+    {
+        try
+        {
+            File.Delete(path);
+        }
+        catch (Exception ex)
+        {
+            Logger.Warning($"[PreviewCache] Failed to delete {path}: {ex.Message}");
+        }
+    }
+
+    #endregion
+}
@@ -0,0 +1,216 @@
+#ifndef LYRA_BENCH_HARNESS_H
+#define LYRA_BENCH_HARNESS_H
+
+/* Header-only helpers shared by the native decode benchmarks (hdr_bench, exr_bench):
+ * command line options, a deterministic HDR test pattern, per-stage timing with peak
+ * RSS, and the JSON report. Built only with -DLYRA_BUILD_BENCHMARKS=ON. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cpu_dispatch.h"
+#include "parallel.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace lyra::bench {
+
+struct Options {
+    std::vector<int> sizes{1024, 4096}; // image widths; heights are half, like a lat-long panorama
+    int iterations = 5;
+    std::string corpus = "bench_corpus";
+    std::string out;                     // empty: JSON goes to stdout
+};
+
+struct StageResult {
+    std::string file;
+    std::string stage;
+    int width = 0;
+    int height = 0;
+    int iterations = 0;
+    double best_ms = 0;
+    double median_ms = 0;
+    long long peak_rss_bytes = 0; // process peak while the stage ran, -1 if unknown
+};
+
+inline std::vector<int> parse_sizes(const char *list) {
+    std::vector<int> sizes;
+    for (const char *p = list; *p;) {
+        char *end = nullptr;
+        long v = std::strtol(p, &end, 10);
+        if (end == p || v < 16 || v > 65536)
+            throw std::invalid_argument(std::string("Invalid size list: ") + list);
+        sizes.push_back(static_cast<int>(v) & ~1);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return sizes;
+}
+
+inline Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--sizes" && has_value)
+            options.sizes = parse_sizes(argv[++i]);
+        else if (arg == "--iterations" && has_value)
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--corpus" && has_value)
+            options.corpus = argv[++i];
+        else if (arg == "--out" && has_value)
+            options.out = argv[++i];
+        else
+            throw std::invalid_argument("Usage: " + std::string(argv[0]) +
+                                        " [--sizes 1024,4096] [--iterations 5] [--corpus dir] [--out results.json]");
+    }
+    return options;
+}
+
+/* Deterministic HDR content: a sky gradient, a small very bright sun, and hashed noise so
+ * RLE and wavelet codecs see realistic rather than flat data. Values span about 0..5000. */
+inline void fill_test_pattern(float *rgba, int width, int height, int channels) {
+    for (int y = 0; y < height; ++y) {
+        float v = static_cast<float>(y) / static_cast<float>(height);
+        for (int x = 0; x < width; ++x) {
+            float u = static_cast<float>(x) / static_cast<float>(width);
+            uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u;
+            h = (h ^ (h >> 13)) * 1274126177u;
+            float noise = static_cast<float>(h & 0xFFFF) / 65535.0f * 0.05f;
+
+            float du = u - 0.3f, dv = (v - 0.25f) * 2.0f;
+            float sun = 5000.0f * std::exp(-(du * du + dv * dv) * 4000.0f);
+            float sky = 0.2f + 1.5f * (1.0f - v);
+
+            float *p = rgba + (static_cast<size_t>(y) * width + x) * channels;
+            p[0] = sky * 0.6f + sun + noise;
+            p[1] = sky * 0.8f + sun + noise;
+            p[2] = sky * 1.2f + sun * 0.9f + noise;
+            if (channels == 4)
+                p[3] = 1.0f;
+        }
+    }
+}
+
+/* Resets the peak RSS counter where the OS allows it (Linux); elsewhere peaks are process-wide. */
+inline void reset_peak_rss() {
+#if defined(__linux__)
+    if (FILE *f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+#endif
+}
+
+inline long long peak_rss_bytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<long long>(counters.PeakWorkingSetSize);
+    return -1;
+#elif defined(__linux__)
+    if (FILE *f = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long long kb = -1;
+        while (std::fgets(line, sizeof(line), f))
+            if (std::sscanf(line, "VmHWM: %lld kB", &kb) == 1)
+                break;
+        std::fclose(f);
+        return kb < 0 ? -1 : kb * 1024;
+    }
+    return -1;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(__APPLE__)
+    return static_cast<long long>(usage.ru_maxrss);
+#else
+    return static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/* Runs fn `iterations` times. fn returns false on failure, which aborts the benchmark with
+ * `describe_error()` so a broken decoder never reports a fast time. */
+template <typename Fn, typename ErrorFn>
+StageResult run_stage(const std::string &file, const char *stage, int width, int height, int iterations, Fn &&fn,
+                      ErrorFn &&describe_error) {
+    std::vector<double> times;
+    times.reserve(iterations);
+    reset_peak_rss();
+
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = fn();
+        auto end = std::chrono::steady_clock::now();
+        if (!ok)
+            throw std::runtime_error(file + " / " + stage + ": " + describe_error());
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    StageResult result;
+    result.file = file;
+    result.stage = stage;
+    result.width = width;
+    result.height = height;
+    result.iterations = iterations;
+    result.best_ms = times.front();
+    result.median_ms = times[times.size() / 2];
+    result.peak_rss_bytes = peak_rss_bytes();
+
+    std::fprintf(stderr, "%-40s %-14s %8.2f ms  %8.1f MP/s\n", file.c_str(), stage, result.median_ms,
+                 result.median_ms > 0 ? width * static_cast<double>(height) / 1e3 / result.median_ms : 0.0);
+    return result;
+}
+
+inline std::string json_escape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+/* One object per run; stable key order so reports from two commits diff line by line. */
+inline void write_json(const Options &options, const char *suite, const std::vector<StageResult> &results) {
+    FILE *f = options.out.empty() ? stdout : std::fopen(options.out.c_str(), "w");
+    if (!f)
+        throw std::runtime_error("Cannot write " + options.out);
+
+    std::fprintf(f, "{\n  \"suite\": \"%s\",\n  \"isa\": \"%s\",\n  \"threads\": %u,\n  \"iterations\": %d,\n  \"results\": [\n",
+                 suite, cpu_isa_name(cpu_isa()), hardware_threads(), options.iterations);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const StageResult &r = results[i];
+        double mpix = r.width * static_cast<double>(r.height) / 1e6;
+        std::fprintf(f,
+                     "    {\"file\": \"%s\", \"stage\": \"%s\", \"width\": %d, \"height\": %d, \"best_ms\": %.3f, "
+                     "\"median_ms\": %.3f, \"mp_per_s\": %.2f, \"peak_rss_bytes\": %lld}%s\n",
+                     json_escape(r.file).c_str(), r.stage.c_str(), r.width, r.height, r.best_ms, r.median_ms,
+                     r.median_ms > 0 ? mpix * 1e3 / r.median_ms : 0.0, r.peak_rss_bytes,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+
+    if (f != stdout)
+        std::fclose(f);
+}
+
+} // namespace lyra::bench
+
+#endif // LYRA_BENCH_HARNESS_H
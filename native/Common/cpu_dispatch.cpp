@@ -0,0 +1,104 @@
+#include "cpu_dispatch.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LYRA_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
+namespace lyra {
+
+namespace {
+
+constexpr const char *isa_names[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+
+#ifdef LYRA_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+CpuIsa detect_x86() {
+    int regs[4];
+    __cpuid(regs, 0);
+    int max_leaf = regs[0];
+
+    __cpuid(regs, 1);
+    bool sse2 = (regs[3] & (1 << 26)) != 0;
+    bool fma = (regs[2] & (1 << 12)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    bool f16c = (regs[2] & (1 << 29)) != 0;
+    if (!sse2)
+        return CpuIsa::scalar;
+
+    // The OS has to save YMM (and for AVX-512 the opmask and ZMM) state across context switches.
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool avx2 = false, avx512f = false;
+    if (max_leaf >= 7) {
+        __cpuidex(regs, 7, 0);
+        avx2 = (regs[1] & (1 << 5)) != 0;
+        avx512f = (regs[1] & (1 << 16)) != 0;
+    }
+
+    if (!(avx && avx2 && fma && f16c) || (xcr0 & 0x6) != 0x6)
+        return CpuIsa::sse2;
+    return avx512f && (xcr0 & 0xE6) == 0xE6 ? CpuIsa::avx512 : CpuIsa::avx2;
+}
+#else
+CpuIsa detect_x86() {
+    // libgcc and compiler-rt check the OS-enabled register state along with the CPUID bits.
+    if (!__builtin_cpu_supports("sse2"))
+        return CpuIsa::scalar;
+    if (!(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")))
+        return CpuIsa::sse2;
+    return __builtin_cpu_supports("avx512f") ? CpuIsa::avx512 : CpuIsa::avx2;
+}
+#endif
+#endif
+
+CpuIsa detect_isa() {
+#if defined(LYRA_X86)
+    return detect_x86();
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return CpuIsa::neon; // part of the AArch64 baseline
+#else
+    return CpuIsa::scalar;
+#endif
+}
+
+bool runs_on(CpuIsa isa, CpuIsa best) {
+    if (isa == CpuIsa::scalar || isa == best)
+        return true;
+    if (isa == CpuIsa::neon || best == CpuIsa::neon)
+        return false;
+    return static_cast<int>(isa) <= static_cast<int>(best);
+}
+
+CpuIsa select_isa() {
+    CpuIsa best = detect_isa();
+    const char *requested = std::getenv("LYRA_NATIVE_ISA");
+    if (!requested || !*requested)
+        return best;
+
+    for (int i = 0; i < static_cast<int>(sizeof(isa_names) / sizeof(isa_names[0])); ++i) {
+        auto isa = static_cast<CpuIsa>(i);
+        if (std::strcmp(requested, isa_names[i]) == 0 && runs_on(isa, best))
+            return isa;
+    }
+    return best;
+}
+
+} // namespace
+
+CpuIsa cpu_isa() {
+    static const CpuIsa isa = select_isa();
+    return isa;
+}
+
+const char *cpu_isa_name(CpuIsa isa) {
+    return isa_names[static_cast<int>(isa)];
+}
+
+} // namespace lyra
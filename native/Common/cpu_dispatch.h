@@ -0,0 +1,19 @@
+#ifndef LYRA_CPU_DISPATCH_H
+#define LYRA_CPU_DISPATCH_H
+
+namespace lyra {
+
+/* Instruction set tiers the pixel kernels are built for. On x86 each tier includes the ones
+ * below it: avx2 also requires F16C and FMA, avx512 means AVX-512F on top of avx2. */
+enum class CpuIsa { scalar, sse2, avx2, avx512, neon };
+
+/* Tier the kernels run at, decided once on first call: the best one this build, the CPU and the
+ * OS support, unless LYRA_NATIVE_ISA names another supported tier (scalar, sse2, avx2, avx512,
+ * neon). Unknown or unsupported names are ignored, so the override can only lower the tier. */
+CpuIsa cpu_isa();
+
+const char *cpu_isa_name(CpuIsa isa);
+
+} // namespace lyra
+
+#endif // LYRA_CPU_DISPATCH_H
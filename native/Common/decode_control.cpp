@@ -0,0 +1,104 @@
+#include "decode_control.h"
+
+#include <algorithm>
+#include "scratch_pool.h"
+
+namespace lyra {
+
+DecodeStats::DecodeStats(const lyra_decode_control *control)
+    : out_(control ? control->stats : nullptr), start_(std::chrono::steady_clock::now()) {}
+
+DecodeStats::~DecodeStats() {
+    if (!out_)
+        return;
+
+    auto ms = [](long long ns) { return static_cast<double>(ns) / 1e6; };
+    out_->total_ms = ms(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    out_->open_ms = ms(stage_ns_[open].load());
+    out_->header_ms = ms(stage_ns_[header].load());
+    out_->decompress_ms = ms(stage_ns_[decompress].load());
+    out_->convert_ms = ms(stage_ns_[convert].load());
+    out_->tonemap_ms = ms(stage_ns_[tonemap].load());
+    out_->io_bytes = io_bytes_;
+    out_->peak_scratch_bytes = peak_scratch_.load();
+    out_->threads = threads_;
+}
+
+void DecodeStats::add(Stage stage, std::chrono::steady_clock::duration elapsed) {
+    if (out_)
+        stage_ns_[stage].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+}
+
+void DecodeStats::add_scratch(long long bytes) {
+    if (!out_)
+        return;
+
+    long long now = scratch_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    long long peak = peak_scratch_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_scratch_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+StageTimer::StageTimer(DecodeStats *stats, DecodeStats::Stage stage)
+    : stats_(stats && stats->enabled() ? stats : nullptr), stage_(stage) {
+    if (stats_)
+        start_ = std::chrono::steady_clock::now();
+}
+
+void StageTimer::stop() {
+    if (!stats_)
+        return;
+
+    stats_->add(stage_, std::chrono::steady_clock::now() - start_);
+    stats_ = nullptr;
+}
+
+ScratchBytes::ScratchBytes(DecodeStats *stats, size_t bytes)
+    : stats_(stats && stats->enabled() ? stats : nullptr), bytes_(static_cast<long long>(bytes)) {
+    if (stats_)
+        stats_->add_scratch(bytes_);
+}
+
+ScratchBytes::~ScratchBytes() {
+    if (stats_)
+        stats_->add_scratch(-bytes_);
+}
+
+DecodeMonitor::DecodeMonitor(const lyra_decode_control *control, int rows_total, DecodeStats *stats,
+                             ImageStats *image_stats)
+    : control_(control), stats_(stats), image_stats_(image_stats), rows_total_(rows_total), report_step_(std::max(1, rows_total / 256)) {}
+
+ScratchPool *DecodeMonitor::scratch_pool() const {
+    return control_ && control_->session ? &control_->session->pool : nullptr;
+}
+
+bool DecodeMonitor::cancelled() const {
+    return control_ && control_->cancel && *control_->cancel != 0;
+}
+
+void DecodeMonitor::check() const {
+    if (cancelled())
+        throw decode_cancelled();
+}
+
+void DecodeMonitor::advance(int rows) {
+    if (!control_)
+        return;
+
+    if (control_->progress) {
+        int done = rows_done_.fetch_add(rows, std::memory_order_relaxed) + rows;
+        if (done / report_step_ != (done - rows) / report_step_ || done >= rows_total_) {
+            std::lock_guard<std::mutex> lock(report_mutex_);
+            // Workers finish out of order; only ever report forward.
+            done = rows_done_.load(std::memory_order_relaxed);
+            if (done > rows_reported_) {
+                rows_reported_ = done;
+                control_->progress(std::min(done, rows_total_), rows_total_, control_->user);
+            }
+        }
+    }
+
+    check();
+}
+
+} // namespace lyra
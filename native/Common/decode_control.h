@@ -0,0 +1,119 @@
+#ifndef LYRA_DECODE_CONTROL_H
+#define LYRA_DECODE_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include "image_stats.h"
+#include "lyra_decode.h"
+
+namespace lyra {
+
+class ScratchPool;
+
+/* Thrown out of row loops once the caller raised the cancel flag. */
+struct decode_cancelled : std::exception {
+    const char *what() const noexcept override { return "Decode cancelled."; }
+};
+
+/* Collects lyra_decode_stats for one decode when the control block asks for them; otherwise
+ * every call is a cheap no-op. Stage times may be added from any thread. The results are
+ * written to control->stats on destruction, so failed and cancelled decodes report too. */
+class DecodeStats {
+public:
+    enum Stage { open, header, decompress, convert, tonemap, stage_count };
+
+    explicit DecodeStats(const lyra_decode_control *control);
+    ~DecodeStats();
+
+    DecodeStats(const DecodeStats &) = delete;
+    DecodeStats &operator=(const DecodeStats &) = delete;
+
+    bool enabled() const { return out_ != nullptr; }
+
+    void add(Stage stage, std::chrono::steady_clock::duration elapsed);
+    void add_scratch(long long bytes); /* negative when scratch is released */
+    void set_io_bytes(long long bytes) { io_bytes_ = bytes; }
+    void set_threads(int threads) { threads_ = threads; }
+
+    /* RGBA8 targets get the display curve while converting, so that time is tone mapping. */
+    static Stage conversion_stage(int format) { return format == LYRA_PIXEL_RGBA8 ? tonemap : convert; }
+
+private:
+    lyra_decode_stats *out_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<long long> stage_ns_[stage_count] = {};
+    std::atomic<long long> scratch_{0};
+    std::atomic<long long> peak_scratch_{0};
+    long long io_bytes_ = 0;
+    int threads_ = 0;
+};
+
+/* Adds the time until stop() or destruction to one stage. Null or disabled stats: no clock reads. */
+class StageTimer {
+public:
+    StageTimer(DecodeStats *stats, DecodeStats::Stage stage);
+    ~StageTimer() { stop(); }
+
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+    void stop();
+
+private:
+    DecodeStats *stats_;
+    DecodeStats::Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/* Counts a scratch buffer towards peak_scratch_bytes for the lifetime of the object. */
+class ScratchBytes {
+public:
+    ScratchBytes(DecodeStats *stats, size_t bytes);
+    ~ScratchBytes();
+
+    ScratchBytes(const ScratchBytes &) = delete;
+    ScratchBytes &operator=(const ScratchBytes &) = delete;
+
+private:
+    DecodeStats *stats_;
+    long long bytes_;
+};
+
+/* Cancellation polling and progress reporting for one decode, shared by its worker threads.
+ * A null control makes every call a cheap no-op. Also carries the decode's stats collectors
+ * and scratch pool, if any, to the row loops. */
+class DecodeMonitor {
+public:
+    DecodeMonitor(const lyra_decode_control *control, int rows_total, DecodeStats *stats = nullptr,
+                  ImageStats *image_stats = nullptr);
+
+    DecodeStats *stats() const { return stats_; }
+    ImageStats *image_stats() const { return image_stats_; }
+    ScratchPool *scratch_pool() const;
+
+    bool cancelled() const;
+
+    /* Throws decode_cancelled when the caller raised the cancel flag. */
+    void check() const;
+
+    /* Records finished rows, reports progress roughly every 1/256 of the image and
+     * then checks for cancellation. */
+    void advance(int rows);
+
+private:
+    const lyra_decode_control *control_;
+    DecodeStats *stats_;
+    ImageStats *image_stats_;
+    int rows_total_;
+    int report_step_;
+    std::atomic<int> rows_done_{0};
+    int rows_reported_ = 0;
+    std::mutex report_mutex_;
+};
+
+} // namespace lyra
+
+#endif // LYRA_DECODE_CONTROL_H
@@ -0,0 +1,397 @@
+#include "image_stats.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "pixel_kernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LYRA_SSE2 1
+#endif
+
+namespace lyra {
+
+namespace {
+
+static_assert(LYRA_HISTOGRAM_BINS_PER_STOP == 8, "histogram bins are read from the top 3 mantissa bits");
+
+/* Exponent and top three mantissa bits of a positive float are log2 in eighth stops, close
+ * enough for a histogram and far cheaper than std::log2. */
+constexpr int histogram_bias = (127 + LYRA_HISTOGRAM_LOG2_MIN) * LYRA_HISTOGRAM_BINS_PER_STOP;
+
+int histogram_bin(float y) {
+    if (!(y > 0.0f))
+        return 0;
+
+    uint32_t bits;
+    std::memcpy(&bits, &y, sizeof(bits));
+    int bin = static_cast<int>(bits >> 20) - histogram_bias;
+    return bin < 0 ? 0 : (bin >= LYRA_HISTOGRAM_BINS ? LYRA_HISTOGRAM_BINS - 1 : bin);
+}
+
+bool is_finite(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x7F800000u) != 0x7F800000u;
+}
+
+float luminance(float r, float g, float b) {
+    return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+}
+
+/* Accumulates pixels of one row one at a time, with full NaN/Inf handling. Used on its own
+ * without SSE2, and by the vector loop for row tails and groups holding non-finite samples.
+ * finish() folds the row into the partial. */
+class ScalarRow {
+public:
+    explicit ScalarRow(ImageStatsPartial &s)
+        : s_(s), opaque(s.alpha_opaque), equal(s.rgb_equal), chroma_zero(s.chroma_zero) {
+        for (int c = 0; c < 4; ++c) {
+            mn[c] = s.min[c];
+            mx[c] = s.max[c];
+        }
+    }
+
+    void add(float r, float g, float b, float a) {
+        const float v[4] = {r, g, b, a};
+        bool finite_rgb = true;
+        for (int c = 0; c < 4; ++c) {
+            if (is_finite(v[c])) {
+                mn[c] = v[c] < mn[c] ? v[c] : mn[c];
+                mx[c] = v[c] > mx[c] ? v[c] : mx[c];
+                sum[c] += v[c];
+                ++finite[c];
+            } else {
+                if (v[c] != v[c])
+                    ++s_.nan_count;
+                else
+                    ++s_.inf_count;
+                finite_rgb = finite_rgb && c == 3;
+            }
+        }
+
+        opaque = opaque && a == 1.0f;
+        equal = equal && r == g && g == b;
+        chroma_zero = chroma_zero && g == 0.0f && b == 0.0f;
+
+        if (finite_rgb) {
+            ++s_.histogram[histogram_bin(luminance(r, g, b))];
+            // Only needed if the image turns out to be single channel, i.e. G and B stay zero.
+            if (chroma_zero)
+                ++s_.red_histogram[histogram_bin(r)];
+        }
+    }
+
+    void finish(int width) {
+        for (int c = 0; c < 4; ++c) {
+            s_.min[c] = mn[c];
+            s_.max[c] = mx[c];
+            s_.sum[c] += sum[c];
+            s_.finite[c] += finite[c];
+        }
+        s_.alpha_opaque = opaque;
+        s_.rgb_equal = equal;
+        s_.chroma_zero = chroma_zero;
+        s_.pixels += width;
+    }
+
+    ImageStatsPartial &s_;
+    float mn[4], mx[4];
+    double sum[4] = {};
+    long long finite[4] = {};
+    bool opaque, equal, chroma_zero;
+};
+
+#ifdef LYRA_SSE2
+/* Four pixels at a time, one register per channel (structure of arrays). `load4(x, c)` fills
+ * c[0..3] with R, G, B, A of pixels x..x+3 and `load1(x, v)` one pixel, both as linear floats.
+ * Float sums are flushed to double every `block` pixels; bins are counted in one local
+ * histogram per lane so neighbouring pixels never wait on the same counter. */
+template <typename Load4, typename Load1>
+void accumulate_row(ImageStatsPartial &s, int width, Load4 load4, Load1 load1) {
+    constexpr int block = 256;
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 exponent = _mm_castsi128_ps(_mm_set1_epi32(0x7F800000));
+    const __m128 kr = _mm_set1_ps(0.2126f), kg = _mm_set1_ps(0.7152f), kb = _mm_set1_ps(0.0722f);
+    const __m128i bias = _mm_set1_epi32(histogram_bias);
+    const __m128i last_bin = _mm_set1_epi32(LYRA_HISTOGRAM_BINS - 1);
+
+    ScalarRow scalar(s);
+    __m128 mn[4], mx[4], sum[4];
+    for (int c = 0; c < 4; ++c) {
+        mn[c] = _mm_set1_ps(scalar.mn[c]);
+        mx[c] = _mm_set1_ps(scalar.mx[c]);
+        sum[c] = zero;
+    }
+    __m128 opaque = _mm_cmpeq_ps(zero, zero), equal = opaque, chroma_zero = opaque;
+    long long vector_pixels = 0;
+    uint32_t lane_histogram[4][LYRA_HISTOGRAM_BINS] = {};
+
+    auto bins_of = [&](__m128 y, int32_t (&out)[4]) {
+        __m128i bin = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(y), 20), bias);
+        bin = _mm_and_si128(bin, _mm_castps_si128(_mm_cmpgt_ps(y, zero)));      // y <= 0, NaN: bin 0
+        bin = _mm_and_si128(bin, _mm_cmpgt_epi32(bin, _mm_setzero_si128()));    // below the range: bin 0
+        __m128i over = _mm_cmpgt_epi32(bin, last_bin);
+        bin = _mm_or_si128(_mm_and_si128(over, last_bin), _mm_andnot_si128(over, bin));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), bin);
+    };
+
+    int x = 0;
+    for (int flushed = 0; x + 4 <= width; x += 4) {
+        __m128 c[4];
+        load4(x, c);
+
+        __m128 non_finite = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(_mm_and_ps(c[0], exponent), exponent),
+                                                _mm_cmpeq_ps(_mm_and_ps(c[1], exponent), exponent)),
+                                      _mm_or_ps(_mm_cmpeq_ps(_mm_and_ps(c[2], exponent), exponent),
+                                                _mm_cmpeq_ps(_mm_and_ps(c[3], exponent), exponent)));
+        if (_mm_movemask_ps(non_finite)) {
+            for (int i = 0; i < 4; ++i) {
+                float v[4];
+                load1(x + i, v);
+                scalar.add(v[0], v[1], v[2], v[3]);
+            }
+            continue;
+        }
+
+        for (int ch = 0; ch < 4; ++ch) {
+            mn[ch] = _mm_min_ps(mn[ch], c[ch]);
+            mx[ch] = _mm_max_ps(mx[ch], c[ch]);
+            sum[ch] = _mm_add_ps(sum[ch], c[ch]);
+        }
+        opaque = _mm_and_ps(opaque, _mm_cmpeq_ps(c[3], one));
+        equal = _mm_and_ps(equal, _mm_and_ps(_mm_cmpeq_ps(c[0], c[1]), _mm_cmpeq_ps(c[1], c[2])));
+        chroma_zero = _mm_and_ps(chroma_zero, _mm_and_ps(_mm_cmpeq_ps(c[1], zero), _mm_cmpeq_ps(c[2], zero)));
+
+        int32_t bins[4];
+        bins_of(_mm_add_ps(_mm_add_ps(_mm_mul_ps(kr, c[0]), _mm_mul_ps(kg, c[1])), _mm_mul_ps(kb, c[2])), bins);
+        ++lane_histogram[0][bins[0]];
+        ++lane_histogram[1][bins[1]];
+        ++lane_histogram[2][bins[2]];
+        ++lane_histogram[3][bins[3]];
+
+        if (scalar.chroma_zero && _mm_movemask_ps(chroma_zero) == 0xF) {
+            bins_of(c[0], bins);
+            for (int i = 0; i < 4; ++i)
+                ++s.red_histogram[bins[i]];
+        }
+
+        vector_pixels += 4;
+        if ((flushed += 4) >= block) {
+            for (int ch = 0; ch < 4; ++ch) {
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, sum[ch]);
+                scalar.sum[ch] += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+                sum[ch] = zero;
+            }
+            flushed = 0;
+        }
+    }
+
+    for (; x < width; ++x) {
+        float v[4];
+        load1(x, v);
+        scalar.add(v[0], v[1], v[2], v[3]);
+    }
+
+    for (int ch = 0; ch < 4; ++ch) {
+        alignas(16) float lo[4], hi[4], total[4];
+        _mm_store_ps(lo, mn[ch]);
+        _mm_store_ps(hi, mx[ch]);
+        _mm_store_ps(total, sum[ch]);
+        for (int i = 0; i < 4; ++i) {
+            scalar.mn[ch] = lo[i] < scalar.mn[ch] ? lo[i] : scalar.mn[ch];
+            scalar.mx[ch] = hi[i] > scalar.mx[ch] ? hi[i] : scalar.mx[ch];
+            scalar.sum[ch] += total[i];
+        }
+        scalar.finite[ch] += vector_pixels;
+    }
+    for (int i = 0; i < LYRA_HISTOGRAM_BINS; ++i)
+        s.histogram[i] += static_cast<unsigned long long>(lane_histogram[0][i]) + lane_histogram[1][i] +
+                          lane_histogram[2][i] + lane_histogram[3][i];
+
+    scalar.opaque = scalar.opaque && _mm_movemask_ps(opaque) == 0xF;
+    scalar.equal = scalar.equal && _mm_movemask_ps(equal) == 0xF;
+    scalar.chroma_zero = scalar.chroma_zero && _mm_movemask_ps(chroma_zero) == 0xF;
+    scalar.finish(width);
+}
+#else
+template <typename Load4, typename Load1>
+void accumulate_row(ImageStatsPartial &s, int width, Load4, Load1 load1) {
+    ScalarRow scalar(s);
+    for (int x = 0; x < width; ++x) {
+        float v[4];
+        load1(x, v);
+        scalar.add(v[0], v[1], v[2], v[3]);
+    }
+    scalar.finish(width);
+}
+#endif
+
+const float *rgbe_scales() {
+    static const auto table = [] {
+        std::array<float, 256> t{};
+        for (int e = 1; e < 256; ++e)
+            t[e] = std::ldexp(1.0f, e - (128 + 8));
+        return t;
+    }();
+    return table.data();
+}
+
+} // namespace
+
+ImageStatsPartial::ImageStatsPartial() {
+    for (int c = 0; c < 4; ++c) {
+        min[c] = std::numeric_limits<float>::infinity();
+        max[c] = -std::numeric_limits<float>::infinity();
+    }
+}
+
+/* Vector loaders are only instantiated with SSE2; the scalar build ignores them. */
+#ifdef LYRA_SSE2
+#define LYRA_LOAD4(body) [&](int x, __m128(&c)[4]) body
+#else
+#define LYRA_LOAD4(body) nullptr
+#endif
+
+void ImageStatsPartial::add_float_row(const float *src, int channels, int width) {
+    if (channels == 4) {
+        accumulate_row(*this, width, LYRA_LOAD4({
+            const float *p = src + static_cast<size_t>(x) * 4;
+            c[0] = _mm_loadu_ps(p);
+            c[1] = _mm_loadu_ps(p + 4);
+            c[2] = _mm_loadu_ps(p + 8);
+            c[3] = _mm_loadu_ps(p + 12);
+            _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+        }), [&](int x, float (&v)[4]) { std::memcpy(v, src + static_cast<size_t>(x) * 4, sizeof(v)); });
+    } else {
+        accumulate_row(*this, width, LYRA_LOAD4({
+            const float *p = src + static_cast<size_t>(x) * 3;
+            c[0] = _mm_setr_ps(p[0], p[3], p[6], p[9]);
+            c[1] = _mm_setr_ps(p[1], p[4], p[7], p[10]);
+            c[2] = _mm_setr_ps(p[2], p[5], p[8], p[11]);
+            c[3] = _mm_set1_ps(1.0f);
+        }), [&](int x, float (&v)[4]) {
+            const float *p = src + static_cast<size_t>(x) * 3;
+            v[0] = p[0];
+            v[1] = p[1];
+            v[2] = p[2];
+            v[3] = 1.0f;
+        });
+    }
+}
+
+void ImageStatsPartial::add_half_row(const uint16_t *src, int width) {
+    accumulate_row(*this, width, LYRA_LOAD4({
+        const uint16_t *p = src + static_cast<size_t>(x) * 4;
+        for (int ch = 0; ch < 4; ++ch)
+            c[ch] = _mm_setr_ps(half_to_float(p[ch]), half_to_float(p[4 + ch]), half_to_float(p[8 + ch]), half_to_float(p[12 + ch]));
+    }), [&](int x, float (&v)[4]) {
+        const uint16_t *p = src + static_cast<size_t>(x) * 4;
+        for (int ch = 0; ch < 4; ++ch)
+            v[ch] = half_to_float(p[ch]);
+    });
+}
+
+void ImageStatsPartial::add_rgbe_row(const uint8_t *planar, int width) {
+    const float *scales = rgbe_scales();
+    const uint8_t *r = planar;
+    const uint8_t *g = planar + width;
+    const uint8_t *b = planar + 2 * static_cast<size_t>(width);
+    const uint8_t *e = planar + 3 * static_cast<size_t>(width);
+
+    accumulate_row(*this, width, LYRA_LOAD4({
+        // Planar mantissas widen straight into one register per channel.
+        auto widen = [](const uint8_t *m) {
+            int32_t packed;
+            std::memcpy(&packed, m, sizeof(packed));
+            __m128i bytes = _mm_cvtsi32_si128(packed);
+            __m128i words = _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, _mm_setzero_si128()));
+        };
+        __m128 f = _mm_setr_ps(scales[e[x]], scales[e[x + 1]], scales[e[x + 2]], scales[e[x + 3]]);
+        c[0] = _mm_mul_ps(widen(r + x), f);
+        c[1] = _mm_mul_ps(widen(g + x), f);
+        c[2] = _mm_mul_ps(widen(b + x), f);
+        c[3] = _mm_set1_ps(1.0f);
+    }), [&](int x, float (&v)[4]) {
+        float f = scales[e[x]];
+        v[0] = r[x] * f;
+        v[1] = g[x] * f;
+        v[2] = b[x] * f;
+        v[3] = 1.0f;
+    });
+}
+
+#undef LYRA_LOAD4
+
+void ImageStatsPartial::add_target_row(const void *row, int format, int width) {
+    switch (format) {
+        case LYRA_PIXEL_RGBA_F32:
+            add_float_row(static_cast<const float *>(row), 4, width);
+            break;
+        case LYRA_PIXEL_RGBA_F16:
+            add_half_row(static_cast<const uint16_t *>(row), width);
+            break;
+        default:
+            break;
+    }
+}
+
+void ImageStatsPartial::merge(const ImageStatsPartial &other) {
+    for (int c = 0; c < 4; ++c) {
+        sum[c] += other.sum[c];
+        min[c] = other.min[c] < min[c] ? other.min[c] : min[c];
+        max[c] = other.max[c] > max[c] ? other.max[c] : max[c];
+        finite[c] += other.finite[c];
+    }
+    for (int i = 0; i < LYRA_HISTOGRAM_BINS; ++i) {
+        histogram[i] += other.histogram[i];
+        red_histogram[i] += other.red_histogram[i];
+    }
+    pixels += other.pixels;
+    nan_count += other.nan_count;
+    inf_count += other.inf_count;
+    alpha_opaque = alpha_opaque && other.alpha_opaque;
+    rgb_equal = rgb_equal && other.rgb_equal;
+    chroma_zero = chroma_zero && other.chroma_zero;
+}
+
+ImageStats::ImageStats(const lyra_decode_control *control)
+    : out_(control ? control->image_stats : nullptr) {}
+
+void ImageStats::merge(const ImageStatsPartial &partial) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_.merge(partial);
+}
+
+void ImageStats::publish(bool single_channel) {
+    if (!out_)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    lyra_image_stats &out = *out_;
+    for (int c = 0; c < 4; ++c) {
+        // Single channel images show R in all three colour channels once replicated.
+        int src = single_channel && (c == 1 || c == 2) ? 0 : c;
+        bool any = total_.finite[src] > 0;
+        out.min[c] = any ? total_.min[src] : 0.0;
+        out.max[c] = any ? total_.max[src] : 0.0;
+        out.mean[c] = any ? total_.sum[src] / static_cast<double>(total_.finite[src]) : 0.0;
+    }
+
+    const unsigned long long *histogram = single_channel ? total_.red_histogram : total_.histogram;
+    for (int i = 0; i < LYRA_HISTOGRAM_BINS; ++i)
+        out.histogram[i] = histogram[i];
+
+    out.pixels = total_.pixels;
+    out.nan_count = total_.nan_count;
+    out.inf_count = total_.inf_count;
+    out.alpha_opaque = total_.alpha_opaque ? 1 : 0;
+    out.rgb_equal = single_channel || total_.rgb_equal ? 1 : 0;
+}
+
+} // namespace lyra
@@ -0,0 +1,101 @@
+#ifndef LYRA_IMAGE_STATS_H
+#define LYRA_IMAGE_STATS_H
+
+#include <cstdint>
+#include <mutex>
+#include "lyra_decode.h"
+
+namespace lyra {
+
+/* Running sums behind lyra_image_stats. Each worker fills its own copy from the rows it
+ * converts, so the hot loop never touches shared state; copies are merged once per chunk. */
+struct ImageStatsPartial {
+    double sum[4] = {};
+    float min[4];
+    float max[4];
+    long long finite[4] = {};
+    unsigned long long histogram[LYRA_HISTOGRAM_BINS] = {};
+    unsigned long long red_histogram[LYRA_HISTOGRAM_BINS] = {}; // luminance of single channel images, stored in R;
+                                                                // kept only while chroma_zero holds
+    long long pixels = 0;
+    long long nan_count = 0;
+    long long inf_count = 0;
+    bool alpha_opaque = true;
+    bool rgb_equal = true;
+    bool chroma_zero = true; // G and B are zero so far
+
+    ImageStatsPartial();
+
+    /* Rows of linear samples as the decoders hold them before conversion: `channels` interleaved
+     * floats (3 = RGB with implied alpha 1), half RGBA, or one planar Radiance scanline. */
+    void add_float_row(const float *src, int channels, int width);
+    void add_half_row(const uint16_t *src, int width);
+    void add_rgbe_row(const uint8_t *planar, int width);
+
+    /* A row already written to an F32/F16 target, for decoders that fill the target directly. */
+    void add_target_row(const void *row, int format, int width);
+
+    void merge(const ImageStatsPartial &other);
+};
+
+/* Collects lyra_image_stats for one decode when the control block asks for them; otherwise
+ * enabled() is false and callers skip the per-row work. Results are written by publish(),
+ * which decoders call only after the whole image converted successfully. */
+class ImageStats {
+public:
+    explicit ImageStats(const lyra_decode_control *control);
+
+    ImageStats(const ImageStats &) = delete;
+    ImageStats &operator=(const ImageStats &) = delete;
+
+    bool enabled() const { return out_ != nullptr; }
+
+    void merge(const ImageStatsPartial &partial);
+
+    /* single_channel: the image was stored as one channel and R gets replicated into G and B. */
+    void publish(bool single_channel);
+
+private:
+    lyra_image_stats *out_;
+    std::mutex mutex_;
+    ImageStatsPartial total_;
+};
+
+/* A worker's partial stats for the rows it converts, merged into `stats` on destruction.
+ * Null or disabled stats: every call returns at once. */
+class ImageStatsRows {
+public:
+    explicit ImageStatsRows(ImageStats *stats) : stats_(stats && stats->enabled() ? stats : nullptr) {}
+    ~ImageStatsRows() {
+        if (stats_)
+            stats_->merge(partial_);
+    }
+
+    ImageStatsRows(const ImageStatsRows &) = delete;
+    ImageStatsRows &operator=(const ImageStatsRows &) = delete;
+
+    void add_float_row(const float *src, int channels, int width) {
+        if (stats_)
+            partial_.add_float_row(src, channels, width);
+    }
+    void add_half_row(const uint16_t *src, int width) {
+        if (stats_)
+            partial_.add_half_row(src, width);
+    }
+    void add_rgbe_row(const uint8_t *planar, int width) {
+        if (stats_)
+            partial_.add_rgbe_row(planar, width);
+    }
+    void add_target_row(const void *row, int format, int width) {
+        if (stats_)
+            partial_.add_target_row(row, format, width);
+    }
+
+private:
+    ImageStats *stats_;
+    ImageStatsPartial partial_;
+};
+
+} // namespace lyra
+
+#endif // LYRA_IMAGE_STATS_H
@@ -0,0 +1,155 @@
+#ifndef LYRA_DECODE_H
+#define LYRA_DECODE_H
+
+/* C ABI types shared by the native decoder wrappers (exr_native, hdr_native, psd_native).
+ * Mirrored on the managed side in Lyra.Imaging/src/Interop/NativeDecode.cs. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Pixel layouts a decoder can write into a caller-owned buffer. */
+typedef enum lyra_pixel_format {
+    LYRA_PIXEL_RGBA8 = 0,    /* 8-bit RGBA, gamma-encoded for display, straight alpha */
+    LYRA_PIXEL_RGBA_F32 = 1, /* 32-bit float RGBA, linear */
+    LYRA_PIXEL_RGBA_F16 = 2, /* IEEE half RGBA, linear; keeps HDR headroom at 8 bytes per pixel */
+    LYRA_PIXEL_RGBE8 = 3,    /* Radiance RGBE at 4 bytes per pixel, each row planar: width R mantissas, then
+                              * G, B and the shared exponents. Written only by full .hdr decodes, to be kept
+                              * and tone-mapped later with tonemap_rgbe_pixels */
+} lyra_pixel_format;
+
+/* Caller-owned destination. The decoder writes width * height pixels in `format`,
+ * rows `stride` bytes apart, and never allocates or frees the buffer itself. */
+typedef struct lyra_decode_target {
+    void *pixels;
+    int width;
+    int height;
+    int stride;
+    int format;
+} lyra_decode_target;
+
+/* Progress callback, invoked from decoder threads with the rows finished so far.
+ * Calls are serialised and rows_done never decreases. */
+typedef void (*lyra_progress_fn)(int rows_done, int rows_total, void *user);
+
+/* Scheduling class of a decode. Foreground decodes (the image on screen) may use every
+ * hardware thread; background ones (preloads) only get spare capacity, a single thread
+ * while any foreground decode is running. */
+typedef enum lyra_decode_priority {
+    LYRA_PRIORITY_FOREGROUND = 0,
+    LYRA_PRIORITY_BACKGROUND = 1,
+} lyra_decode_priority;
+
+/* Per-stage costs of one decode, written when the control block carries a `stats` pointer.
+ * Open, header and total are wall time. Decompress, convert and tonemap are summed over
+ * the threads doing the work; OpenEXR's own pool is counted as wall time of its calls. */
+typedef struct lyra_decode_stats {
+    double total_ms;           /* the whole call */
+    double open_ms;            /* opening/mapping the file; EXR reads its header here */
+    double header_ms;          /* header parse and channel selection */
+    double decompress_ms;      /* codec work: RLE expansion, OpenEXR readPixels */
+    double convert_ms;         /* layout conversion into float targets, preview filtering */
+    double tonemap_ms;         /* conversion into RGBA8 targets, which applies the display curve */
+    long long io_bytes;        /* size of the file read */
+    long long peak_scratch_bytes; /* most decoder-owned scratch memory alive at once */
+    int threads;               /* threads granted by the decode's thread budget */
+} lyra_decode_stats;
+
+/* Luminance histogram layout: bin = (log2(Y) - LYRA_HISTOGRAM_LOG2_MIN) * LYRA_HISTOGRAM_BINS_PER_STOP,
+ * clamped to the first and last bins, so 256 bins cover 2^-16 .. 2^16 in eighth stops. Y <= 0 lands
+ * in bin 0. Y is Rec. 709 luminance of the linear samples. */
+#define LYRA_HISTOGRAM_BINS 256
+#define LYRA_HISTOGRAM_LOG2_MIN (-16)
+#define LYRA_HISTOGRAM_BINS_PER_STOP 8
+
+/* Statistics of the decoded linear samples, gathered while each row is converted and written
+ * when the control block carries an `image_stats` pointer. Only whole-image decodes fill it. */
+typedef struct lyra_image_stats {
+    double min[4];             /* per channel, finite samples only; RGB files report alpha 1 */
+    double max[4];
+    double mean[4];
+    unsigned long long histogram[LYRA_HISTOGRAM_BINS];
+    long long pixels;
+    long long nan_count;       /* samples, not pixels */
+    long long inf_count;
+    int alpha_opaque;          /* every alpha sample is exactly 1 */
+    int rgb_equal;             /* R == G == B for every pixel */
+} lyra_image_stats;
+
+/* Scratch memory kept across decodes: band and scanline buffers are drawn from size-classed
+ * pools instead of the heap, so decoding a run of similar images allocates only once. Created and
+ * destroyed through each wrapper's *_session_* exports and only valid with that wrapper. One
+ * session may serve concurrent decodes; it must outlive every decode given it. */
+typedef struct lyra_decode_session lyra_decode_session;
+
+/* Optional control block passed alongside a target. Decoders poll `cancel` between
+ * scanline batches and give up with "Decode cancelled." once it becomes non-zero;
+ * the target is then left partially written. Pointer fields may be null; a zeroed
+ * block is a foreground decode without limits. */
+typedef struct lyra_decode_control {
+    const volatile int *cancel;
+    lyra_progress_fn progress;
+    void *user;
+    int priority;              /* lyra_decode_priority */
+    int max_threads;           /* upper bound on decode threads, 0 = decided by priority */
+    lyra_decode_stats *stats;  /* filled when the call returns, successful or not */
+    lyra_image_stats *image_stats; /* filled when a whole-image decode succeeds */
+    lyra_decode_session *session;  /* scratch pool to draw from, null = allocate per decode */
+} lyra_decode_control;
+
+/* Layout of a file as read from its header alone, without decoding any pixels. */
+typedef enum lyra_level_mode {
+    LYRA_LEVELS_ONE = 0,    /* single resolution */
+    LYRA_LEVELS_MIPMAP = 1, /* tiled EXR with square mip levels */
+    LYRA_LEVELS_RIPMAP = 2, /* tiled EXR with independent x/y levels */
+} lyra_level_mode;
+
+typedef struct lyra_image_probe {
+    int width;                 /* data window size, the decoded image size */
+    int height;
+    int data_window[4];        /* min x, min y, max x, max y */
+    int display_window[4];
+    int channel_count;
+    int stored_bytes_per_pixel; /* sum of stored sample sizes, a proxy for decode cost */
+    char channels[1024];       /* "name:type" pairs separated by ';', truncated when longer */
+    char compression[32];      /* EXR compression name; "rle" or "flat" for Radiance HDR */
+    int tiled;
+    int tile_width;
+    int tile_height;
+    int level_mode;            /* lyra_level_mode */
+    int level_count;           /* levels along the larger axis; 1 when not multi-resolution */
+    int part_count;
+} lyra_image_probe;
+
+/* One selectable layer of a multi-layer file: an EXR part's default layer or an AOV such as
+ * "diffuse". `channels` holds full channel names in R;G;B;A slot order; empty entries mark
+ * unused slots and trailing ones are dropped, so a single-channel layer is just "depth.Z". */
+typedef struct lyra_image_layer {
+    int part;
+    int width;                 /* data window size of the part */
+    int height;
+    int channel_count;         /* channels in the layer, including any beyond the four shown */
+    char part_name[64];        /* empty when the part is unnamed */
+    char name[128];            /* empty for the part's default layer */
+    char channels[512];
+} lyra_image_layer;
+
+/* Curve applied to linear samples, after exposure and before gamma, when HDR pixels are
+ * re-encoded for display. */
+typedef enum lyra_tone_curve {
+    LYRA_TONE_CLIP = 0,     /* clamp to [0, 1], the curve used at load time */
+    LYRA_TONE_REINHARD = 1, /* x / (1 + x) */
+    LYRA_TONE_ACES = 2,     /* Narkowicz's fit of the ACES filmic curve */
+} lyra_tone_curve;
+
+typedef struct lyra_tone_params {
+    float exposure;            /* stops; samples are scaled by 2^exposure */
+    float gamma;               /* display gamma, colour channels only; <= 0 means 2.2 */
+    int curve;                 /* lyra_tone_curve */
+} lyra_tone_params;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LYRA_DECODE_H */
@@ -0,0 +1,134 @@
+#include "mapped_file.h"
+
+#include <cstdio>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lyra {
+
+namespace {
+
+constexpr size_t read_block_size = 4 << 20;
+
+} // namespace
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const char *path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (view) {
+                CloseHandle(file);
+                mapping_ = view;
+                data_ = static_cast<const unsigned char *>(view);
+                size_ = static_cast<size_t>(file_size.QuadPart);
+                return true;
+            }
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            ::close(fd);
+            // Decoders stream through the file front to back.
+            madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+            mapping_ = view;
+            data_ = static_cast<const unsigned char *>(view);
+            size_ = static_cast<size_t>(st.st_size);
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    return read_blocks(path);
+}
+
+void MappedFile::close() {
+    if (mapping_) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping_);
+#else
+        munmap(mapping_, size_);
+#endif
+        mapping_ = nullptr;
+    }
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::read_blocks(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    try {
+        size_t n;
+        do {
+            size_t used = buffer_.size();
+            buffer_.resize(used + read_block_size);
+            n = fread(buffer_.data() + used, 1, read_block_size, file);
+            buffer_.resize(used + n);
+        } while (n == read_block_size);
+    } catch (const std::bad_alloc &) {
+        fclose(file);
+        buffer_.clear();
+        return false;
+    }
+
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+        buffer_.clear();
+        return false;
+    }
+
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    return true;
+}
+
+long long file_size(const char *path) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes))
+        return -1;
+    return (static_cast<long long>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return -1;
+    return static_cast<long long>(st.st_size);
+#endif
+}
+
+} // namespace lyra
@@ -0,0 +1,40 @@
+#ifndef LYRA_MAPPED_FILE_H
+#define LYRA_MAPPED_FILE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace lyra {
+
+/* Read-only view of a whole file. The file is memory-mapped where possible;
+ * if mapping fails (empty files, special filesystems) it is read in large blocks
+ * into an owned buffer instead, so callers always see one contiguous range. */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const char *path);
+    void close();
+
+    const unsigned char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    bool read_blocks(const char *path);
+
+    const unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+    void *mapping_ = nullptr;
+    std::vector<unsigned char> buffer_;
+};
+
+/* Size of the file at `path` in bytes, -1 when it cannot be read. */
+long long file_size(const char *path);
+
+} // namespace lyra
+
+#endif // LYRA_MAPPED_FILE_H
@@ -0,0 +1,316 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace lyra {
+
+unsigned hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+struct BudgetState {
+    bool background;
+    int limit;      // max_threads, else every hardware thread
+    int active = 0; // threads working for this budget right now, loop callers included
+    int tasks = 0;  // submitted tasks not yet finished, queued or running; they point at this state
+};
+
+struct TaskGroupState {
+    int pending = 0; // tasks submitted through the group and not yet finished
+};
+
+namespace {
+
+// Parallel loops hand out chunk indices; submitted tasks run once. Both stay owned by whoever
+// queued them: a loop by its calling thread, which waits for its helpers, a task by the pool.
+struct Work {
+    BudgetState *budget;
+
+    const std::function<void(int, int)> *fn = nullptr;
+    int rows = 0;
+    int chunks = 0;
+    int next = 0;    // next chunk to claim
+    int running = 0; // pool workers inside a chunk
+    bool queued = false;
+    std::exception_ptr error;
+
+    void (*task)(void *) = nullptr;
+    void *arg = nullptr;
+    TaskGroupState *group = nullptr;
+
+    void run_chunk(int chunk) const {
+        int begin = static_cast<int>(static_cast<long long>(rows) * chunk / chunks);
+        int end = static_cast<int>(static_cast<long long>(rows) * (chunk + 1) / chunks);
+        (*fn)(begin, end);
+    }
+};
+
+thread_local BudgetState *current_budget = nullptr;
+
+// Process-wide workers, one per hardware thread. Workers serve queued foreground work before
+// background work and only join work whose budget has room; a budget's room is recomputed on
+// every pick, so the split follows foreground decodes starting and ending.
+class WorkerPool {
+public:
+    static WorkerPool &instance() {
+        // Never destroyed: workers may still be parked when the runtime is unloaded at exit.
+        static WorkerPool *pool = new WorkerPool();
+        return *pool;
+    }
+
+    int grant(const BudgetState &budget) const {
+        if (!budget.background)
+            return budget.limit;
+        // Neighbours only take what the image on screen leaves over.
+        int share = foreground_ > 0 ? 1 : std::max(1, hw_ / 2);
+        return std::min(budget.limit, share);
+    }
+
+    int begin_budget(BudgetState &budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!budget.background)
+            ++foreground_;
+        return grant(budget);
+    }
+
+    // Returns once no worker is inside work of this budget and none of its tasks is still queued, so the
+    // state can be freed.
+    void end_budget(BudgetState &budget) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [&] { return budget.active == 0 && budget.tasks == 0; });
+            if (!budget.background)
+                --foreground_;
+        }
+        // Background work held back by this decode may widen again.
+        if (!budget.background)
+            work_cv_.notify_all();
+    }
+
+    int current_grant(const BudgetState &budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return grant(budget);
+    }
+
+    void run_loop(Work &work) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++work.budget->active;
+        work.queued = true;
+        queue_.push_back(&work);
+        lock.unlock();
+        work_cv_.notify_all();
+
+        for (;;) {
+            lock.lock();
+            int chunk = claim_chunk(work);
+            lock.unlock();
+            if (chunk < 0)
+                break;
+            run_guarded(work, chunk);
+        }
+
+        lock.lock();
+        done_cv_.wait(lock, [&] { return work.running == 0; });
+        --work.budget->active;
+        lock.unlock();
+        work_cv_.notify_one();
+
+        if (work.error)
+            std::rethrow_exception(work.error);
+    }
+
+    void submit(Work *task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task->queued = true;
+            queue_.push_back(task);
+            ++task->budget->tasks;
+            ++task->group->pending;
+        }
+        work_cv_.notify_one();
+    }
+
+    void finish(TaskGroupState &group) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&] { return group.pending == 0; });
+    }
+
+private:
+    WorkerPool() : hw_(static_cast<int>(hardware_threads())) {
+        for (int i = 0; i < hw_; ++i)
+            std::thread([this] { worker(); }).detach();
+    }
+
+    // Next chunk of a loop, or -1 once all are claimed. Called with the mutex held.
+    int claim_chunk(Work &work) {
+        if (work.next >= work.chunks)
+            return -1;
+        int chunk = work.next++;
+        if (work.next == work.chunks)
+            dequeue(work);
+        return chunk;
+    }
+
+    void dequeue(Work &work) {
+        if (!work.queued)
+            return;
+        work.queued = false;
+        queue_.erase(std::find(queue_.begin(), queue_.end(), &work));
+    }
+
+    void run_guarded(Work &work, int chunk) {
+        try {
+            work.run_chunk(chunk);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!work.error)
+                work.error = std::current_exception();
+            work.next = work.chunks;
+            dequeue(work);
+        }
+    }
+
+    // A worker left work of `budget`; wakes loop callers, TaskGroup::finish and end_budget. Called with the mutex held.
+    void release(BudgetState &budget) {
+        --budget.active;
+        done_cv_.notify_all();
+    }
+
+    // First queued work whose budget has room, foreground before background. Called with the mutex held.
+    Work *pick() const {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (Work *work : queue_) {
+                if (work->budget->background != (pass == 1))
+                    continue;
+                if (work->budget->active < grant(*work->budget))
+                    return work;
+            }
+        }
+        return nullptr;
+    }
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            Work *work = pick();
+            if (!work) {
+                work_cv_.wait(lock);
+                continue;
+            }
+
+            BudgetState *budget = work->budget;
+            ++budget->active;
+            if (work->fn) {
+                int chunk = claim_chunk(*work);
+                ++work->running;
+                lock.unlock();
+
+                current_budget = budget;
+                run_guarded(*work, chunk);
+                current_budget = nullptr;
+
+                lock.lock();
+                --work->running;
+                release(*budget);
+            } else {
+                dequeue(*work);
+                lock.unlock();
+
+                current_budget = budget;
+                work->task(work->arg);
+                current_budget = nullptr;
+
+                lock.lock();
+                --work->group->pending;
+                --budget->tasks;
+                delete work;
+                release(*budget);
+            }
+        }
+    }
+
+    const int hw_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Work *> queue_;
+    int foreground_ = 0;
+};
+
+// Budget of parallel work started outside any decode, e.g. re-tone-mapping retained pixels.
+BudgetState *unbudgeted() {
+    static BudgetState state{false, static_cast<int>(hardware_threads())};
+    return &state;
+}
+
+} // namespace
+
+ThreadBudget::ThreadBudget(const lyra_decode_control *control)
+    : state_(new BudgetState{control && control->priority == LYRA_PRIORITY_BACKGROUND, static_cast<int>(hardware_threads())}),
+      previous_(current_budget) {
+    if (control && control->max_threads > 0)
+        state_->limit = std::min(state_->limit, control->max_threads);
+
+    threads_ = WorkerPool::instance().begin_budget(*state_);
+    current_budget = state_;
+}
+
+ThreadBudget::~ThreadBudget() {
+    current_budget = previous_;
+    WorkerPool::instance().end_budget(*state_);
+    delete state_;
+}
+
+int budget_threads() {
+    BudgetState *budget = current_budget ? current_budget : unbudgeted();
+    return WorkerPool::instance().current_grant(*budget);
+}
+
+void parallel_for_rows(int rows, int min_rows, const std::function<void(int, int)> &fn) {
+    if (rows <= 0)
+        return;
+
+    min_rows = std::max(min_rows, 1);
+    int max_chunks = (rows + min_rows - 1) / min_rows;
+    if (max_chunks <= 1 || hardware_threads() == 1) {
+        fn(0, rows);
+        return;
+    }
+
+    // A few chunks per granted thread, so workers return to the pool often enough for the
+    // split between foreground and background to change mid-loop.
+    Work work;
+    work.budget = current_budget ? current_budget : unbudgeted();
+    work.fn = &fn;
+    work.rows = rows;
+    work.chunks = std::min(max_chunks, 4 * budget_threads());
+    WorkerPool::instance().run_loop(work);
+}
+
+TaskGroup::TaskGroup() : state_(new TaskGroupState()) {}
+
+TaskGroup::~TaskGroup() {
+    finish();
+    delete state_;
+}
+
+void TaskGroup::submit(void (*fn)(void *), void *arg) {
+    auto *work = new Work();
+    work->budget = current_budget ? current_budget : unbudgeted();
+    work->task = fn;
+    work->arg = arg;
+    work->group = state_;
+    WorkerPool::instance().submit(work);
+}
+
+void TaskGroup::finish() {
+    WorkerPool::instance().finish(*state_);
+}
+
+} // namespace lyra
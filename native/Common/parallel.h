@@ -0,0 +1,87 @@
+#ifndef LYRA_PARALLEL_H
+#define LYRA_PARALLEL_H
+
+#include <functional>
+#include "lyra_decode.h"
+
+/* The worker pool and thread budget live in the shared lyra_native_runtime library, so every
+ * wrapper loaded into the process schedules on the same threads. */
+#if defined(_WIN32)
+#ifdef LYRA_RUNTIME_BUILD
+#define LYRA_RUNTIME_API __declspec(dllexport)
+#else
+#define LYRA_RUNTIME_API __declspec(dllimport)
+#endif
+#else
+#define LYRA_RUNTIME_API __attribute__((visibility("default")))
+#endif
+
+namespace lyra {
+
+struct BudgetState;
+
+/* Number of hardware threads, never less than 1. */
+LYRA_RUNTIME_API unsigned hardware_threads();
+
+/* One decode's claim on the process-wide worker pool, according to the priority and
+ * max_threads of its control block (null = foreground). While alive, parallel work started on
+ * the constructing thread is scheduled under this budget. Foreground work may use every
+ * hardware thread and is served first. Background work gets half the threads while the
+ * machine is idle and a single thread while any foreground budget is alive; the share is
+ * re-evaluated between chunks, so a foreground decode starting takes workers back from
+ * background decodes already running. Scopes nest. */
+class LYRA_RUNTIME_API ThreadBudget {
+public:
+    explicit ThreadBudget(const lyra_decode_control *control);
+    ~ThreadBudget();
+
+    ThreadBudget(const ThreadBudget &) = delete;
+    ThreadBudget &operator=(const ThreadBudget &) = delete;
+
+    /* Threads granted when the budget was created; reported in lyra_decode_stats. */
+    int threads() const { return threads_; }
+
+private:
+    BudgetState *state_;
+    BudgetState *previous_;
+    int threads_;
+};
+
+/* Threads the innermost ThreadBudget on this thread is granted right now, else every hardware thread. */
+LYRA_RUNTIME_API int budget_threads();
+
+/* Splits [0, rows) into contiguous chunks of at least min_rows rows and runs
+ * fn(row_begin, row_end) for each chunk on the shared pool, never on more threads at once
+ * than the calling thread's budget grants. The calling thread works through chunks itself,
+ * so the loop progresses even when the pool gives it no helpers. The first exception thrown
+ * by any chunk skips the chunks not yet started and is rethrown on the calling thread once
+ * the running ones finished. */
+LYRA_RUNTIME_API void parallel_for_rows(int rows, int min_rows, const std::function<void(int, int)> &fn);
+
+struct TaskGroupState;
+
+/* Tasks queued on the shared pool by one submitter, for libraries with their own task model
+ * (OpenEXR's IlmThread). Each task runs under the budget of the thread that submitted it, and
+ * that budget is not released while the task is still queued. A task must not wait for another
+ * queued task. Destroying the group waits for its tasks. */
+class LYRA_RUNTIME_API TaskGroup {
+public:
+    TaskGroup();
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    /* Queues fn(arg) under the calling thread's budget and returns at once. */
+    void submit(void (*fn)(void *), void *arg);
+
+    /* Blocks until every task submitted through this group has run; other groups' tasks are not waited for. */
+    void finish();
+
+private:
+    TaskGroupState *state_;
+};
+
+} // namespace lyra
+
+#endif // LYRA_PARALLEL_H
@@ -0,0 +1,855 @@
+#include "pixel_kernels.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include "cpu_dispatch.h"
+#include "parallel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LYRA_SSE2 1
+#endif
+
+/* AVX2 and AVX-512 variants are compiled alongside the baseline code and only called once
+ * cpu_isa() has confirmed the CPU runs them. MSVC accepts the intrinsics without flags. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LYRA_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#define LYRA_TARGET_AVX2
+#define LYRA_TARGET_AVX512
+#else
+#define LYRA_TARGET_AVX2 __attribute__((target("avx2,f16c,fma")))
+#define LYRA_TARGET_AVX512 __attribute__((target("avx512f,avx2,f16c,fma")))
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define LYRA_NEON 1
+#endif
+
+namespace lyra {
+
+namespace {
+
+/* Floats are mapped to the tone curve through their bit pattern: the top 10 mantissa bits
+ * of every exponent in [2^-20, 1) select a LUT entry. Anything below 2^-20 encodes to 0,
+ * anything at or above 1 encodes to 255, so 20 exponents cover the whole 8-bit output. */
+constexpr uint32_t float_lut_min_bits = (127u - 20u) << 23;
+constexpr uint32_t float_lut_max_bits = (127u << 23) - 1u;
+constexpr int float_lut_shift = 13;
+constexpr int float_lut_size = static_cast<int>((float_lut_max_bits - float_lut_min_bits) >> float_lut_shift) + 1;
+
+/* Pixels converted per block in float_to_rgba8_row; indices for a block live on the stack. */
+constexpr int block_pixels = 256;
+
+float bits_to_float(uint32_t bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint32_t float_to_bits(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+uint8_t encode_gamma(float v) {
+    if (!(v > 0.0f))
+        return 0; // also catches NaN
+    if (v >= 1.0f)
+        return 255;
+    return static_cast<uint8_t>(std::pow(v, 1.0f / display_gamma) * 255.0f + 0.5f);
+}
+
+uint8_t encode_linear(float v) {
+    if (!(v > 0.0f))
+        return 0;
+    if (v >= 1.0f)
+        return 255;
+    return static_cast<uint8_t>(v * 255.0f + 0.5f);
+}
+
+struct ToneTables {
+    uint8_t float_color[float_lut_size];
+    uint8_t half_color[65536];
+    uint8_t half_alpha[65536];
+
+    ToneTables() {
+        for (int i = 0; i < float_lut_size; ++i) {
+            // Sample the middle of the bucket so truncated indices round symmetrically.
+            uint32_t bits = float_lut_min_bits + (static_cast<uint32_t>(i) << float_lut_shift) + (1u << (float_lut_shift - 1));
+            float_color[i] = encode_gamma(bits_to_float(bits));
+        }
+
+        for (uint32_t h = 0; h < 65536; ++h) {
+            float v = half_to_float(static_cast<uint16_t>(h));
+            half_color[h] = encode_gamma(v);
+            half_alpha[h] = encode_linear(v);
+        }
+    }
+};
+
+const ToneTables &tables() {
+    static const ToneTables instance;
+    return instance;
+}
+
+/* Variants of the vectorised kernels for the tier cpu_isa() picked. Table-driven kernels
+ * (tone mapping, half to RGBA8) are lookups either way and stay common to every tier. */
+struct KernelTable {
+    void (*float_lut_indices)(const float *src, uint16_t *idx, int n);
+    void (*floats_to_halves)(const float *src, uint16_t *dst, size_t n);
+    void (*halves_to_floats)(const uint16_t *src, float *dst, size_t n);
+    void (*rgbe_to_rgba)(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *e, float *dst, int n);
+};
+
+const KernelTable &kernels();
+
+/* Maps src[i, n) to float_color indices. Negative values and NaN clamp to the bottom entry.
+ * The vector variants below handle whole blocks and finish here. */
+void float_lut_indices_from(const float *src, uint16_t *idx, int i, int n) {
+    for (; i < n; ++i) {
+        uint32_t bits = float_to_bits(src[i]);
+        if (!(src[i] > bits_to_float(float_lut_min_bits)))
+            bits = float_lut_min_bits;
+        else if (bits > float_lut_max_bits)
+            bits = float_lut_max_bits;
+        idx[i] = static_cast<uint16_t>((bits - float_lut_min_bits) >> float_lut_shift);
+    }
+}
+
+void float_lut_indices_scalar(const float *src, uint16_t *idx, int n) {
+    float_lut_indices_from(src, idx, 0, n);
+}
+
+#ifdef LYRA_SSE2
+void float_lut_indices_sse2(const float *src, uint16_t *idx, int n) {
+    int i = 0;
+    const __m128 lo = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(float_lut_min_bits)));
+    const __m128 hi = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(float_lut_max_bits)));
+    const __m128i base = _mm_set1_epi32(static_cast<int>(float_lut_min_bits));
+    for (; i + 8 <= n; i += 8) {
+        // _mm_max_ps returns its second operand when the first is NaN.
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi);
+        __m128i ia = _mm_srli_epi32(_mm_sub_epi32(_mm_castps_si128(a), base), float_lut_shift);
+        __m128i ib = _mm_srli_epi32(_mm_sub_epi32(_mm_castps_si128(b), base), float_lut_shift);
+        // Indices fit in 15 bits, so the signed pack is lossless.
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(idx + i), _mm_packs_epi32(ia, ib));
+    }
+    float_lut_indices_from(src, idx, i, n);
+}
+#endif
+
+#ifdef LYRA_X86
+LYRA_TARGET_AVX2 void float_lut_indices_avx2(const float *src, uint16_t *idx, int n) {
+    int i = 0;
+    const __m256 lo = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(float_lut_min_bits)));
+    const __m256 hi = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(float_lut_max_bits)));
+    const __m256i base = _mm256_set1_epi32(static_cast<int>(float_lut_min_bits));
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i), lo), hi);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i + 8), lo), hi);
+        __m256i ia = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_castps_si256(a), base), float_lut_shift);
+        __m256i ib = _mm256_srli_epi32(_mm256_sub_epi32(_mm256_castps_si256(b), base), float_lut_shift);
+        // The pack works per 128-bit lane; restore element order across lanes.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(idx + i), packed);
+    }
+    float_lut_indices_from(src, idx, i, n);
+}
+
+LYRA_TARGET_AVX512 void float_lut_indices_avx512(const float *src, uint16_t *idx, int n) {
+    int i = 0;
+    const __m512 lo = _mm512_castsi512_ps(_mm512_set1_epi32(static_cast<int>(float_lut_min_bits)));
+    const __m512 hi = _mm512_castsi512_ps(_mm512_set1_epi32(static_cast<int>(float_lut_max_bits)));
+    const __m512i base = _mm512_set1_epi32(static_cast<int>(float_lut_min_bits));
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(src + i), lo), hi);
+        __m512i ia = _mm512_srli_epi32(_mm512_sub_epi32(_mm512_castps_si512(a), base), float_lut_shift);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(idx + i), _mm512_cvtepi32_epi16(ia));
+    }
+    float_lut_indices_from(src, idx, i, n);
+}
+#endif
+
+bool float_to_rgba8_row(const float *src, int channels, uint8_t *dst, int width, bool check_gray) {
+    const ToneTables &t = tables();
+    uint16_t idx[block_pixels * 4];
+    uint32_t chroma_bits = 0;
+
+    for (int x0 = 0; x0 < width; x0 += block_pixels) {
+        int n = width - x0 < block_pixels ? width - x0 : block_pixels;
+        const float *s = src + static_cast<size_t>(x0) * channels;
+        uint8_t *d = dst + static_cast<size_t>(x0) * 4;
+
+        kernels().float_lut_indices(s, idx, n * channels);
+
+        if (channels == 4) {
+            for (int x = 0; x < n; ++x) {
+                d[x * 4 + 0] = t.float_color[idx[x * 4 + 0]];
+                d[x * 4 + 1] = t.float_color[idx[x * 4 + 1]];
+                d[x * 4 + 2] = t.float_color[idx[x * 4 + 2]];
+                d[x * 4 + 3] = encode_linear(s[x * 4 + 3]);
+            }
+        } else {
+            for (int x = 0; x < n; ++x) {
+                d[x * 4 + 0] = t.float_color[idx[x * 3 + 0]];
+                d[x * 4 + 1] = t.float_color[idx[x * 3 + 1]];
+                d[x * 4 + 2] = t.float_color[idx[x * 3 + 2]];
+                d[x * 4 + 3] = 255;
+            }
+        }
+
+        if (check_gray) {
+            for (int x = 0; x < n; ++x)
+                chroma_bits |= float_to_bits(s[x * channels + 1]) | float_to_bits(s[x * channels + 2]);
+            check_gray = (chroma_bits & 0x7FFFFFFFu) == 0;
+        }
+    }
+
+    return check_gray;
+}
+
+bool half_rgba_to_rgba8_row(const uint16_t *src, uint8_t *dst, int width, bool check_gray) {
+    const ToneTables &t = tables();
+    uint32_t chroma_bits = 0;
+
+    for (int x = 0; x < width; ++x) {
+        const uint16_t *s = src + static_cast<size_t>(x) * 4;
+        uint8_t *d = dst + static_cast<size_t>(x) * 4;
+        d[0] = t.half_color[s[0]];
+        d[1] = t.half_color[s[1]];
+        d[2] = t.half_color[s[2]];
+        d[3] = t.half_alpha[s[3]];
+        chroma_bits |= s[1] | s[2];
+    }
+
+    return check_gray && (chroma_bits & 0x7FFFu) == 0;
+}
+
+bool float_to_f32_row(const float *src, int channels, float *dst, int width, bool check_gray) {
+    uint32_t chroma_bits = 0;
+
+    for (int x = 0; x < width; ++x) {
+        const float *s = src + static_cast<size_t>(x) * channels;
+        float *d = dst + static_cast<size_t>(x) * 4;
+        d[0] = s[0];
+        d[1] = s[1];
+        d[2] = s[2];
+        d[3] = channels == 4 ? s[3] : 1.0f;
+        chroma_bits |= float_to_bits(s[1]) | float_to_bits(s[2]);
+    }
+
+    return check_gray && (chroma_bits & 0x7FFFFFFFu) == 0;
+}
+
+bool half_rgba_to_f32_row(const uint16_t *src, float *dst, int width, bool check_gray) {
+    uint32_t chroma_bits = 0;
+
+    kernels().halves_to_floats(src, dst, static_cast<size_t>(width) * 4);
+
+    for (int x = 0; x < width; ++x)
+        chroma_bits |= src[x * 4 + 1] | src[x * 4 + 2];
+
+    return check_gray && (chroma_bits & 0x7FFFu) == 0;
+}
+
+uint16_t float_to_half_scalar(float f) {
+    // Round-to-nearest-even; NaN stays a quiet NaN, overflow becomes Inf.
+    constexpr uint32_t f32_infinity = 255u << 23;
+    constexpr uint32_t f16_max = (127u + 16u) << 23;
+    constexpr uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t bits = float_to_bits(f);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t out;
+    if (bits >= f16_max) {
+        out = bits > f32_infinity ? 0x7E00 : 0x7C00;
+    } else if (bits < (113u << 23)) {
+        // Half subnormal or zero: let the FPU align the mantissa, then drop the bias.
+        out = static_cast<uint16_t>(float_to_bits(bits_to_float(bits) + bits_to_float(denorm_magic)) - denorm_magic);
+    } else {
+        uint32_t mant_odd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xFFFu + mant_odd;
+        out = static_cast<uint16_t>(bits >> 13);
+    }
+
+    return static_cast<uint16_t>(out | (sign >> 16));
+}
+
+/* Float to IEEE half with round-to-nearest-even, n values. SSE2 has no conversion instruction,
+ * so that tier uses the scalar loop. */
+void floats_to_halves_scalar(const float *src, uint16_t *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = float_to_half_scalar(src[i]);
+}
+
+#ifdef LYRA_X86
+LYRA_TARGET_AVX2 void floats_to_halves_avx2(const float *src, uint16_t *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(src + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; i < n; ++i)
+        dst[i] = float_to_half_scalar(src[i]);
+}
+
+LYRA_TARGET_AVX512 void floats_to_halves_avx512(const float *src, uint16_t *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(src + i);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    floats_to_halves_avx2(src + i, dst + i, n - i);
+}
+#endif
+
+#ifdef LYRA_NEON
+void floats_to_halves_neon(const float *src, uint16_t *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    for (; i < n; ++i)
+        dst[i] = float_to_half_scalar(src[i]);
+}
+#endif
+
+/* Half to float, n values; exact in every variant. The hardware conversions return signalling
+ * NaNs quietened, the others keep the payload bit for bit. */
+void halves_to_floats_scalar(const uint16_t *src, float *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = half_to_float(src[i]);
+}
+
+#ifdef LYRA_SSE2
+/* half_to_float four lanes at a time, with the special cases selected by mask. */
+void halves_to_floats_sse2(const uint16_t *src, float *dst, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i magnitude = _mm_set1_epi32(0x7FFF);
+    const __m128i shifted_exp = _mm_set1_epi32(0x7C00 << 13);
+    const __m128i rebias = _mm_set1_epi32((127 - 15) << 23);
+    const __m128i inf_nan_rebias = _mm_set1_epi32((128 - 16) << 23);
+    const __m128i denorm_bias = _mm_set1_epi32(1 << 23);
+    const __m128 denorm_magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i h = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)), zero);
+        __m128i bits = _mm_slli_epi32(_mm_and_si128(h, magnitude), 13);
+        __m128i exp = _mm_and_si128(bits, shifted_exp);
+        bits = _mm_add_epi32(bits, rebias);
+
+        __m128i inf_nan = _mm_cmpeq_epi32(exp, shifted_exp);
+        bits = _mm_add_epi32(bits, _mm_and_si128(inf_nan, inf_nan_rebias));
+
+        __m128i denorm = _mm_cmpeq_epi32(exp, zero);
+        __m128 fixed = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(bits, denorm_bias)), denorm_magic);
+        bits = _mm_or_si128(_mm_andnot_si128(denorm, bits), _mm_and_si128(denorm, _mm_castps_si128(fixed)));
+
+        __m128i sign = _mm_slli_epi32(_mm_andnot_si128(magnitude, h), 16);
+        _mm_storeu_ps(dst + i, _mm_castsi128_ps(_mm_or_si128(bits, sign)));
+    }
+    halves_to_floats_scalar(src + i, dst + i, n - i);
+}
+#endif
+
+#ifdef LYRA_X86
+LYRA_TARGET_AVX2 void halves_to_floats_avx2(const uint16_t *src, float *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+    halves_to_floats_scalar(src + i, dst + i, n - i);
+}
+
+LYRA_TARGET_AVX512 void halves_to_floats_avx512(const uint16_t *src, float *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i))));
+    halves_to_floats_avx2(src + i, dst + i, n - i);
+}
+#endif
+
+#ifdef LYRA_NEON
+void halves_to_floats_neon(const uint16_t *src, float *dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    halves_to_floats_scalar(src + i, dst + i, n - i);
+}
+#endif
+
+bool float_to_f16_row(const float *src, int channels, uint16_t *dst, int width, bool check_gray) {
+    uint32_t chroma_bits = 0;
+
+    if (channels == 4) {
+        kernels().floats_to_halves(src, dst, static_cast<size_t>(width) * 4);
+    } else {
+        // Expand RGB to RGBA a block at a time so the conversion itself stays vectorised.
+        float rgba[block_pixels * 4];
+        for (int x0 = 0; x0 < width; x0 += block_pixels) {
+            int n = width - x0 < block_pixels ? width - x0 : block_pixels;
+            const float *s = src + static_cast<size_t>(x0) * 3;
+            for (int x = 0; x < n; ++x) {
+                rgba[x * 4 + 0] = s[x * 3 + 0];
+                rgba[x * 4 + 1] = s[x * 3 + 1];
+                rgba[x * 4 + 2] = s[x * 3 + 2];
+                rgba[x * 4 + 3] = 1.0f;
+            }
+            kernels().floats_to_halves(rgba, dst + static_cast<size_t>(x0) * 4, static_cast<size_t>(n) * 4);
+        }
+    }
+
+    if (check_gray) {
+        for (int x = 0; x < width; ++x)
+            chroma_bits |= float_to_bits(src[x * channels + 1]) | float_to_bits(src[x * channels + 2]);
+    }
+
+    return check_gray && (chroma_bits & 0x7FFFFFFFu) == 0;
+}
+
+bool half_rgba_to_f16_row(const uint16_t *src, uint16_t *dst, int width, bool check_gray) {
+    uint32_t chroma_bits = 0;
+
+    std::memcpy(dst, src, static_cast<size_t>(width) * 8);
+
+    for (int x = 0; x < width; ++x)
+        chroma_bits |= src[x * 4 + 1] | src[x * 4 + 2];
+
+    return check_gray && (chroma_bits & 0x7FFFu) == 0;
+}
+
+// Radiance shared-exponent scales: mantissa * 2^(e - 136), with e == 0 meaning black.
+const float *rgbe_scales() {
+    static const auto table = [] {
+        std::array<float, 256> t{};
+        for (int e = 1; e < 256; ++e)
+            t[e] = std::ldexp(1.0f, e - (128 + 8));
+        return t;
+    }();
+    return table.data();
+}
+
+/* Expands n pixels of a planar RGBE scanline into float RGBA with alpha 1. */
+void rgbe_to_rgba_scalar(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *e, float *dst, int n) {
+    const float *scales = rgbe_scales();
+    for (int i = 0; i < n; ++i) {
+        float f = scales[e[i]];
+        dst[i * 4 + 0] = r[i] * f;
+        dst[i * 4 + 1] = g[i] * f;
+        dst[i * 4 + 2] = b[i] * f;
+        dst[i * 4 + 3] = 1.0f;
+    }
+}
+
+/* The vector variants build 2^(e - 136) from exponent bits instead of the table, as two factors
+ * 2^(e/2 - 68) and 2^(e - e/2 - 68) that stay normal floats over the whole range. The first
+ * product is exact, so the result rounds once, exactly like the scalar multiply. */
+#ifdef LYRA_SSE2
+/* Four bytes zero-extended to 32-bit lanes. */
+inline __m128i widen4_sse2(const uint8_t *p) {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+}
+
+void rgbe_to_rgba_sse2(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *e, float *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(127 - 68);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i ei = widen4_sse2(e + i);
+        __m128i half = _mm_srli_epi32(ei, 1);
+        __m128i black = _mm_cmpeq_epi32(ei, zero);
+        __m128 s0 = _mm_castsi128_ps(_mm_andnot_si128(black, _mm_slli_epi32(_mm_add_epi32(half, bias), 23)));
+        __m128 s1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(ei, half), bias), 23));
+
+        __m128 rf = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(widen4_sse2(r + i)), s0), s1);
+        __m128 gf = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(widen4_sse2(g + i)), s0), s1);
+        __m128 bf = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(widen4_sse2(b + i)), s0), s1);
+        __m128 af = one;
+        _MM_TRANSPOSE4_PS(rf, gf, bf, af);
+        _mm_storeu_ps(dst + i * 4, rf);
+        _mm_storeu_ps(dst + i * 4 + 4, gf);
+        _mm_storeu_ps(dst + i * 4 + 8, bf);
+        _mm_storeu_ps(dst + i * 4 + 12, af);
+    }
+    rgbe_to_rgba_scalar(r + i, g + i, b + i, e + i, dst + i * 4, n - i);
+}
+#endif
+
+#ifdef LYRA_X86
+/* Interleaves eight pixels of planar R, G, B and A into dst. */
+LYRA_TARGET_AVX2 inline void store_rgba8x_avx2(__m256 r, __m256 g, __m256 b, __m256 a, float *dst) {
+    __m256 rg_lo = _mm256_unpacklo_ps(r, g); // r0 g0 r1 g1 | r4 g4 r5 g5
+    __m256 rg_hi = _mm256_unpackhi_ps(r, g);
+    __m256 ba_lo = _mm256_unpacklo_ps(b, a);
+    __m256 ba_hi = _mm256_unpackhi_ps(b, a);
+    __m256 p04 = _mm256_shuffle_ps(rg_lo, ba_lo, 0x44);
+    __m256 p15 = _mm256_shuffle_ps(rg_lo, ba_lo, 0xEE);
+    __m256 p26 = _mm256_shuffle_ps(rg_hi, ba_hi, 0x44);
+    __m256 p37 = _mm256_shuffle_ps(rg_hi, ba_hi, 0xEE);
+    _mm256_storeu_ps(dst, _mm256_permute2f128_ps(p04, p15, 0x20));
+    _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(p26, p37, 0x20));
+    _mm256_storeu_ps(dst + 16, _mm256_permute2f128_ps(p04, p15, 0x31));
+    _mm256_storeu_ps(dst + 24, _mm256_permute2f128_ps(p26, p37, 0x31));
+}
+
+LYRA_TARGET_AVX2 inline __m256i widen8_avx2(const uint8_t *p) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)));
+}
+
+LYRA_TARGET_AVX2 void rgbe_to_rgba_avx2(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *e, float *dst, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi32(127 - 68);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i ei = widen8_avx2(e + i);
+        __m256i half = _mm256_srli_epi32(ei, 1);
+        __m256i black = _mm256_cmpeq_epi32(ei, zero);
+        __m256 s0 = _mm256_castsi256_ps(_mm256_andnot_si256(black, _mm256_slli_epi32(_mm256_add_epi32(half, bias), 23)));
+        __m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_sub_epi32(ei, half), bias), 23));
+
+        __m256 rf = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(widen8_avx2(r + i)), s0), s1);
+        __m256 gf = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(widen8_avx2(g + i)), s0), s1);
+        __m256 bf = _mm256_mul_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(widen8_avx2(b + i)), s0), s1);
+        store_rgba8x_avx2(rf, gf, bf, one, dst + i * 4);
+    }
+    rgbe_to_rgba_scalar(r + i, g + i, b + i, e + i, dst + i * 4, n - i);
+}
+
+LYRA_TARGET_AVX512 inline __m512i widen16_avx512(const uint8_t *p) {
+    return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+}
+
+LYRA_TARGET_AVX512 inline __m256 upper_avx512(__m512 v) {
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1));
+}
+
+LYRA_TARGET_AVX512 void rgbe_to_rgba_avx512(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *e, float *dst, int n) {
+    const __m512i bias = _mm512_set1_epi32(127 - 68);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i ei = widen16_avx512(e + i);
+        __m512i half = _mm512_srli_epi32(ei, 1);
+        __mmask16 lit = _mm512_test_epi32_mask(ei, ei);
+        __m512 s0 = _mm512_castsi512_ps(_mm512_maskz_slli_epi32(lit, _mm512_add_epi32(half, bias), 23));
+        __m512 s1 = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_sub_epi32(ei, half), bias), 23));
+
+        __m512 rf = _mm512_mul_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(widen16_avx512(r + i)), s0), s1);
+        __m512 gf = _mm512_mul_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(widen16_avx512(g + i)), s0), s1);
+        __m512 bf = _mm512_mul_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(widen16_avx512(b + i)), s0), s1);
+        store_rgba8x_avx2(_mm512_castps512_ps256(rf), _mm512_castps512_ps256(gf), _mm512_castps512_ps256(bf), one, dst + i * 4);
+        store_rgba8x_avx2(upper_avx512(rf), upper_avx512(gf), upper_avx512(bf), one, dst + i * 4 + 32);
+    }
+    rgbe_to_rgba_avx2(r + i, g + i, b + i, e + i, dst + i * 4, n - i);
+}
+#endif
+
+KernelTable select_kernels(CpuIsa isa) {
+    KernelTable k{float_lut_indices_scalar, floats_to_halves_scalar, halves_to_floats_scalar, rgbe_to_rgba_scalar};
+    switch (isa) {
+#ifdef LYRA_X86
+        case CpuIsa::avx512:
+            k = {float_lut_indices_avx512, floats_to_halves_avx512, halves_to_floats_avx512, rgbe_to_rgba_avx512};
+            break;
+        case CpuIsa::avx2:
+            k = {float_lut_indices_avx2, floats_to_halves_avx2, halves_to_floats_avx2, rgbe_to_rgba_avx2};
+            break;
+#endif
+#ifdef LYRA_SSE2
+        case CpuIsa::sse2:
+            k = {float_lut_indices_sse2, floats_to_halves_scalar, halves_to_floats_sse2, rgbe_to_rgba_sse2};
+            break;
+#endif
+#ifdef LYRA_NEON
+        case CpuIsa::neon:
+            k.floats_to_halves = floats_to_halves_neon;
+            k.halves_to_floats = halves_to_floats_neon;
+            break;
+#endif
+        default:
+            break;
+    }
+    return k;
+}
+
+const KernelTable &kernels() {
+    static const KernelTable table = select_kernels(cpu_isa());
+    return table;
+}
+
+} // namespace
+
+float half_to_float(uint16_t h) {
+    // Shift exponent and mantissa into place and rebias; denormals are fixed up with
+    // one float subtraction, Inf/NaN by widening the exponent.
+    constexpr uint32_t shifted_exp = 0x7C00u << 13;
+    uint32_t bits = (h & 0x7FFFu) << 13;
+    uint32_t exp = bits & shifted_exp;
+    bits += (127u - 15u) << 23;
+
+    if (exp == shifted_exp) {
+        bits += (128u - 16u) << 23;
+    } else if (exp == 0) {
+        bits += 1u << 23;
+        bits = float_to_bits(bits_to_float(bits) - bits_to_float(113u << 23));
+    }
+
+    return bits_to_float(bits | (static_cast<uint32_t>(h & 0x8000u) << 16));
+}
+
+int bytes_per_pixel(int format) {
+    switch (format) {
+        case LYRA_PIXEL_RGBA8:
+        case LYRA_PIXEL_RGBE8:
+            return 4;
+        case LYRA_PIXEL_RGBA_F32:
+            return 16;
+        case LYRA_PIXEL_RGBA_F16:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+bool is_valid_target(const lyra_decode_target *target) {
+    if (!target || !target->pixels || target->width <= 0 || target->height <= 0)
+        return false;
+
+    int bpp = bytes_per_pixel(target->format);
+    return bpp > 0 && static_cast<int64_t>(target->stride) >= static_cast<int64_t>(target->width) * bpp;
+}
+
+bool float_to_row(const float *src, int channels, void *dst, int format, int width, bool check_gray) {
+    switch (format) {
+        case LYRA_PIXEL_RGBA8:
+            return float_to_rgba8_row(src, channels, static_cast<uint8_t *>(dst), width, check_gray);
+        case LYRA_PIXEL_RGBA_F32:
+            return float_to_f32_row(src, channels, static_cast<float *>(dst), width, check_gray);
+        case LYRA_PIXEL_RGBA_F16:
+            return float_to_f16_row(src, channels, static_cast<uint16_t *>(dst), width, check_gray);
+        default:
+            return false;
+    }
+}
+
+bool rgbe_to_row(const uint8_t *src, void *dst, int format, int width, bool check_gray) {
+    const KernelTable &k = kernels();
+    auto *out = static_cast<uint8_t *>(dst);
+    size_t px = bytes_per_pixel(format);
+    const uint8_t *r = src;
+    const uint8_t *g = src + width;
+    const uint8_t *b = src + 2 * static_cast<size_t>(width);
+    const uint8_t *e = src + 3 * static_cast<size_t>(width);
+
+    if (format == LYRA_PIXEL_RGBE8) {
+        std::memcpy(out, src, 4 * static_cast<size_t>(width));
+        if (!check_gray)
+            return false;
+        uint8_t chroma = 0;
+        for (int x = 0; x < width; ++x)
+            chroma |= g[x] | b[x];
+        return chroma == 0;
+    }
+
+    // Float RGBA is the expanded layout itself, so it is written in place.
+    if (format == LYRA_PIXEL_RGBA_F32) {
+        k.rgbe_to_rgba(r, g, b, e, reinterpret_cast<float *>(out), width);
+        return check_gray && is_gray_row(out, format, width);
+    }
+
+    bool gray = check_gray;
+    float rgba[block_pixels * 4];
+    for (int x0 = 0; x0 < width; x0 += block_pixels) {
+        int n = width - x0 < block_pixels ? width - x0 : block_pixels;
+        k.rgbe_to_rgba(r + x0, g + x0, b + x0, e + x0, rgba, n);
+        if (!float_to_row(rgba, 4, out + x0 * px, format, n, gray))
+            gray = false;
+    }
+    return gray;
+}
+
+bool half_rgba_to_row(const uint16_t *src, void *dst, int format, int width, bool check_gray) {
+    switch (format) {
+        case LYRA_PIXEL_RGBA8:
+            return half_rgba_to_rgba8_row(src, static_cast<uint8_t *>(dst), width, check_gray);
+        case LYRA_PIXEL_RGBA_F32:
+            return half_rgba_to_f32_row(src, static_cast<float *>(dst), width, check_gray);
+        case LYRA_PIXEL_RGBA_F16:
+            return half_rgba_to_f16_row(src, static_cast<uint16_t *>(dst), width, check_gray);
+        default:
+            return false;
+    }
+}
+
+uint16_t float_to_half(float f) {
+    return float_to_half_scalar(f);
+}
+
+void halves_to_floats(const uint16_t *src, float *dst, size_t n) {
+    kernels().halves_to_floats(src, dst, n);
+}
+
+void float_lut_indices(const float *src, uint16_t *idx, int n) {
+    kernels().float_lut_indices(src, idx, n);
+}
+
+namespace {
+
+float apply_tone_curve(float v, int curve) {
+    switch (curve) {
+        case LYRA_TONE_REINHARD:
+            return std::isinf(v) ? 1.0f : v / (1.0f + v);
+        case LYRA_TONE_ACES:
+            return std::isinf(v) ? 1.0f : v * (2.51f * v + 0.03f) / (v * (2.43f * v + 0.59f) + 0.14f);
+        default:
+            return v;
+    }
+}
+
+} // namespace
+
+void build_tone_table(const lyra_tone_params &params, ToneTable &table) {
+    const float scale = std::exp2(params.exposure);
+    const float inv_gamma = 1.0f / (params.gamma > 0.0f ? params.gamma : display_gamma);
+
+    parallel_for_rows(65536, 4096, [&](int h0, int h1) {
+        for (int h = h0; h < h1; ++h) {
+            float v = apply_tone_curve(half_to_float(static_cast<uint16_t>(h)) * scale, params.curve);
+            if (!(v > 0.0f))
+                table.color[h] = 0; // also catches NaN
+            else if (v >= 1.0f)
+                table.color[h] = 255;
+            else
+                table.color[h] = static_cast<uint8_t>(std::pow(v, inv_gamma) * 255.0f + 0.5f);
+        }
+    });
+}
+
+std::shared_ptr<const ToneTable> tone_table(const lyra_tone_params &params) {
+    constexpr size_t kept = 8;
+    struct Entry {
+        lyra_tone_params params;
+        std::shared_ptr<const ToneTable> table;
+    };
+    static std::mutex mutex;
+    static std::list<Entry> recent; // most recently used first
+
+    lyra_tone_params key = params;
+    if (!(key.gamma > 0.0f))
+        key.gamma = display_gamma;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = recent.begin(); it != recent.end(); ++it) {
+        if (it->params.exposure == key.exposure && it->params.gamma == key.gamma && it->params.curve == key.curve) {
+            recent.splice(recent.begin(), recent, it);
+            return it->table;
+        }
+    }
+
+    // Built under the lock: concurrent requests are nearly always for the same settings.
+    auto table = std::make_shared<ToneTable>();
+    build_tone_table(key, *table);
+    recent.push_front({key, table});
+    if (recent.size() > kept)
+        recent.pop_back();
+    return table;
+}
+
+void tonemap_half_row(const uint16_t *src, uint8_t *dst, int width, const ToneTable &table) {
+    const ToneTables &t = tables();
+    for (int x = 0; x < width; ++x) {
+        dst[x * 4 + 0] = table.color[src[x * 4 + 0]];
+        dst[x * 4 + 1] = table.color[src[x * 4 + 1]];
+        dst[x * 4 + 2] = table.color[src[x * 4 + 2]];
+        dst[x * 4 + 3] = t.half_alpha[src[x * 4 + 3]];
+    }
+}
+
+void tonemap_rgbe_row(const uint8_t *src, size_t plane_stride, uint8_t *dst, int width, const ToneTable &table) {
+    const KernelTable &k = kernels();
+    const uint8_t *r = src;
+    const uint8_t *g = src + plane_stride;
+    const uint8_t *b = src + 2 * plane_stride;
+    const uint8_t *e = src + 3 * plane_stride;
+
+    float rgba[block_pixels * 4];
+    uint16_t halves[block_pixels * 4];
+    for (int x0 = 0; x0 < width; x0 += block_pixels) {
+        int n = width - x0 < block_pixels ? width - x0 : block_pixels;
+        k.rgbe_to_rgba(r + x0, g + x0, b + x0, e + x0, rgba, n);
+        k.floats_to_halves(rgba, halves, static_cast<size_t>(n) * 4);
+        tonemap_half_row(halves, dst + static_cast<size_t>(x0) * 4, n, table);
+    }
+}
+
+bool is_gray_row(const void *row, int format, int width) {
+    uint32_t chroma_bits = 0;
+
+    switch (format) {
+        case LYRA_PIXEL_RGBA_F32: {
+            const auto *p = static_cast<const float *>(row);
+            for (int x = 0; x < width; ++x)
+                chroma_bits |= float_to_bits(p[x * 4 + 1]) | float_to_bits(p[x * 4 + 2]);
+            return (chroma_bits & 0x7FFFFFFFu) == 0;
+        }
+        case LYRA_PIXEL_RGBA_F16: {
+            const auto *p = static_cast<const uint16_t *>(row);
+            for (int x = 0; x < width; ++x)
+                chroma_bits |= p[x * 4 + 1] | p[x * 4 + 2];
+            return (chroma_bits & 0x7FFFu) == 0;
+        }
+        default:
+            return false;
+    }
+}
+
+void replicate_red_row(void *row, int format, int width) {
+    switch (format) {
+        case LYRA_PIXEL_RGBA8: {
+            auto *p = static_cast<uint8_t *>(row);
+            for (int x = 0; x < width; ++x)
+                p[x * 4 + 1] = p[x * 4 + 2] = p[x * 4];
+            break;
+        }
+        case LYRA_PIXEL_RGBA_F32: {
+            auto *p = static_cast<float *>(row);
+            for (int x = 0; x < width; ++x)
+                p[x * 4 + 1] = p[x * 4 + 2] = p[x * 4];
+            break;
+        }
+        case LYRA_PIXEL_RGBA_F16: {
+            auto *p = static_cast<uint16_t *>(row);
+            for (int x = 0; x < width; ++x)
+                p[x * 4 + 1] = p[x * 4 + 2] = p[x * 4];
+            break;
+        }
+        case LYRA_PIXEL_RGBE8: {
+            auto *p = static_cast<uint8_t *>(row);
+            std::memcpy(p + width, p, static_cast<size_t>(width));
+            std::memcpy(p + 2 * static_cast<size_t>(width), p, static_cast<size_t>(width));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+} // namespace lyra
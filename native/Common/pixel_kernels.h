@@ -0,0 +1,74 @@
+#ifndef LYRA_PIXEL_KERNELS_H
+#define LYRA_PIXEL_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "lyra_decode.h"
+
+namespace lyra {
+
+/* Display curve applied when linear EXR/HDR samples are encoded to 8 bits.
+ * Colour channels get 1/2.2 gamma; alpha is stored linearly. */
+constexpr float display_gamma = 2.2f;
+
+float half_to_float(uint16_t h);
+uint16_t float_to_half(float f);
+
+/* half_to_float over n values, vectorised for the CPU. */
+void halves_to_floats(const uint16_t *src, float *dst, size_t n);
+
+/* Tone-curve LUT entries float_to_row encodes n RGBA8 colour samples with: the top 10 mantissa
+ * bits of each exponent in [2^-20, 1), clamped at both ends. Exposed for kernel_test. */
+void float_lut_indices(const float *src, uint16_t *idx, int n);
+
+/* Bytes per pixel of a lyra_pixel_format, 0 for unknown formats. */
+int bytes_per_pixel(int format);
+
+/* True when the target has pixels, positive dimensions, a known format and a stride
+ * wide enough for one row. */
+bool is_valid_target(const lyra_decode_target *target);
+
+/* Row kernels converting linear samples into a lyra_pixel_format row.
+ * src holds width pixels of `channels` interleaved samples (3 = RGB with implied
+ * alpha 1, 4 = RGBA). When check_gray is set the return value reports whether
+ * G and B are zero for every pixel of the row, otherwise it is false. */
+bool float_to_row(const float *src, int channels, void *dst, int format, int width, bool check_gray);
+bool half_rgba_to_row(const uint16_t *src, void *dst, int format, int width, bool check_gray);
+
+/* Same contract for one Radiance scanline in planar form: width R mantissas, then G, B
+ * and the shared exponents, as produced by RGBE_DecodeScanline. An RGBE8 target gets the
+ * scanline unchanged. */
+bool rgbe_to_row(const uint8_t *src, void *dst, int format, int width, bool check_gray);
+
+/* 65536-entry table mapping every half value to its 8-bit display code under `params`.
+ * Built once per re-tonemap so the per-pixel cost stays four lookups whatever the curve. */
+struct ToneTable {
+    uint8_t color[65536];
+};
+
+/* Fills the table, spread over the calling thread's budget. */
+void build_tone_table(const lyra_tone_params &params, ToneTable &table);
+
+/* Table for `params`, shared by every caller asking for the same settings. The most recent
+ * few are kept, so stepping exposure back and forth does not rebuild them. */
+std::shared_ptr<const ToneTable> tone_table(const lyra_tone_params &params);
+
+/* Re-encodes one row of linear half RGBA into RGBA8: colour through `table`, alpha linearly. */
+void tonemap_half_row(const uint16_t *src, uint8_t *dst, int width, const ToneTable &table);
+
+/* The same for one planar RGBE row: expanded and narrowed to half a block at a time, so it
+ * encodes exactly as the half-float copy of the image would. Alpha is 255. The G, B and exponent
+ * planes start plane_stride bytes apart, which lets a span of a wider row be tone-mapped. */
+void tonemap_rgbe_row(const uint8_t *src, size_t plane_stride, uint8_t *dst, int width, const ToneTable &table);
+
+/* True when G and B are zero for every pixel of a float (F32/F16) RGBA row. Used where
+ * samples land in the destination without passing through a row kernel. */
+bool is_gray_row(const void *row, int format, int width);
+
+/* Copies R into G and B, used once an image turned out to carry a single channel. */
+void replicate_red_row(void *row, int format, int width);
+
+} // namespace lyra
+
+#endif // LYRA_PIXEL_KERNELS_H
@@ -0,0 +1,62 @@
+#include "preview.h"
+
+#include <algorithm>
+#include "pixel_kernels.h"
+
+namespace lyra {
+
+int preview_factor(int width, int height, int max_width, int max_height) {
+    int factor = 1;
+    if (max_width > 0)
+        factor = std::max(factor, (width + max_width - 1) / max_width);
+    if (max_height > 0)
+        factor = std::max(factor, (height + max_height - 1) / max_height);
+    return factor;
+}
+
+void preview_size(int width, int height, int factor, int *preview_width, int *preview_height) {
+    *preview_width = (width + factor - 1) / factor;
+    *preview_height = (height + factor - 1) / factor;
+}
+
+PreviewRowFilter::PreviewRowFilter(int src_width, int factor)
+    : src_width_(src_width), factor_(factor), out_width_((src_width + factor - 1) / factor),
+      sums_(static_cast<size_t>(out_width_) * 4, 0.0f), row_(static_cast<size_t>(out_width_) * 4) {}
+
+void PreviewRowFilter::add_row(const float *src, int channels) {
+    for (int ox = 0; ox < out_width_; ++ox) {
+        int x0 = ox * factor_;
+        int x1 = std::min(x0 + factor_, src_width_);
+        float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+
+        for (int x = x0; x < x1; ++x) {
+            const float *p = src + static_cast<size_t>(x) * channels;
+            r += p[0];
+            g += p[1];
+            b += p[2];
+            a += channels == 4 ? p[3] : 1.0f;
+        }
+
+        float *sum = &sums_[static_cast<size_t>(ox) * 4];
+        sum[0] += r;
+        sum[1] += g;
+        sum[2] += b;
+        sum[3] += a;
+    }
+    ++rows_;
+}
+
+bool PreviewRowFilter::emit(void *dst, int format, bool check_gray) {
+    for (int ox = 0; ox < out_width_; ++ox) {
+        int cols = std::min(factor_, src_width_ - ox * factor_);
+        float scale = rows_ > 0 ? 1.0f / static_cast<float>(cols * rows_) : 0.0f;
+        for (int c = 0; c < 4; ++c)
+            row_[static_cast<size_t>(ox) * 4 + c] = sums_[static_cast<size_t>(ox) * 4 + c] * scale;
+    }
+
+    std::fill(sums_.begin(), sums_.end(), 0.0f);
+    rows_ = 0;
+    return float_to_row(row_.data(), 4, dst, format, out_width_, check_gray);
+}
+
+} // namespace lyra
@@ -0,0 +1,40 @@
+#ifndef LYRA_PREVIEW_H
+#define LYRA_PREVIEW_H
+
+#include <cstdint>
+#include <vector>
+
+namespace lyra {
+
+/* Integer box-filter factor that fits width x height inside max_width x max_height.
+ * 1 means no reduction; a non-positive limit leaves that axis unconstrained. */
+int preview_factor(int width, int height, int max_width, int max_height);
+
+/* Preview dimensions for a factor. Partial boxes along the right and bottom edges are kept. */
+void preview_size(int width, int height, int factor, int *preview_width, int *preview_height);
+
+/* Averages `factor` x `factor` boxes of linear RGBA float rows into one preview row.
+ * Rows are added one at a time as they stream in; emit() converts the accumulated
+ * box row into the target format and starts the next one. */
+class PreviewRowFilter {
+public:
+    PreviewRowFilter(int src_width, int factor);
+
+    /* Adds one source row of src_width pixels with `channels` interleaved samples (3 or 4). */
+    void add_row(const float *src, int channels);
+
+    /* Writes the averaged row (same gray contract as float_to_row) and resets the accumulator. */
+    bool emit(void *dst, int format, bool check_gray);
+
+private:
+    int src_width_;
+    int factor_;
+    int out_width_;
+    int rows_ = 0;
+    std::vector<float> sums_;
+    std::vector<float> row_;
+};
+
+} // namespace lyra
+
+#endif // LYRA_PREVIEW_H
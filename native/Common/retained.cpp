@@ -0,0 +1,123 @@
+#include "retained.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <vector>
+#include "pixel_kernels.h"
+#include "preview.h"
+
+#ifdef __clang__
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL thread_local
+#endif
+
+static THREAD_LOCAL char last_runtime_error[512] = "";
+
+// Tone-maps the region of a retained half RGBA or RGBE source at (x, y), the target's size, into the RGBA8 target.
+static bool tonemap_retained(const lyra_decode_target *source, int source_format, int x, int y, const lyra_decode_target *target,
+                             const lyra_tone_params *params) {
+    if (!lyra::is_valid_target(source) || !lyra::is_valid_target(target) || !params ||
+        source->format != source_format || target->format != LYRA_PIXEL_RGBA8 ||
+        x < 0 || y < 0 || target->width > source->width - x || target->height > source->height - y) {
+        snprintf(last_runtime_error, sizeof(last_runtime_error), "Invalid tone mapping source or destination buffer.");
+        return false;
+    }
+
+    try {
+        auto table = lyra::tone_table(*params);
+
+        const auto *src = static_cast<const uint8_t *>(source->pixels) + (size_t) y * source->stride;
+        auto *dst = static_cast<uint8_t *>(target->pixels);
+        lyra::parallel_for_rows(target->height, 64, [&](int y0, int y1) {
+            for (int ty = y0; ty < y1; ++ty) {
+                const uint8_t *src_row = src + (size_t) ty * source->stride;
+                uint8_t *dst_row = dst + (size_t) ty * target->stride;
+                if (source_format == LYRA_PIXEL_RGBE8)
+                    lyra::tonemap_rgbe_row(src_row + x, (size_t) source->width, dst_row, target->width, *table);
+                else
+                    lyra::tonemap_half_row(reinterpret_cast<const uint16_t *>(src_row) + (size_t) x * 4, dst_row, target->width, *table);
+            }
+        });
+    } catch (const std::exception &ex) {
+        snprintf(last_runtime_error, sizeof(last_runtime_error), "Tone mapping failed: %s", ex.what());
+        return false;
+    }
+
+    last_runtime_error[0] = '\0';
+    return true;
+}
+
+// Box-filters retained half RGBA or RGBE pixels into a smaller linear half RGBA target. The factor is the one
+// that fits the source into the target's size, and the target must be exactly the preview size it gives.
+static bool downsample_retained(const lyra_decode_target *source, const lyra_decode_target *target) {
+    bool valid = lyra::is_valid_target(source) && lyra::is_valid_target(target) && target->format == LYRA_PIXEL_RGBA_F16 &&
+                 (source->format == LYRA_PIXEL_RGBA_F16 || source->format == LYRA_PIXEL_RGBE8);
+    int factor = valid ? lyra::preview_factor(source->width, source->height, target->width, target->height) : 0;
+    int pw = 0, ph = 0;
+    if (valid)
+        lyra::preview_size(source->width, source->height, factor, &pw, &ph);
+    if (!valid || pw != target->width || ph != target->height) {
+        snprintf(last_runtime_error, sizeof(last_runtime_error), "Invalid downsampling source or destination buffer.");
+        return false;
+    }
+
+    try {
+        const int w = source->width;
+        const int h = source->height;
+        const auto *src = static_cast<const uint8_t *>(source->pixels);
+        auto *dst = static_cast<uint8_t *>(target->pixels);
+        lyra::parallel_for_rows(ph, 4, [&](int py0, int py1) {
+            std::vector<float> rgba(static_cast<size_t>(w) * 4);
+            lyra::PreviewRowFilter filter(w, factor);
+            for (int py = py0; py < py1; ++py) {
+                int y1 = std::min((py + 1) * factor, h);
+                for (int y = py * factor; y < y1; ++y) {
+                    const uint8_t *row = src + (size_t) y * source->stride;
+                    if (source->format == LYRA_PIXEL_RGBE8)
+                        lyra::rgbe_to_row(row, rgba.data(), LYRA_PIXEL_RGBA_F32, w, false);
+                    else
+                        lyra::halves_to_floats(reinterpret_cast<const uint16_t *>(row), rgba.data(), rgba.size());
+                    filter.add_row(rgba.data(), 4);
+                }
+                filter.emit(dst + (size_t) py * target->stride, LYRA_PIXEL_RGBA_F16, false);
+            }
+        });
+    } catch (const std::exception &ex) {
+        snprintf(last_runtime_error, sizeof(last_runtime_error), "Downsampling failed: %s", ex.what());
+        return false;
+    }
+
+    last_runtime_error[0] = '\0';
+    return true;
+}
+
+extern "C" {
+
+LYRA_RUNTIME_API const char *get_last_runtime_error() {
+    return last_runtime_error;
+}
+
+LYRA_RUNTIME_API bool tonemap_half_pixels(const lyra_decode_target *source, const lyra_decode_target *target, const lyra_tone_params *params) {
+    return tonemap_retained(source, LYRA_PIXEL_RGBA_F16, 0, 0, target, params);
+}
+
+LYRA_RUNTIME_API bool tonemap_rgbe_pixels(const lyra_decode_target *source, const lyra_decode_target *target, const lyra_tone_params *params) {
+    return tonemap_retained(source, LYRA_PIXEL_RGBE8, 0, 0, target, params);
+}
+
+LYRA_RUNTIME_API bool tonemap_half_region(const lyra_decode_target *source, int x, int y, const lyra_decode_target *target,
+                                          const lyra_tone_params *params) {
+    return tonemap_retained(source, LYRA_PIXEL_RGBA_F16, x, y, target, params);
+}
+
+LYRA_RUNTIME_API bool tonemap_rgbe_region(const lyra_decode_target *source, int x, int y, const lyra_decode_target *target,
+                                          const lyra_tone_params *params) {
+    return tonemap_retained(source, LYRA_PIXEL_RGBE8, x, y, target, params);
+}
+
+LYRA_RUNTIME_API bool downsample_retained_pixels(const lyra_decode_target *source, const lyra_decode_target *target) {
+    return downsample_retained(source, target);
+}
+}
@@ -0,0 +1,34 @@
+#ifndef LYRA_RETAINED_H
+#define LYRA_RETAINED_H
+
+#include "lyra_decode.h"
+#include "parallel.h" // LYRA_RUNTIME_API
+
+/* Re-encoding of linear pixels kept after a decode, for any format: exported by lyra_native_runtime so showing a
+ * retained image needs no particular decoder wrapper. Mirrored in Lyra.Imaging/src/Interop/NativeRuntime.cs. */
+
+extern "C" {
+
+/* Message of the last failed call on this thread; empty after a successful one. */
+LYRA_RUNTIME_API const char *get_last_runtime_error(void);
+
+/* Re-encodes retained linear half RGBA into a display RGBA8 target with new exposure/curve/gamma,
+ * so HDR images can be re-tonemapped without decoding the file again. */
+LYRA_RUNTIME_API bool tonemap_half_pixels(const lyra_decode_target *source, const lyra_decode_target *target, const lyra_tone_params *params);
+
+/* The same for pixels retained in their RGBE form (LYRA_PIXEL_RGBE8), at half the memory of half RGBA. */
+LYRA_RUNTIME_API bool tonemap_rgbe_pixels(const lyra_decode_target *source, const lyra_decode_target *target, const lyra_tone_params *params);
+
+/* Tone-maps only the target-sized region at (x, y) of the retained pixels, for images shown as tiles. */
+LYRA_RUNTIME_API bool tonemap_half_region(const lyra_decode_target *source, int x, int y, const lyra_decode_target *target,
+                                          const lyra_tone_params *params);
+LYRA_RUNTIME_API bool tonemap_rgbe_region(const lyra_decode_target *source, int x, int y, const lyra_decode_target *target,
+                                          const lyra_tone_params *params);
+
+/* Box-filtered half RGBA copy of retained pixels (half RGBA or RGBE), the retained preview of a large image.
+ * The target must have the size preview_factor/preview_size give for it. */
+LYRA_RUNTIME_API bool downsample_retained_pixels(const lyra_decode_target *source, const lyra_decode_target *target);
+
+} // extern "C"
+
+#endif // LYRA_RETAINED_H
@@ -0,0 +1,122 @@
+#include "scratch_pool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace lyra {
+
+namespace {
+
+constexpr size_t min_class_bytes = 4096;
+constexpr std::align_val_t block_alignment{64};
+
+void *allocate_block(size_t capacity) { return ::operator new(capacity, block_alignment); }
+
+void free_block(void *data) { ::operator delete(data, block_alignment); }
+
+} // namespace
+
+ScratchPool::~ScratchPool() {
+    for (const Block &block : idle_)
+        free_block(block.data);
+}
+
+size_t ScratchPool::size_class(size_t bytes) {
+    if (bytes <= min_class_bytes)
+        return min_class_bytes;
+
+    // Quarter steps of the power of two below: 4096 -> 5120, 6144, 7168, 8192 -> 10240, ...
+    size_t top = min_class_bytes;
+    while (bytes - top > top)
+        top <<= 1;
+    size_t step = top >> 2;
+    return (bytes + step - 1) / step * step;
+}
+
+void *ScratchPool::acquire(size_t bytes, size_t *capacity) {
+    size_t size = size_class(bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Newest first: the block most likely still resident.
+        for (auto it = idle_.rbegin(); it != idle_.rend(); ++it) {
+            if (it->capacity == size) {
+                void *data = it->data;
+                idle_bytes_ -= size;
+                idle_.erase(std::next(it).base());
+                *capacity = size;
+                return data;
+            }
+        }
+    }
+
+    *capacity = size;
+    return allocate_block(size);
+}
+
+void ScratchPool::release(void *block, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity > retain_bytes_) {
+        free_block(block);
+        return;
+    }
+
+    evict_to(retain_bytes_ - capacity);
+    idle_.push_back({block, capacity, generation_});
+    idle_bytes_ += capacity;
+}
+
+size_t ScratchPool::trim(size_t retain_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t before = idle_bytes_;
+    size_t freed = 0;
+    auto stale = std::stable_partition(idle_.begin(), idle_.end(), [&](const Block &block) { return block.generation == generation_; });
+    for (auto it = stale; it != idle_.end(); ++it) {
+        free_block(it->data);
+        freed += it->capacity;
+    }
+    idle_.erase(stale, idle_.end());
+    idle_bytes_ -= freed;
+    ++generation_;
+
+    retain_bytes_ = retain_bytes;
+    evict_to(retain_bytes_);
+    return before - idle_bytes_;
+}
+
+size_t ScratchPool::idle_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_bytes_;
+}
+
+void ScratchPool::evict_to(size_t limit) {
+    size_t count = 0;
+    while (idle_bytes_ > limit && count < idle_.size()) {
+        free_block(idle_[count].data);
+        idle_bytes_ -= idle_[count].capacity;
+        ++count;
+    }
+    idle_.erase(idle_.begin(), idle_.begin() + static_cast<ptrdiff_t>(count));
+}
+
+ScratchBuffer::ScratchBuffer(ScratchPool *pool, size_t bytes, DecodeStats *stats)
+    : pool_(pool), data_(nullptr), size_(bytes), counted_(stats, bytes) {
+    if (bytes == 0)
+        return;
+
+    if (pool_)
+        data_ = pool_->acquire(bytes, &capacity_);
+    else
+        data_ = allocate_block(capacity_ = bytes);
+}
+
+ScratchBuffer::~ScratchBuffer() {
+    if (!data_)
+        return;
+
+    if (pool_)
+        pool_->release(data_, capacity_);
+    else
+        free_block(data_);
+}
+
+} // namespace lyra
@@ -0,0 +1,86 @@
+#ifndef LYRA_SCRATCH_POOL_H
+#define LYRA_SCRATCH_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "decode_control.h"
+#include "lyra_decode.h"
+
+namespace lyra {
+
+/* Idle scratch blocks kept for reuse. Requests are rounded up to a size class, four per power of
+ * two, so a block fits every request within a quarter of its size and images of similar width
+ * share blocks. Released blocks stay pooled while the idle total is within the retention cap;
+ * beyond it the least recently released are freed. Safe to use from any thread. */
+class ScratchPool {
+public:
+    explicit ScratchPool(size_t retain_bytes) : retain_bytes_(retain_bytes) {}
+    ~ScratchPool();
+
+    ScratchPool(const ScratchPool &) = delete;
+    ScratchPool &operator=(const ScratchPool &) = delete;
+
+    /* A block of at least `bytes`, uninitialised; its real size is stored in `capacity`. */
+    void *acquire(size_t bytes, size_t *capacity);
+    void release(void *block, size_t capacity);
+
+    /* Frees the idle blocks not reused since the previous trim, so memory held for a kind of image
+     * the user has moved away from goes after one quiet interval, then adopts `retain_bytes` as the
+     * cap and evicts down to it. Returns the bytes freed. */
+    size_t trim(size_t retain_bytes);
+
+    size_t idle_bytes() const;
+
+    static size_t size_class(size_t bytes);
+
+private:
+    struct Block {
+        void *data;
+        size_t capacity;
+        unsigned generation; /* trim interval it was last released in */
+    };
+
+    void evict_to(size_t limit);
+
+    mutable std::mutex mutex_;
+    std::vector<Block> idle_; /* oldest release first */
+    size_t retain_bytes_;
+    size_t idle_bytes_ = 0;
+    unsigned generation_ = 0;
+};
+
+/* Scratch buffer for one scope, drawn from a pool when the decode has a session and from the
+ * heap otherwise. Contents are uninitialised. Counts towards peak_scratch_bytes like ScratchBytes. */
+class ScratchBuffer {
+public:
+    ScratchBuffer(ScratchPool *pool, size_t bytes, DecodeStats *stats);
+    ~ScratchBuffer();
+
+    ScratchBuffer(const ScratchBuffer &) = delete;
+    ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+
+    void *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    template <typename T>
+    T *as() const { return static_cast<T *>(data_); }
+
+private:
+    ScratchPool *pool_;
+    void *data_;
+    size_t size_;
+    size_t capacity_ = 0;
+    ScratchBytes counted_;
+};
+
+} // namespace lyra
+
+/* The handle behind lyra_decode_session. */
+struct lyra_decode_session {
+    lyra::ScratchPool pool;
+
+    explicit lyra_decode_session(size_t retain_bytes) : pool(retain_bytes) {}
+};
+
+#endif // LYRA_SCRATCH_POOL_H
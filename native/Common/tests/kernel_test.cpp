@@ -0,0 +1,216 @@
+/* Tests of the vectorised pixel kernels at the tier LYRA_NATIVE_ISA selects. ctest runs this once
+ * per tier (kernel_test_scalar, kernel_test_sse2, ...); a tier the build or CPU lacks is skipped.
+ * Every tier must match the scalar code bit for bit:
+ *
+ *   lut     float_lut_indices against the documented bucket of each float
+ *   half    float to half against float_to_half, half to float against half_to_float
+ *   rgbe    planar RGBE to float RGBA against mantissa * 2^(e - 136), black at e == 0
+ *
+ * Inputs cover the special values of each conversion and, with lengths 1 to 40 from an unaligned
+ * start, every tail the vector loops leave to their scalar remainders. */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "cpu_dispatch.h"
+#include "pixel_kernels.h"
+#include "tests/test_check.h"
+
+namespace {
+
+constexpr int max_tail = 40;
+
+float bits_to_float(uint32_t bits) {
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint32_t float_to_bits(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+bool is_half_nan(uint16_t h) {
+    return (h & 0x7C00u) == 0x7C00u && (h & 0x03FFu) != 0;
+}
+
+/* Special values of every kernel below, then random bit patterns and random values in [0, 2). */
+std::vector<float> test_floats() {
+    std::vector<float> v = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 2.0f, std::nextafter(1.0f, 0.0f),
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::signaling_NaN(), bits_to_float(0x7FC02000u), bits_to_float(0x7F800001u),
+        std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::min(), std::numeric_limits<float>::max(),
+        // Half range: largest finite, the overflow tie, subnormals and their ties.
+        65504.0f, 65519.996f, 65520.0f, 65536.0f, std::ldexp(1.0f, -14), std::nextafter(std::ldexp(1.0f, -14), 0.0f),
+        std::ldexp(1.0f, -24), std::ldexp(1.0f, -25), std::nextafter(std::ldexp(1.0f, -25), 1.0f), std::ldexp(3.0f, -25),
+        1.0f + std::ldexp(1.0f, -11), 1.0f + std::ldexp(3.0f, -11), 1024.0f + 0.5f, 1024.0f + 1.5f,
+    };
+
+    // LUT range ends and bucket edges: 2^-20, and each exponent's first, middle and last bucket.
+    for (int exp = -21; exp <= 0; ++exp) {
+        uint32_t base = static_cast<uint32_t>(127 + exp) << 23;
+        for (uint32_t mant : {0u, 1u, 0x1FFFu, 0x2000u, 0x2001u, 0x3FFFFFu, 0x400000u, 0x7FDFFFu, 0x7FE000u, 0x7FFFFFu}) {
+            v.push_back(bits_to_float(base | mant));
+            v.push_back(-bits_to_float(base | mant));
+        }
+    }
+
+    uint32_t state = 0x2545F491u;
+    for (int i = 0; i < 100000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        v.push_back(bits_to_float(state));
+        state = state * 1664525u + 1013904223u;
+        v.push_back(static_cast<float>(state >> 8) / 8388608.0f);
+    }
+    return v;
+}
+
+/* The LUT bucket of a float: 2^-20 and below (and NaN) take the first, 1 and above the last. */
+uint16_t reference_lut_index(float f) {
+    constexpr uint32_t min_bits = (127u - 20u) << 23;
+    constexpr uint32_t max_bits = (127u << 23) - 1u;
+    uint32_t bits = float_to_bits(f);
+    if (!(f > bits_to_float(min_bits)))
+        bits = min_bits;
+    else if (bits > max_bits)
+        bits = max_bits;
+    return static_cast<uint16_t>((bits - min_bits) >> 13);
+}
+
+/* Runs check(offset, n) over the whole input and over lengths 1..max_tail from offset 1. */
+template <typename Check>
+void over_lengths(size_t size, Check check) {
+    check(0, size);
+    for (size_t n = 1; n <= max_tail && n < size; ++n)
+        check(1, n);
+}
+
+void test_lut_indices(const std::vector<float> &src) {
+    std::vector<uint16_t> idx(src.size());
+    over_lengths(src.size(), [&](size_t offset, size_t n) {
+        std::fill(idx.begin(), idx.end(), 0xFFFF);
+        lyra::float_lut_indices(src.data() + offset, idx.data() + offset, static_cast<int>(n));
+        int mismatches = 0;
+        for (size_t i = offset; i < offset + n; ++i) {
+            uint16_t expected = reference_lut_index(src[i]);
+            if (idx[i] != expected && ++mismatches <= 5)
+                std::fprintf(stderr, "lut: %08x -> %u, expected %u\n", float_to_bits(src[i]), idx[i], expected);
+        }
+        CHECK(mismatches == 0, "lut: %d of %zu indices differ", mismatches, n);
+        if (offset + n < idx.size())
+            CHECK(idx[offset + n] == 0xFFFF, "lut: wrote past %zu values", n);
+    });
+}
+
+void test_floats_to_halves(const std::vector<float> &src) {
+    // float_to_row with four channels converts the samples as one run; three channels go through a block
+    // of expanded RGBA.
+    size_t pixels = src.size() / 4;
+    std::vector<uint16_t> dst(pixels * 4);
+    over_lengths(pixels, [&](size_t offset, size_t n) {
+        lyra::float_to_row(src.data() + offset * 4, 4, dst.data() + offset * 4, LYRA_PIXEL_RGBA_F16, static_cast<int>(n), false);
+        int mismatches = 0;
+        for (size_t i = offset * 4; i < (offset + n) * 4; ++i) {
+            uint16_t expected = lyra::float_to_half(src[i]);
+            // Hardware conversions keep NaN payload bits the scalar code drops; both are quiet NaNs.
+            bool same = is_half_nan(expected) ? is_half_nan(dst[i]) && (dst[i] & 0x0200u) : dst[i] == expected;
+            if (!same && ++mismatches <= 5)
+                std::fprintf(stderr, "float to half: %08x -> %04x, expected %04x\n", float_to_bits(src[i]), dst[i], expected);
+        }
+        CHECK(mismatches == 0, "float to half: %d of %zu values differ", mismatches, n * 4);
+    });
+
+    size_t rgb_pixels = src.size() / 3;
+    std::vector<uint16_t> rgba(rgb_pixels * 4);
+    lyra::float_to_row(src.data(), 3, rgba.data(), LYRA_PIXEL_RGBA_F16, static_cast<int>(rgb_pixels), false);
+    int mismatches = 0;
+    for (size_t x = 0; x < rgb_pixels; ++x) {
+        for (int c = 0; c < 4; ++c) {
+            uint16_t expected = c < 3 ? lyra::float_to_half(src[x * 3 + c]) : 0x3C00;
+            uint16_t got = rgba[x * 4 + c];
+            if (!(is_half_nan(expected) ? is_half_nan(got) : got == expected))
+                ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0, "float RGB to half RGBA: %d samples differ", mismatches);
+}
+
+void test_halves_to_floats() {
+    std::vector<uint16_t> src(65536);
+    for (size_t h = 0; h < src.size(); ++h)
+        src[h] = static_cast<uint16_t>(h);
+
+    std::vector<float> dst(src.size());
+    over_lengths(src.size(), [&](size_t offset, size_t n) {
+        lyra::halves_to_floats(src.data() + offset, dst.data() + offset, n);
+        int mismatches = 0;
+        for (size_t i = offset; i < offset + n; ++i) {
+            float expected = lyra::half_to_float(src[i]);
+            // The scalar code keeps signalling NaNs as they are, the hardware quietens them.
+            bool same = std::isnan(expected) ? std::isnan(dst[i]) : float_to_bits(dst[i]) == float_to_bits(expected);
+            if (!same && ++mismatches <= 5)
+                std::fprintf(stderr, "half to float: %04x -> %08x, expected %08x\n", src[i], float_to_bits(dst[i]),
+                             float_to_bits(expected));
+        }
+        CHECK(mismatches == 0, "half to float: %d of %zu values differ", mismatches, n);
+    });
+}
+
+void test_rgbe_expand() {
+    // Every exponent with the mantissa extremes, spread so R, G and B see different pairs.
+    const uint8_t mantissas[] = {0, 1, 127, 128, 200, 255};
+    std::vector<uint8_t> rgbe;
+    for (int e = 0; e < 256; ++e)
+        for (uint8_t m : mantissas)
+            rgbe.insert(rgbe.end(), {m, static_cast<uint8_t>(255 - m), static_cast<uint8_t>(m ^ 0x55), static_cast<uint8_t>(e)});
+
+    size_t pixels = rgbe.size() / 4;
+    over_lengths(pixels, [&](size_t offset, size_t n) {
+        // Planar scanline of n pixels, as RGBE_DecodeScanline produces it.
+        std::vector<uint8_t> planar(n * 4);
+        for (size_t x = 0; x < n; ++x)
+            for (int c = 0; c < 4; ++c)
+                planar[c * n + x] = rgbe[(offset + x) * 4 + c];
+
+        std::vector<float> dst(n * 4);
+        lyra::rgbe_to_row(planar.data(), dst.data(), LYRA_PIXEL_RGBA_F32, static_cast<int>(n), false);
+        int mismatches = 0;
+        for (size_t x = 0; x < n; ++x) {
+            const uint8_t *p = &rgbe[(offset + x) * 4];
+            for (int c = 0; c < 4; ++c) {
+                float expected = c == 3 ? 1.0f : p[3] == 0 ? 0.0f : static_cast<float>(std::ldexp(static_cast<double>(p[c]), p[3] - 136));
+                if (float_to_bits(dst[x * 4 + c]) != float_to_bits(expected) && ++mismatches <= 5)
+                    std::fprintf(stderr, "rgbe: (%u, e=%u) channel %d -> %g, expected %g\n", p[c], p[3], c, dst[x * 4 + c],
+                                 expected);
+            }
+        }
+        CHECK(mismatches == 0, "rgbe: %d samples of %zu pixels differ", mismatches, n);
+    });
+}
+
+} // namespace
+
+int main() {
+    const char *requested = std::getenv("LYRA_NATIVE_ISA");
+    const char *running = lyra::cpu_isa_name(lyra::cpu_isa());
+    if (requested && *requested && std::strcmp(requested, running) != 0) {
+        std::printf("%s kernels not supported by this build or CPU (running %s), skipped\n", requested, running);
+        return lyra::test::skipped;
+    }
+    std::printf("testing %s kernels\n", running);
+
+    std::vector<float> floats = test_floats();
+    test_lut_indices(floats);
+    test_floats_to_halves(floats);
+    test_halves_to_floats();
+    test_rgbe_expand();
+    return lyra::test::test_result();
+}
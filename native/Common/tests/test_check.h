@@ -0,0 +1,40 @@
+#ifndef LYRA_TEST_CHECK_H
+#define LYRA_TEST_CHECK_H
+
+/* Header-only assertions for the native tests (rgbe_test, kernel_test). A failed CHECK reports
+ * and counts, so one run lists every failure; main returns test_result(). Built only with
+ * -DLYRA_BUILD_TESTS=ON, the default. */
+
+#include <cstdio>
+
+namespace lyra::test {
+
+inline int &failures() {
+    static int count = 0;
+    return count;
+}
+
+/* Exit code of a test binary: 0 when every check passed. */
+inline int test_result() {
+    if (failures() == 0)
+        return 0;
+    std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return 1;
+}
+
+/* Exit code ctest reads as a skipped test (SKIP_RETURN_CODE). */
+constexpr int skipped = 77;
+
+} // namespace lyra::test
+
+#define CHECK(cond, ...)                                                                                                  \
+    do {                                                                                                                  \
+        if (!(cond)) {                                                                                                    \
+            ++lyra::test::failures();                                                                                     \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond);                                \
+            std::fprintf(stderr, __VA_ARGS__);                                                                            \
+            std::fputc('\n', stderr);                                                                                     \
+        }                                                                                                                 \
+    } while (0)
+
+#endif // LYRA_TEST_CHECK_H
@@ -0,0 +1,179 @@
+/* Radiance HDR decode benchmark. Writes a deterministic corpus (RLE and flat scanlines at each
+ * size) with the bundled RGBE writer, then times every stage of hdr_native against it:
+ *
+ *   header      probe_hdr, header parse only
+ *   decompress  RLE scanline expansion alone, single-threaded (RGBE_DecodeScanline)
+ *   rgba8/f16/f32  full decode into each target layout (decompress + layout conversion)
+ *   preview     box-filtered preview at a quarter of the width
+ *   tonemap     tonemap_half_pixels (lyra_native_runtime) on the decoded half floats
+ *
+ * Results go to stdout or --out as JSON; see bench_harness.h for the options. */
+
+#include <memory>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+#include "bench/bench_harness.h"
+#include "lyra_decode.h"
+#include "mapped_file.h"
+#include "retained.h"
+#include "rgbe.h"
+
+extern "C" {
+const char *get_last_hdr_error();
+bool probe_hdr(const char *path, lyra_image_probe *probe);
+bool load_hdr_pixels(const char *path, const lyra_decode_target *target, const lyra_decode_control *control, bool *is_grayscale);
+bool load_hdr_preview(const char *path, int max_width, int max_height, const lyra_decode_target *target,
+                      const lyra_decode_control *control, bool *is_grayscale);
+bool read_hdr_preview_size(const char *path, int max_width, int max_height, int *width, int *height);
+}
+
+namespace {
+
+using lyra::bench::StageResult;
+
+std::string last_error() {
+    const char *error = get_last_hdr_error();
+    return error && *error ? error : "unknown error";
+}
+
+std::string last_runtime_error() {
+    const char *error = get_last_runtime_error();
+    return error && *error ? error : "unknown error";
+}
+
+bool file_exists(const std::string &path) {
+    struct stat st {};
+    return stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+void write_hdr(const std::string &path, int width, int height, bool rle) {
+    std::vector<float> rgb(static_cast<size_t>(width) * height * 3);
+    lyra::bench::fill_test_pattern(rgb.data(), width, height, 3);
+
+    FILE *f = std::fopen(path.c_str(), "wb");
+    if (!f)
+        throw std::runtime_error("Cannot create " + path);
+
+    bool ok = RGBE_WriteHeader(f, width, height, nullptr) == RGBE_RETURN_SUCCESS &&
+              (rle ? RGBE_WritePixels_RLE(f, rgb.data(), width, height)
+                   : RGBE_WritePixels(f, rgb.data(), width * height)) == RGBE_RETURN_SUCCESS;
+    std::fclose(f);
+    if (!ok)
+        throw std::runtime_error("Failed to write " + path);
+}
+
+/* Expands every scanline the way hdr_native does, minus threading and format conversion. */
+bool decompress_only(const char *path) {
+    lyra::MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    int width = 0, height = 0;
+    size_t header_size = 0;
+    if (RGBE_ReadHeader_Memory(file.data(), file.size(), &width, &height, nullptr, &header_size) < 0)
+        return false;
+
+    const unsigned char *payload = file.data() + header_size;
+    size_t size = file.size() - header_size;
+    std::vector<size_t> offsets(static_cast<size_t>(height) + 1);
+    int flat_from = height;
+    if (RGBE_FindScanlines_RLE(payload, size, width, height, offsets.data(), &flat_from) < 0)
+        return false;
+
+    std::vector<unsigned char> scanline(static_cast<size_t>(width) * 4);
+    for (int y = 0; y < height; ++y)
+        if (RGBE_DecodeScanline(payload + offsets[y], size - offsets[y], y >= flat_from, scanline.data(), width) < 0)
+            return false;
+    return true;
+}
+
+struct Pixels {
+    std::vector<uint8_t> data;
+    lyra_decode_target target{};
+
+    Pixels(int width, int height, int format, int bytes_per_pixel)
+        : data(static_cast<size_t>(width) * height * bytes_per_pixel) {
+        target = {data.data(), width, height, width * bytes_per_pixel, format};
+    }
+};
+
+void bench_file(const lyra::bench::Options &options, const std::string &path, const std::string &name, int width,
+                int height, std::vector<StageResult> &results) {
+    const int n = options.iterations;
+    const char *p = path.c_str();
+    bool gray = false;
+
+    results.push_back(lyra::bench::run_stage(name, "header", width, height, n, [&] {
+        lyra_image_probe probe{};
+        return probe_hdr(p, &probe);
+    }, last_error));
+
+    results.push_back(lyra::bench::run_stage(name, "decompress", width, height, n, [&] { return decompress_only(p); },
+                                             [] { return std::string("RLE decode failed"); }));
+
+    const struct {
+        const char *stage;
+        int format;
+        int bytes;
+    } layouts[] = {{"rgba8", LYRA_PIXEL_RGBA8, 4}, {"f16", LYRA_PIXEL_RGBA_F16, 8}, {"f32", LYRA_PIXEL_RGBA_F32, 16}};
+
+    for (const auto &layout : layouts) {
+        auto pixels = std::make_unique<Pixels>(width, height, layout.format, layout.bytes);
+        results.push_back(lyra::bench::run_stage(name, layout.stage, width, height, n, [&] {
+            return load_hdr_pixels(p, &pixels->target, nullptr, &gray);
+        }, last_error));
+    }
+
+    int pw = 0, ph = 0;
+    const int max_w = std::max(16, width / 4), max_h = std::max(16, height / 4);
+    if (read_hdr_preview_size(p, max_w, max_h, &pw, &ph)) {
+        auto preview = std::make_unique<Pixels>(pw, ph, LYRA_PIXEL_RGBA8, 4);
+        results.push_back(lyra::bench::run_stage(name, "preview", width, height, n, [&] {
+            return load_hdr_preview(p, max_w, max_h, &preview->target, nullptr, &gray);
+        }, last_error));
+    }
+
+    auto half = std::make_unique<Pixels>(width, height, LYRA_PIXEL_RGBA_F16, 8);
+    auto display = std::make_unique<Pixels>(width, height, LYRA_PIXEL_RGBA8, 4);
+    if (!load_hdr_pixels(p, &half->target, nullptr, &gray))
+        throw std::runtime_error(name + ": " + last_error());
+
+    const lyra_tone_params tone{1.0f, 2.2f, LYRA_TONE_ACES};
+    results.push_back(lyra::bench::run_stage(name, "tonemap", width, height, n, [&] {
+        return tonemap_half_pixels(&half->target, &display->target, &tone);
+    }, last_runtime_error));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        lyra::bench::Options options = lyra::bench::parse_options(argc, argv);
+#if defined(_WIN32)
+        _mkdir(options.corpus.c_str());
+#else
+        mkdir(options.corpus.c_str(), 0755);
+#endif
+
+        std::vector<StageResult> results;
+        for (int width : options.sizes) {
+            int height = width / 2;
+            for (bool rle : {true, false}) {
+                std::string name = "hdr_" + std::to_string(width) + "x" + std::to_string(height) + (rle ? "_rle" : "_flat") + ".hdr";
+                std::string path = options.corpus + "/" + name;
+                if (!file_exists(path))
+                    write_hdr(path, width, height, rle);
+
+                bench_file(options, path, name, width, height, results);
+            }
+        }
+
+        lyra::bench::write_json(options, "hdr_native", results);
+        return 0;
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "hdr_bench: %s\n", ex.what());
+        return 1;
+    }
+}
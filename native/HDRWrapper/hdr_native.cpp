@@ -1,9 +1,19 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
-#include <cstdlib>
 #include <cstring>
-#include <unordered_set>
-#include <mutex>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "decode_control.h"
+#include "lyra_decode.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "preview.h"
+#include "pixel_kernels.h"
 #include "rgbe.h"
+#include "scratch_pool.h"
 
 #ifdef _WIN32
 #define HDR_API __declspec(dllexport)
@@ -18,8 +28,206 @@
 #endif
 
 static THREAD_LOCAL char last_hdr_error[512] = "";
-static std::unordered_set<void*> hdr_allocated_ptrs;
-static std::mutex hdr_alloc_mutex;
+
+// Byte offsets of every scanline in the pixel payload, so workers can decode row ranges independently.
+struct HdrScanlines {
+    std::vector<size_t> offsets;
+    int flat_from = 0;
+
+    HdrScanlines(const unsigned char *payload, size_t size, int w, int h) : offsets(static_cast<size_t>(h) + 1), flat_from(h) {
+        if (RGBE_FindScanlines_RLE(payload, size, w, h, offsets.data(), &flat_from) < 0)
+            throw std::runtime_error("Failed to locate HDR scanlines.");
+    }
+
+    void decode(const unsigned char *payload, size_t size, int y, unsigned char *scanline, int w) const {
+        size_t offset = offsets[y];
+        if (RGBE_DecodeScanline(payload + offset, size - offset, y >= flat_from, scanline, w) < 0)
+            throw std::runtime_error("Failed to read HDR pixels (RLE).");
+    }
+};
+
+static void replicate_red(const lyra_decode_target *target) {
+    auto *dst = static_cast<uint8_t *>(target->pixels);
+    lyra::parallel_for_rows(target->height, 256, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y)
+            lyra::replicate_red_row(dst + (size_t) y * target->stride, target->format, target->width);
+    });
+}
+
+// Decodes scanlines in parallel straight into the target, one scanline of planar RGBE per worker
+// as the only scratch, drawn from the session's pool when there is one. Target row 0 is image row `first_row`; workers expand and convert their own
+// row ranges from the located scanline offsets.
+static bool decode_hdr_scanlines(const unsigned char *payload, size_t size, const HdrScanlines &scanlines, int first_row,
+                                 const lyra_decode_target *target, lyra::DecodeMonitor &monitor) {
+    int w = target->width;
+    auto *dst = static_cast<uint8_t *>(target->pixels);
+    auto *stats = monitor.stats();
+    auto conversion = lyra::DecodeStats::conversion_stage(target->format);
+    std::atomic<bool> gray(true);
+    lyra::parallel_for_rows(target->height, 16, [&](int y0, int y1) {
+        lyra::ScratchBuffer scratch(monitor.scratch_pool(), static_cast<size_t>(w) * 4, stats);
+        auto *scanline = scratch.as<unsigned char>();
+        lyra::ImageStatsRows image_rows(monitor.image_stats());
+        for (int y = y0; y < y1; ++y) {
+            {
+                lyra::StageTimer timer(stats, lyra::DecodeStats::decompress);
+                scanlines.decode(payload, size, first_row + y, scanline, w);
+            }
+
+            lyra::StageTimer timer(stats, conversion);
+            uint8_t *row = dst + (size_t) y * target->stride;
+            if (!lyra::rgbe_to_row(scanline, row, target->format, w, gray.load(std::memory_order_relaxed)))
+                gray.store(false, std::memory_order_relaxed);
+            image_rows.add_rgbe_row(scanline, w);
+            timer.stop();
+            monitor.advance(1);
+        }
+    });
+    return gray;
+}
+
+// Mapped file plus its scanline offsets, located once so bands can be decoded in any order.
+struct HdrScanlineReader {
+    lyra::MappedFile file;
+    const unsigned char *payload = nullptr;
+    size_t payload_size = 0;
+    int width = 0;
+    int height = 0;
+    std::unique_ptr<HdrScanlines> scanlines;
+};
+
+// Decodes a complete .hdr file held in memory into the target.
+static bool decode_hdr_memory(const unsigned char *data, size_t size, const lyra_decode_target *target,
+                              const lyra_decode_control *control, bool *is_grayscale, lyra::DecodeStats &stats) {
+    int w = 0, h = 0;
+    size_t header_size = 0;
+    lyra::StageTimer header_timer(&stats, lyra::DecodeStats::header);
+    if (RGBE_ReadHeader_Memory(data, size, &w, &h, nullptr, &header_size) < 0) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
+        return false;
+    }
+    header_timer.stop();
+
+    if (w != target->width || h != target->height) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR size changed: expected %dx%d, got %dx%d.", target->width, target->height, w, h);
+        return false;
+    }
+
+    try {
+        lyra::ThreadBudget budget(control);
+        stats.set_threads(budget.threads());
+        stats.set_io_bytes(static_cast<long long>(size));
+
+        const unsigned char *payload = data + header_size;
+        size_t payload_size = size - header_size;
+        lyra::StageTimer locate_timer(&stats, lyra::DecodeStats::decompress);
+        HdrScanlines scanlines(payload, payload_size, w, h);
+        lyra::ScratchBytes offsets_scratch(&stats, scanlines.offsets.size() * sizeof(size_t));
+        locate_timer.stop();
+
+        lyra::ImageStats image_stats(control);
+        lyra::DecodeMonitor monitor(control, h, &stats, &image_stats);
+        bool gray = decode_hdr_scanlines(payload, payload_size, scanlines, 0, target, monitor);
+        if (gray)
+            replicate_red(target);
+        image_stats.publish(gray);
+
+        *is_grayscale = gray;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "%s", ex.what());
+        return false;
+    } catch (const std::exception &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR decode failed: %s", ex.what());
+        return false;
+    }
+
+    last_hdr_error[0] = '\0';
+    return true;
+}
+
+// Box-filters the image down by an integer factor while scanlines stream in. Each worker owns a range
+// of preview rows and decodes only the source scanlines feeding them.
+static bool decode_hdr_preview_memory(const unsigned char *data, size_t size, int max_width, int max_height,
+                                      const lyra_decode_target *target, const lyra_decode_control *control,
+                                      bool *is_grayscale, lyra::DecodeStats &stats) {
+    int w = 0, h = 0;
+    size_t header_size = 0;
+    lyra::StageTimer header_timer(&stats, lyra::DecodeStats::header);
+    if (RGBE_ReadHeader_Memory(data, size, &w, &h, nullptr, &header_size) < 0) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
+        return false;
+    }
+    header_timer.stop();
+
+    int factor = lyra::preview_factor(w, h, max_width, max_height);
+    int pw = 0, ph = 0;
+    lyra::preview_size(w, h, factor, &pw, &ph);
+    if (pw != target->width || ph != target->height) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR preview size mismatch: expected %dx%d, got %dx%d.", target->width, target->height, pw, ph);
+        return false;
+    }
+
+    try {
+        lyra::ThreadBudget budget(control);
+        stats.set_threads(budget.threads());
+        stats.set_io_bytes(static_cast<long long>(size));
+
+        const unsigned char *payload = data + header_size;
+        size_t payload_size = size - header_size;
+        lyra::StageTimer locate_timer(&stats, lyra::DecodeStats::decompress);
+        HdrScanlines scanlines(payload, payload_size, w, h);
+        lyra::ScratchBytes offsets_scratch(&stats, scanlines.offsets.size() * sizeof(size_t));
+        locate_timer.stop();
+
+        lyra::DecodeMonitor monitor(control, ph, &stats);
+
+        auto *dst = static_cast<uint8_t *>(target->pixels);
+        std::atomic<bool> gray(true);
+        lyra::parallel_for_rows(ph, 4, [&](int py0, int py1) {
+            lyra::ScratchBuffer scanline_scratch(monitor.scratch_pool(), static_cast<size_t>(w) * 4, &stats);
+            lyra::ScratchBuffer rgba_scratch(monitor.scratch_pool(), static_cast<size_t>(w) * 4 * sizeof(float), &stats);
+            auto *scanline = scanline_scratch.as<unsigned char>();
+            auto *rgba = rgba_scratch.as<float>();
+            lyra::PreviewRowFilter filter(w, factor);
+            // The filter accumulates one float row per column block; count it with the row buffers.
+            lyra::ScratchBytes filter_scratch(&stats, rgba_scratch.size());
+
+            for (int py = py0; py < py1; ++py) {
+                int y1 = std::min((py + 1) * factor, h);
+                for (int y = py * factor; y < y1; ++y) {
+                    {
+                        lyra::StageTimer timer(&stats, lyra::DecodeStats::decompress);
+                        scanlines.decode(payload, payload_size, y, scanline, w);
+                    }
+                    lyra::StageTimer timer(&stats, lyra::DecodeStats::convert);
+                    lyra::rgbe_to_row(scanline, rgba, LYRA_PIXEL_RGBA_F32, w, false);
+                    filter.add_row(rgba, 4);
+                }
+
+                lyra::StageTimer timer(&stats, lyra::DecodeStats::conversion_stage(target->format));
+                uint8_t *row = dst + (size_t) py * target->stride;
+                if (!filter.emit(row, target->format, gray.load(std::memory_order_relaxed)))
+                    gray.store(false, std::memory_order_relaxed);
+                timer.stop();
+                monitor.advance(1);
+            }
+        });
+
+        if (gray)
+            replicate_red(target);
+
+        *is_grayscale = gray;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "%s", ex.what());
+        return false;
+    } catch (const std::exception &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR preview failed: %s", ex.what());
+        return false;
+    }
+
+    last_hdr_error[0] = '\0';
+    return true;
+}
 
 extern "C" {
 
@@ -27,87 +235,209 @@ HDR_API const char* get_last_hdr_error() {
     return last_hdr_error;
 }
 
-HDR_API bool load_hdr_rgba(const char *path, float **out_pixels, int *width, int *height) {
+HDR_API bool read_hdr_size(const char *path, int *width, int *height) {
     FILE *file = fopen(path, "rb");
     if (!file) {
         snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to open HDR file.");
         return false;
     }
 
-    if (RGBE_ReadHeader(file, width, height, nullptr) < 0) {
-        fclose(file);
+    bool ok = RGBE_ReadHeader(file, width, height, nullptr) == RGBE_RETURN_SUCCESS;
+    fclose(file);
+
+    if (!ok) {
         snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
         return false;
     }
 
-    int totalPixels = (*width) * (*height);
-    float *buffer = (float *) malloc(sizeof(float) * totalPixels * 4);
-    if (!buffer) {
-        fclose(file);
-        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to allocate memory for HDR output buffer.");
+    last_hdr_error[0] = '\0';
+    return true;
+}
+
+HDR_API bool probe_hdr(const char *path, lyra_image_probe *probe) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to open HDR file.");
         return false;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(hdr_alloc_mutex);
-        hdr_allocated_ptrs.insert(buffer);
+    int w = 0, h = 0;
+    unsigned char first[4] = {0, 0, 0, 0};
+    bool ok = RGBE_ReadHeader(file, &w, &h, nullptr) == RGBE_RETURN_SUCCESS;
+    bool has_first = ok && fread(first, 1, sizeof(first), file) == sizeof(first);
+    fclose(file);
+
+    if (!ok) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
+        return false;
     }
 
-    float *rgb = (float *) malloc(sizeof(float) * totalPixels * 3);
-    if (!rgb) {
-        fclose(file);
-        {
-            std::lock_guard<std::mutex> lock(hdr_alloc_mutex);
-            hdr_allocated_ptrs.erase(buffer);
-        }
-        free(buffer);
-        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to allocate memory for HDR intermediate RGB buffer.");
+    // Same test RGBE_ReadPixels_RLE applies to the first scanline.
+    bool rle = has_first && w >= 8 && w <= 0x7fff && first[0] == 2 && first[1] == 2 && !(first[2] & 0x80);
+
+    memset(probe, 0, sizeof(*probe));
+    probe->width = w;
+    probe->height = h;
+    probe->data_window[2] = probe->display_window[2] = w - 1;
+    probe->data_window[3] = probe->display_window[3] = h - 1;
+    probe->channel_count = 3;
+    probe->stored_bytes_per_pixel = 4;
+    snprintf(probe->channels, sizeof(probe->channels), "R:rgbe;G:rgbe;B:rgbe");
+    snprintf(probe->compression, sizeof(probe->compression), "%s", rle ? "rle" : "flat");
+    probe->level_count = 1;
+    probe->part_count = 1;
+
+    last_hdr_error[0] = '\0';
+    return true;
+}
+
+HDR_API bool read_hdr_size_from_memory(const void *data, size_t size, int *width, int *height) {
+    if (!data || RGBE_ReadHeader_Memory(static_cast<const unsigned char *>(data), size, width, height, nullptr, nullptr) < 0) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
         return false;
     }
 
-    if (RGBE_ReadPixels_RLE(file, rgb, *width, *height) < 0) {
-        fclose(file);
-        {
-            std::lock_guard<std::mutex> lock(hdr_alloc_mutex);
-            hdr_allocated_ptrs.erase(buffer);
-        }
-        free(buffer);
-        free(rgb);
-        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR pixels (RLE).\n");
+    last_hdr_error[0] = '\0';
+    return true;
+}
+
+HDR_API bool load_hdr_pixels(const char *path, const lyra_decode_target *target, const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target)) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Invalid HDR destination buffer.");
         return false;
     }
 
-    fclose(file);
+    lyra::DecodeStats stats(control);
+    lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+    lyra::MappedFile file;
+    if (!file.open(path)) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to open HDR file.");
+        return false;
+    }
+    open_timer.stop();
+
+    return decode_hdr_memory(file.data(), file.size(), target, control, is_grayscale, stats);
+}
 
-    for (int i = 0; i < totalPixels; ++i) {
-        buffer[i * 4 + 0] = rgb[i * 3 + 0];
-        buffer[i * 4 + 1] = rgb[i * 3 + 1];
-        buffer[i * 4 + 2] = rgb[i * 3 + 2];
-        buffer[i * 4 + 3] = 1.0f; // Alpha
+HDR_API bool load_hdr_pixels_from_memory(const void *data, size_t size, const lyra_decode_target *target,
+                                         const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target) || !data) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Invalid HDR source or destination buffer.");
+        return false;
     }
 
-    free(rgb);
-    last_hdr_error[0] = '\0';
-    *out_pixels = buffer;
+    lyra::DecodeStats stats(control);
+    return decode_hdr_memory(static_cast<const unsigned char *>(data), size, target, control, is_grayscale, stats);
+}
+
+HDR_API bool read_hdr_preview_size(const char *path, int max_width, int max_height, int *width, int *height) {
+    int w = 0, h = 0;
+    if (!read_hdr_size(path, &w, &h))
+        return false;
+
+    lyra::preview_size(w, h, lyra::preview_factor(w, h, max_width, max_height), width, height);
     return true;
 }
 
-HDR_API void free_hdr_pixels(float *ptr) {
-    if (ptr == nullptr) {
-        printf("[C++] Warning: free_hdr_pixels called with null pointer!\n");
-        fflush(stdout);
-        return;
+HDR_API bool load_hdr_preview(const char *path, int max_width, int max_height, const lyra_decode_target *target,
+                              const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target) || target->format == LYRA_PIXEL_RGBE8) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Invalid HDR destination buffer.");
+        return false;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(hdr_alloc_mutex);
-        if (hdr_allocated_ptrs.find(ptr) == hdr_allocated_ptrs.end()) {
-            printf("[C++] Warning: Attempting to free unknown or already freed pointer %p!\n", ptr);
-            fflush(stdout);
-        } else {
-            hdr_allocated_ptrs.erase(ptr);
-            free(ptr);
-        }
+    lyra::DecodeStats stats(control);
+    lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+    lyra::MappedFile file;
+    if (!file.open(path)) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to open HDR file.");
+        return false;
+    }
+    open_timer.stop();
+
+    return decode_hdr_preview_memory(file.data(), file.size(), max_width, max_height, target, control, is_grayscale, stats);
+}
+
+HDR_API void *hdr_scanline_open(const char *path) {
+    auto reader = std::make_unique<HdrScanlineReader>();
+    if (!reader->file.open(path)) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to open HDR file.");
+        return nullptr;
+    }
+
+    size_t header_size = 0;
+    if (RGBE_ReadHeader_Memory(reader->file.data(), reader->file.size(), &reader->width, &reader->height, nullptr, &header_size) < 0) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Failed to read HDR header.");
+        return nullptr;
+    }
+
+    try {
+        reader->payload = reader->file.data() + header_size;
+        reader->payload_size = reader->file.size() - header_size;
+        reader->scanlines = std::make_unique<HdrScanlines>(reader->payload, reader->payload_size, reader->width, reader->height);
+    } catch (const std::exception &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR decode failed: %s", ex.what());
+        return nullptr;
+    }
+
+    last_hdr_error[0] = '\0';
+    return reader.release();
+}
+
+HDR_API void hdr_scanline_close(void *handle) {
+    delete static_cast<HdrScanlineReader *>(handle);
+}
+
+// Decodes image rows [first_row, first_row + target->height) into the target. Grayscale is not decided
+// per band; RGBE stores gray images with equal channels, so nothing needs replicating.
+HDR_API bool hdr_scanline_read(void *handle, int first_row, const lyra_decode_target *target, const lyra_decode_control *control) {
+    auto *reader = static_cast<HdrScanlineReader *>(handle);
+    if (!reader || !lyra::is_valid_target(target) || target->format == LYRA_PIXEL_RGBE8) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "Invalid HDR scanline reader or destination buffer.");
+        return false;
+    }
+
+    if (target->width != reader->width || first_row < 0 || first_row + target->height > reader->height) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR band out of range: rows %d-%d of %dx%d.", first_row, first_row + target->height - 1, reader->width, reader->height);
+        return false;
+    }
+
+    try {
+        lyra::DecodeStats stats(control);
+        lyra::ThreadBudget budget(control);
+        stats.set_threads(budget.threads());
+        lyra::DecodeMonitor monitor(control, target->height, &stats);
+        monitor.check();
+        decode_hdr_scanlines(reader->payload, reader->payload_size, *reader->scanlines, first_row, target, monitor);
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "%s", ex.what());
+        return false;
+    } catch (const std::exception &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR decode failed: %s", ex.what());
+        return false;
+    }
+
+    last_hdr_error[0] = '\0';
+    return true;
+}
+
+// Session whose pool keeps up to `retain_bytes` of idle scratch between decodes; passed in lyra_decode_control.
+HDR_API lyra_decode_session *hdr_session_create(long long retain_bytes) {
+    try {
+        return new lyra_decode_session(static_cast<size_t>(std::max(0LL, retain_bytes)));
+    } catch (const std::exception &ex) {
+        snprintf(last_hdr_error, sizeof(last_hdr_error), "HDR session failed: %s", ex.what());
+        return nullptr;
     }
 }
+
+// Frees idle scratch not reused since the previous trim and any beyond `retain_bytes`, the new cap.
+// Returns the bytes freed.
+HDR_API long long hdr_session_trim(lyra_decode_session *session, long long retain_bytes) {
+    return session ? static_cast<long long>(session->pool.trim(static_cast<size_t>(std::max(0LL, retain_bytes)))) : 0;
+}
+
+HDR_API void hdr_session_destroy(lyra_decode_session *session) {
+    delete session;
+}
 }
@@ -18,6 +18,9 @@
  feel free to modify it to suit your needs.
 
  (Place notice here if you modified the code.)
+ Modified for Lyra: in-memory header parsing, scanline location and decoding
+ so files can be read from a mapped view and scanlines decoded in parallel
+ (RGBE_ReadHeader_Memory, RGBE_FindScanlines_RLE, RGBE_DecodeScanline).
  posted to http://www.graphics.cornell.edu/~bjw/
  written by Bruce Walter  (bjw@graphics.cornell.edu)  5/26/95
  based on code written by Greg Ward
@@ -124,8 +127,36 @@ int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info) {
     return RGBE_RETURN_SUCCESS;
 }
 
+/* line reader used by the header parser; same contract as fgets */
+typedef char *(*rgbe_gets_fn)(char *buf, int size, void *source);
+
+static char *rgbe_file_gets(char *buf, int size, void *source) {
+    return fgets(buf, size, (FILE *) source);
+}
+
+struct rgbe_memory_source {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+};
+
+static char *rgbe_memory_gets(char *buf, int size, void *source) {
+    struct rgbe_memory_source *src = (struct rgbe_memory_source *) source;
+    int n = 0;
+
+    if (src->pos >= src->size)
+        return NULL;
+    while ((n < size - 1) && (src->pos < src->size)) {
+        buf[n] = (char) src->data[src->pos++];
+        if (buf[n++] == '\n')
+            break;
+    }
+    buf[n] = 0;
+    return buf;
+}
+
 /* minimal header reading.  modify if you want to parse more information */
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info) {
+static int rgbe_read_header(rgbe_gets_fn next_line, void *source, int *width, int *height, rgbe_header_info *info) {
     char buf[128];
     int found_format;
     float tempf;
@@ -137,7 +168,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info) {
         info->programtype[0] = 0;
         info->gamma = info->exposure = 1.0;
     }
-    if (fgets(buf, sizeof(buf) / sizeof(buf[0]), fp) == NULL)
+    if (next_line(buf, sizeof(buf) / sizeof(buf[0]), source) == NULL)
         return rgbe_error(rgbe_read_error, NULL);
     if ((buf[0] != '#') || (buf[1] != '?')) {
         /* if you want to require the magic token then uncomment the next line */
@@ -150,7 +181,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info) {
             info->programtype[i] = buf[i + 2];
         }
         info->programtype[i] = 0;
-        if (fgets(buf, sizeof(buf) / sizeof(buf[0]), fp) == 0)
+        if (next_line(buf, sizeof(buf) / sizeof(buf[0]), source) == 0)
             return rgbe_error(rgbe_read_error, NULL);
     }
     for (;;) {
@@ -165,20 +196,38 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info) {
             info->exposure = tempf;
             info->valid |= RGBE_VALID_EXPOSURE;
         }
-        if (fgets(buf, sizeof(buf) / sizeof(buf[0]), fp) == 0)
+        if (next_line(buf, sizeof(buf) / sizeof(buf[0]), source) == 0)
             return rgbe_error(rgbe_read_error, NULL);
     }
-    if (fgets(buf, sizeof(buf) / sizeof(buf[0]), fp) == 0)
+    if (next_line(buf, sizeof(buf) / sizeof(buf[0]), source) == 0)
         return rgbe_error(rgbe_read_error, NULL);
     if (strcmp(buf, "\n") != 0)
         return rgbe_error(rgbe_format_error, "missing blank line after FORMAT specifier");
-    if (fgets(buf, sizeof(buf) / sizeof(buf[0]), fp) == 0)
+    if (next_line(buf, sizeof(buf) / sizeof(buf[0]), source) == 0)
         return rgbe_error(rgbe_read_error, NULL);
     if (sscanf(buf, "-Y %d +X %d", height, width) < 2)
         return rgbe_error(rgbe_format_error, "missing image size specifier");
     return RGBE_RETURN_SUCCESS;
 }
 
+int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info) {
+    return rgbe_read_header(rgbe_file_gets, fp, width, height, info);
+}
+
+int RGBE_ReadHeader_Memory(const unsigned char *data, size_t size, int *width, int *height, rgbe_header_info *info,
+                           size_t *header_size) {
+    struct rgbe_memory_source src;
+    int result;
+
+    src.data = data;
+    src.size = size;
+    src.pos = 0;
+    result = rgbe_read_header(rgbe_memory_gets, &src, width, height, info);
+    if (header_size)
+        *header_size = src.pos;
+    return result;
+}
+
 /* simple write routine that does not use run length encoding */
 /* These routines can be made faster by allocating a larger buffer and
    fread-ing and fwrite-ing the data in larger chunks */
@@ -385,4 +434,115 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width, int num_scanl
     }
     free(scanline_buffer);
     return RGBE_RETURN_SUCCESS;
-}
\ No newline at end of file
+}
+
+/* In-memory routines for parallel decoding.  The pixel data (everything after
+   the header) is held in one buffer; a quick first pass walks the run headers
+   to find where each scanline starts, after which scanlines can be decoded
+   independently. */
+
+/* Skip one run length encoded channel of a scanline, returning the offset just
+   past it or 0 if the data is malformed. */
+static size_t rgbe_skip_channel_RLE(const unsigned char *data, size_t size, size_t pos, int scanline_width) {
+    int remaining = scanline_width;
+    int count;
+
+    while (remaining > 0) {
+        if (pos + 2 > size)
+            return 0;
+        if (data[pos] > 128) {
+            count = data[pos] - 128;
+            if (count > remaining)
+                return 0;
+            pos += 2;
+        } else {
+            count = data[pos];
+            if ((count == 0) || (count > remaining) || (pos + 1 + count > size))
+                return 0;
+            pos += 1 + count;
+        }
+        remaining -= count;
+    }
+    return pos;
+}
+
+int RGBE_FindScanlines_RLE(const unsigned char *data, size_t size, int scanline_width, int num_scanlines,
+                           size_t *offsets, int *flat_from) {
+    size_t pos = 0;
+    int y, i;
+
+    *flat_from = num_scanlines;
+    for (y = 0; y < num_scanlines; y++) {
+        offsets[y] = pos;
+        if ((scanline_width < 8) || (scanline_width > 0x7fff) || (pos + 4 > size) ||
+            (data[pos] != 2) || (data[pos + 1] != 2) || (data[pos + 2] & 0x80)) {
+            /* not run length encoded: the rest of the file is flat, as in RGBE_ReadPixels_RLE */
+            *flat_from = y;
+            for (; y < num_scanlines; y++) {
+                offsets[y] = pos;
+                pos += (size_t) scanline_width * 4;
+            }
+            offsets[num_scanlines] = pos;
+            if (pos > size)
+                return rgbe_error(rgbe_read_error, NULL);
+            return RGBE_RETURN_SUCCESS;
+        }
+        if ((((int) data[pos + 2]) << 8 | data[pos + 3]) != scanline_width)
+            return rgbe_error(rgbe_format_error, "wrong scanline width");
+        pos += 4;
+        for (i = 0; i < 4; i++) {
+            pos = rgbe_skip_channel_RLE(data, size, pos, scanline_width);
+            if (pos == 0)
+                return rgbe_error(rgbe_format_error, "bad scanline data");
+        }
+    }
+    offsets[num_scanlines] = pos;
+    return RGBE_RETURN_SUCCESS;
+}
+
+int RGBE_DecodeScanline(const unsigned char *data, size_t size, int flat, unsigned char *scanline_buffer,
+                        int scanline_width) {
+    const unsigned char *end = data + size;
+    unsigned char *ptr, *ptr_end;
+    int i, count;
+
+    if (flat) {
+        if ((size_t) scanline_width * 4 > size)
+            return rgbe_error(rgbe_read_error, NULL);
+        for (i = 0; i < scanline_width; i++) {
+            scanline_buffer[i] = data[i * 4 + 0];
+            scanline_buffer[i + scanline_width] = data[i * 4 + 1];
+            scanline_buffer[i + 2 * scanline_width] = data[i * 4 + 2];
+            scanline_buffer[i + 3 * scanline_width] = data[i * 4 + 3];
+        }
+        return RGBE_RETURN_SUCCESS;
+    }
+
+    data += 4; /* scanline header, validated by RGBE_FindScanlines_RLE */
+    ptr = &scanline_buffer[0];
+    for (i = 0; i < 4; i++) {
+        ptr_end = &scanline_buffer[(i + 1) * scanline_width];
+        while (ptr < ptr_end) {
+            if (end - data < 2)
+                return rgbe_error(rgbe_read_error, NULL);
+            if (data[0] > 128) {
+                /* a run of the same value */
+                count = data[0] - 128;
+                if (count > ptr_end - ptr)
+                    return rgbe_error(rgbe_format_error, "bad scanline data");
+                memset(ptr, data[1], count);
+                ptr += count;
+                data += 2;
+            } else {
+                /* a non-run */
+                count = data[0];
+                if ((count == 0) || (count > ptr_end - ptr) || (count > end - data - 1))
+                    return rgbe_error(rgbe_format_error, "bad scanline data");
+                memcpy(ptr, data + 1, count);
+                ptr += count;
+                data += 1 + count;
+            }
+        }
+    }
+    return RGBE_RETURN_SUCCESS;
+}
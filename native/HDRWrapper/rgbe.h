@@ -38,6 +38,9 @@ typedef struct {
 /* you may set rgbe_header_info to null if you want to */
 int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info);
 int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info);
+/* reads a header from memory; *header_size receives the number of bytes consumed */
+int RGBE_ReadHeader_Memory(const unsigned char *data, size_t size, int *width, int *height, rgbe_header_info *info,
+                           size_t *header_size);
 
 /* read or write pixels */
 /* can read or write pixels in chunks of any size including single pixels*/
@@ -49,6 +52,15 @@ int RGBE_ReadPixels(FILE *fp, float *data, int numpixels);
 int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width, int num_scanlines);
 int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width, int num_scanlines);
 
+/* in-memory reading for parallel decoding; data holds the pixels following the header */
+/* offsets receives num_scanlines+1 entries: the start of each scanline and the end of the last */
+/* scanlines from *flat_from onwards are stored flat rather than run length encoded */
+int RGBE_FindScanlines_RLE(const unsigned char *data, size_t size, int scanline_width, int num_scanlines,
+                           size_t *offsets, int *flat_from);
+/* decodes one scanline into planar bytes: scanline_width R values, then G, B and E */
+int RGBE_DecodeScanline(const unsigned char *data, size_t size, int flat, unsigned char *scanline_buffer,
+                        int scanline_width);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,255 @@
+/* Tests of the in-memory Radiance scanline parser (RGBE_FindScanlines_RLE, RGBE_DecodeScanline)
+ * that hdr_native decodes untrusted files with:
+ *
+ *   locate    scanline offsets of RLE, flat and RLE-then-flat payloads
+ *   corrupt   truncated payloads and bad run lengths are rejected, by both functions
+ *   decode    the parallel decode matches the serial RGBE_ReadPixels_RLE bit for bit
+ *
+ * Files are made with the bundled RGBE writer, like hdr_bench's corpus. */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "lyra_decode.h"
+#include "rgbe.h"
+#include "tests/test_check.h"
+
+extern "C" {
+const char *get_last_hdr_error();
+bool load_hdr_pixels_from_memory(const void *data, size_t size, const lyra_decode_target *target,
+                                 const lyra_decode_control *control, bool *is_grayscale);
+}
+
+namespace {
+
+struct HdrFile {
+    std::vector<unsigned char> bytes;
+    size_t header_size = 0;
+    int width = 0;
+    int height = 0;
+
+    const unsigned char *payload() const { return bytes.data() + header_size; }
+    size_t payload_size() const { return bytes.size() - header_size; }
+};
+
+/* Deterministic pixels with runs, black pixels (e == 0) and exponents from 2^-30 to 2^30. */
+std::vector<float> test_pixels(int width, int height) {
+    std::vector<float> rgb(static_cast<size_t>(width) * height * 3);
+    uint32_t state = 0x9E3779B9u;
+    auto next = [&] {
+        state = state * 1664525u + 1013904223u;
+        return state;
+    };
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float *p = &rgb[(static_cast<size_t>(y) * width + x) * 3];
+            int kind = (x / 16 + y) % 6;
+            for (int c = 0; c < 3; ++c) {
+                if (kind == 0)
+                    p[c] = 0.25f * (c + 1); // runs
+                else if (kind == 1)
+                    p[c] = 0.0f;
+                else
+                    p[c] = std::ldexp(static_cast<float>(next() >> 8) / 16777216.0f, static_cast<int>(next() % 61) - 30);
+            }
+        }
+    }
+    return rgb;
+}
+
+/* Writes the first rle_rows scanlines run length encoded and the rest flat, as a file
+ * written by a tool that gave up on RLE part way would be. */
+HdrFile write_hdr(int width, int height, int rle_rows) {
+    std::vector<float> rgb = test_pixels(width, height);
+    size_t flat = static_cast<size_t>(rle_rows) * width * 3;
+    if (rle_rows < height) {
+        // A flat scanline must not start like an RLE one (2, 2, width): make the first pixel 1.0.
+        rgb[flat] = rgb[flat + 1] = rgb[flat + 2] = 1.0f;
+    }
+
+    HdrFile file;
+    FILE *f = std::tmpfile();
+    CHECK(f != nullptr, "tmpfile failed");
+    if (!f)
+        return file;
+
+    bool ok = RGBE_WriteHeader(f, width, height, nullptr) == RGBE_RETURN_SUCCESS &&
+              RGBE_WritePixels_RLE(f, rgb.data(), width, rle_rows) == RGBE_RETURN_SUCCESS &&
+              RGBE_WritePixels(f, rgb.data() + flat, width * (height - rle_rows)) == RGBE_RETURN_SUCCESS;
+    CHECK(ok, "writing %dx%d failed", width, height);
+
+    file.bytes.resize(static_cast<size_t>(std::ftell(f)));
+    std::rewind(f);
+    CHECK(std::fread(file.bytes.data(), 1, file.bytes.size(), f) == file.bytes.size(), "reading back failed");
+    std::fclose(f);
+
+    CHECK(RGBE_ReadHeader_Memory(file.bytes.data(), file.bytes.size(), &file.width, &file.height, nullptr,
+                                 &file.header_size) == RGBE_RETURN_SUCCESS, "header of %dx%d not read", width, height);
+    return file;
+}
+
+bool find_scanlines(const unsigned char *data, size_t size, int width, int height, std::vector<size_t> &offsets,
+                    int &flat_from) {
+    offsets.assign(static_cast<size_t>(height) + 1, 0);
+    flat_from = -1;
+    return RGBE_FindScanlines_RLE(data, size, width, height, offsets.data(), &flat_from) == RGBE_RETURN_SUCCESS;
+}
+
+bool find_scanlines(const HdrFile &file, std::vector<size_t> &offsets, int &flat_from) {
+    return find_scanlines(file.payload(), file.payload_size(), file.width, file.height, offsets, flat_from);
+}
+
+void test_locate_rle() {
+    HdrFile file = write_hdr(300, 257, 257);
+    std::vector<size_t> offsets;
+    int flat_from = 0;
+    CHECK(find_scanlines(file, offsets, flat_from), "RLE file not located");
+    CHECK(flat_from == file.height, "flat_from %d, expected %d", flat_from, file.height);
+    CHECK(offsets[0] == 0, "first scanline at %zu", offsets[0]);
+    CHECK(offsets[file.height] == file.payload_size(), "end %zu, payload %zu", offsets[file.height], file.payload_size());
+    for (int y = 0; y < file.height; ++y) {
+        const unsigned char *s = file.payload() + offsets[y];
+        CHECK(offsets[y] < offsets[y + 1] && s[0] == 2 && s[1] == 2 && (s[2] << 8 | s[3]) == file.width,
+              "scanline %d at %zu is not an RLE header", y, offsets[y]);
+    }
+}
+
+void test_locate_flat() {
+    // Narrower than 8 pixels: the writer stores every scanline flat.
+    HdrFile file = write_hdr(7, 33, 33);
+    std::vector<size_t> offsets;
+    int flat_from = -1;
+    CHECK(find_scanlines(file, offsets, flat_from), "flat file not located");
+    CHECK(flat_from == 0, "flat_from %d, expected 0", flat_from);
+    for (int y = 0; y <= file.height; ++y)
+        CHECK(offsets[y] == static_cast<size_t>(y) * file.width * 4, "scanline %d at %zu", y, offsets[y]);
+}
+
+void test_locate_flat_tail() {
+    const int rle_rows = 40;
+    HdrFile file = write_hdr(64, 100, rle_rows);
+
+    // A later flat scanline that looks like an RLE header stays flat: the tail is never parsed again.
+    size_t second_flat = file.header_size + file.payload_size() - static_cast<size_t>(file.height - rle_rows - 1) * file.width * 4;
+    const unsigned char rle_header[] = {2, 2, 0, 64};
+    std::memcpy(&file.bytes[second_flat], rle_header, sizeof(rle_header));
+
+    std::vector<size_t> offsets;
+    int flat_from = -1;
+    CHECK(find_scanlines(file, offsets, flat_from), "RLE-then-flat file not located");
+    CHECK(flat_from == rle_rows, "flat_from %d, expected %d", flat_from, rle_rows);
+    for (int y = rle_rows; y <= file.height; ++y)
+        CHECK(offsets[y] == offsets[rle_rows] + static_cast<size_t>(y - rle_rows) * file.width * 4, "scanline %d at %zu", y,
+              offsets[y]);
+    CHECK(offsets[file.height] == file.payload_size(), "end %zu, payload %zu", offsets[file.height], file.payload_size());
+}
+
+void test_truncated() {
+    for (int width : {16, 7}) {
+        HdrFile file = write_hdr(width, 6, 6);
+        std::vector<size_t> offsets;
+        int flat_from = 0;
+        for (size_t n = 0; n < file.payload_size(); ++n)
+            CHECK(!find_scanlines(file.payload(), n, file.width, file.height, offsets, flat_from),
+                  "width %d: payload cut to %zu of %zu bytes located", width, n, file.payload_size());
+
+        // The decoder checks its own bounds too: cut the last scanline at every byte.
+        CHECK(find_scanlines(file, offsets, flat_from), "width %d not located", width);
+        std::vector<unsigned char> scanline(static_cast<size_t>(width) * 4);
+        size_t last = offsets[file.height - 1];
+        for (size_t n = 0; n < file.payload_size() - last; ++n)
+            CHECK(RGBE_DecodeScanline(file.payload() + last, n, flat_from < file.height, scanline.data(), width) < 0,
+                  "width %d: last scanline cut to %zu bytes decoded", width, n);
+
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * file.height * 16);
+        lyra_decode_target target{pixels.data(), width, file.height, width * 16, LYRA_PIXEL_RGBA_F32};
+        lyra_decode_control control{};
+        bool gray = false;
+        CHECK(!load_hdr_pixels_from_memory(file.bytes.data(), file.bytes.size() - 1, &target, &control, &gray),
+              "width %d: file missing its last byte decoded", width);
+        CHECK(*get_last_hdr_error() != '\0', "no error message for a cut file");
+    }
+}
+
+void test_corrupt_runs() {
+    // One 8-pixel scanline, each channel a single run.
+    const std::vector<unsigned char> valid = {2, 2, 0, 8, 0x88, 10, 0x88, 20, 0x88, 30, 0x88, 130};
+    const struct {
+        const char *what;
+        std::vector<unsigned char> data;
+    } corrupt[] = {
+        {"run past the scanline", {2, 2, 0, 8, 0x89, 10, 0x88, 20, 0x88, 30, 0x88, 130}},
+        {"runs adding up past the scanline", {2, 2, 0, 8, 0x85, 10, 0x84, 11, 0x88, 20, 0x88, 30, 0x88, 130}},
+        {"zero-length literal", {2, 2, 0, 8, 0x00, 10, 0x88, 20, 0x88, 30, 0x88, 130}},
+        {"literal past the scanline", {2, 2, 0, 8, 0x04, 1, 2, 3, 4, 0x05, 1, 2, 3, 4, 5, 0x88, 20, 0x88, 30, 0x88, 130}},
+        {"literal past the data", {2, 2, 0, 8, 0x88, 10, 0x88, 20, 0x88, 30, 0x08, 1, 2, 3}},
+        {"exponent channel missing", {2, 2, 0, 8, 0x88, 10, 0x88, 20, 0x88, 30}},
+    };
+
+    std::vector<size_t> offsets;
+    int flat_from = -1;
+    std::vector<unsigned char> scanline(8 * 4);
+    CHECK(find_scanlines(valid.data(), valid.size(), 8, 1, offsets, flat_from) && flat_from == 1 && offsets[1] == valid.size(),
+          "valid scanline not located");
+    CHECK(RGBE_DecodeScanline(valid.data(), valid.size(), 0, scanline.data(), 8) == 0, "valid scanline not decoded");
+    for (int i = 0; i < 32; ++i)
+        CHECK(scanline[i] == valid[5 + i / 8 * 2], "valid scanline byte %d is %d", i, scanline[i]);
+
+    for (const auto &c : corrupt) {
+        CHECK(!find_scanlines(c.data.data(), c.data.size(), 8, 1, offsets, flat_from), "%s located", c.what);
+        CHECK(RGBE_DecodeScanline(c.data.data(), c.data.size(), 0, scanline.data(), 8) < 0, "%s decoded", c.what);
+    }
+
+    std::vector<unsigned char> wrong_width = valid;
+    wrong_width[3] = 9;
+    CHECK(!find_scanlines(wrong_width.data(), wrong_width.size(), 8, 1, offsets, flat_from), "wrong scanline width located");
+}
+
+/* load_hdr_pixels_from_memory into float RGBA against the serial reader on the same bytes. */
+void test_matches_serial(int width, int height, int rle_rows) {
+    HdrFile file = write_hdr(width, height, rle_rows);
+
+    std::vector<float> expected(static_cast<size_t>(width) * height * 3);
+    FILE *f = std::tmpfile();
+    CHECK(f != nullptr, "tmpfile failed");
+    if (!f)
+        return;
+    std::fwrite(file.bytes.data(), 1, file.bytes.size(), f);
+    std::fseek(f, static_cast<long>(file.header_size), SEEK_SET);
+    CHECK(RGBE_ReadPixels_RLE(f, expected.data(), width, height) == RGBE_RETURN_SUCCESS, "%dx%d: serial read failed", width,
+          height);
+    std::fclose(f);
+
+    std::vector<float> pixels(static_cast<size_t>(width) * height * 4);
+    lyra_decode_target target{pixels.data(), width, height, width * 16, LYRA_PIXEL_RGBA_F32};
+    lyra_decode_control control{};
+    bool gray = true;
+    CHECK(load_hdr_pixels_from_memory(file.bytes.data(), file.bytes.size(), &target, &control, &gray), "%dx%d: %s", width,
+          height, get_last_hdr_error());
+    CHECK(!gray, "%dx%d reported as grayscale", width, height);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+        bool same = std::memcmp(&pixels[i * 4], &expected[i * 3], 3 * sizeof(float)) == 0 && pixels[i * 4 + 3] == 1.0f;
+        if (!same && ++mismatches <= 5)
+            std::fprintf(stderr, "%dx%d: pixel (%zu, %zu) differs from the serial reader\n", width, height, i % width, i / width);
+    }
+    CHECK(mismatches == 0, "%dx%d (%d RLE rows): %d pixels differ", width, height, rle_rows, mismatches);
+}
+
+} // namespace
+
+int main() {
+    test_locate_rle();
+    test_locate_flat();
+    test_locate_flat_tail();
+    test_truncated();
+    test_corrupt_runs();
+    test_matches_serial(300, 257, 257);
+    test_matches_serial(7, 33, 33);
+    test_matches_serial(64, 100, 40);
+    test_matches_serial(2048, 300, 300);
+    return lyra::test::test_result();
+}
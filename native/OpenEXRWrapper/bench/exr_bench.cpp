@@ -0,0 +1,209 @@
+/* OpenEXR decode benchmark. Writes a deterministic corpus with the OpenEXR writers (half RGBA
+ * scanline files in several compressions, a float file and a tiled file at each size), then
+ * times every stage of exr_native against it:
+ *
+ *   header      probe_exr, header parse only
+ *   decompress  Imf::InputFile::readPixels into the stored channel types, no conversion
+ *   rgba8/f16/f32  full decode into each target layout (decompress + layout conversion)
+ *   preview     box-filtered preview at a quarter of the width
+ *
+ * Tone mapping is format independent and measured by hdr_bench. Results go to stdout or
+ * --out as JSON; see bench_harness.h for the options. */
+
+#include <OpenEXR/ImfChannelList.h>
+#include <OpenEXR/ImfFrameBuffer.h>
+#include <OpenEXR/ImfHeader.h>
+#include <OpenEXR/ImfInputFile.h>
+#include <OpenEXR/ImfOutputFile.h>
+#include <OpenEXR/ImfThreading.h>
+#include <OpenEXR/ImfTiledOutputFile.h>
+
+#include <memory>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+#include "bench/bench_harness.h"
+#include "lyra_decode.h"
+#include "pixel_kernels.h"
+
+extern "C" {
+const char *get_last_exr_error();
+bool probe_exr(const char *path, lyra_image_probe *probe);
+bool load_exr_pixels(const char *path, const lyra_decode_target *target, const lyra_decode_control *control, bool *is_grayscale);
+bool read_exr_preview_size(const char *path, int max_width, int max_height, int *width, int *height);
+bool load_exr_preview(const char *path, int max_width, int max_height, const lyra_decode_target *target,
+                      const lyra_decode_control *control, bool *is_grayscale);
+}
+
+namespace {
+
+using lyra::bench::StageResult;
+
+struct CorpusVariant {
+    const char *name;
+    Imf::Compression compression;
+    Imf::PixelType type;
+    bool tiled;
+};
+
+const CorpusVariant variants[] = {
+    {"none", Imf::NO_COMPRESSION, Imf::HALF, false},
+    {"zip", Imf::ZIP_COMPRESSION, Imf::HALF, false},
+    {"piz", Imf::PIZ_COMPRESSION, Imf::HALF, false},
+    {"dwaa", Imf::DWAA_COMPRESSION, Imf::HALF, false},
+    {"zip_float", Imf::ZIP_COMPRESSION, Imf::FLOAT, false},
+    {"zip_tiled64", Imf::ZIP_COMPRESSION, Imf::HALF, true},
+};
+
+const char *const rgba_names[4] = {"R", "G", "B", "A"};
+
+std::string last_error() {
+    const char *error = get_last_exr_error();
+    return error && *error ? error : "unknown error";
+}
+
+bool file_exists(const std::string &path) {
+    struct stat st {};
+    return stat(path.c_str(), &st) == 0 && st.st_size > 0;
+}
+
+void write_exr(const std::string &path, int width, int height, const CorpusVariant &variant) {
+    std::vector<float> rgba(static_cast<size_t>(width) * height * 4);
+    lyra::bench::fill_test_pattern(rgba.data(), width, height, 4);
+
+    // Interleaved RGBA in the stored type; slices point into it with a 4-sample x stride.
+    const size_t sample = variant.type == Imf::FLOAT ? sizeof(float) : sizeof(uint16_t);
+    std::vector<uint16_t> halves;
+    char *base = reinterpret_cast<char *>(rgba.data());
+    if (variant.type == Imf::HALF) {
+        halves.resize(rgba.size());
+        for (size_t i = 0; i < rgba.size(); ++i)
+            halves[i] = lyra::float_to_half(rgba[i]);
+        base = reinterpret_cast<char *>(halves.data());
+    }
+
+    Imf::Header header(width, height);
+    header.compression() = variant.compression;
+    Imf::FrameBuffer frame;
+    for (int c = 0; c < 4; ++c) {
+        header.channels().insert(rgba_names[c], Imf::Channel(variant.type));
+        frame.insert(rgba_names[c], Imf::Slice(variant.type, base + c * sample, 4 * sample, 4 * sample * width));
+    }
+
+    if (variant.tiled) {
+        header.setTileDescription(Imf::TileDescription(64, 64, Imf::ONE_LEVEL));
+        Imf::TiledOutputFile file(path.c_str(), header);
+        file.setFrameBuffer(frame);
+        file.writeTiles(0, file.numXTiles() - 1, 0, file.numYTiles() - 1);
+    } else {
+        Imf::OutputFile file(path.c_str(), header);
+        file.setFrameBuffer(frame);
+        file.writePixels(height);
+    }
+}
+
+/* Reads all RGBA channels in their stored types: the OpenEXR cost the wrapper cannot avoid. */
+bool decompress_only(const char *path, int width, int height, std::vector<char> &buffer) {
+    Imf::InputFile file(path);
+    const Imf::ChannelList &channels = file.header().channels();
+    const size_t stride = 4 * sizeof(float);
+    buffer.resize(static_cast<size_t>(width) * height * stride);
+
+    Imath::Box2i dw = file.header().dataWindow();
+    char *origin = buffer.data() - (static_cast<ptrdiff_t>(dw.min.y) * width + dw.min.x) * static_cast<ptrdiff_t>(stride);
+    Imf::FrameBuffer frame;
+    for (int c = 0; c < 4; ++c) {
+        const Imf::Channel *channel = channels.findChannel(rgba_names[c]);
+        if (channel)
+            frame.insert(rgba_names[c], Imf::Slice(channel->type, origin + c * sizeof(float), stride, stride * width));
+    }
+
+    file.setFrameBuffer(frame);
+    file.readPixels(dw.min.y, dw.max.y);
+    return true;
+}
+
+struct Pixels {
+    std::vector<uint8_t> data;
+    lyra_decode_target target{};
+
+    Pixels(int width, int height, int format, int bytes_per_pixel)
+        : data(static_cast<size_t>(width) * height * bytes_per_pixel) {
+        target = {data.data(), width, height, width * bytes_per_pixel, format};
+    }
+};
+
+void bench_file(const lyra::bench::Options &options, const std::string &path, const std::string &name, int width,
+                int height, std::vector<StageResult> &results) {
+    const int n = options.iterations;
+    const char *p = path.c_str();
+    bool gray = false;
+
+    results.push_back(lyra::bench::run_stage(name, "header", width, height, n, [&] {
+        lyra_image_probe probe{};
+        return probe_exr(p, &probe);
+    }, last_error));
+
+    std::vector<char> buffer;
+    results.push_back(lyra::bench::run_stage(name, "decompress", width, height, n, [&] {
+        return decompress_only(p, width, height, buffer);
+    }, [] { return std::string("readPixels failed"); }));
+    std::vector<char>().swap(buffer);
+
+    const struct {
+        const char *stage;
+        int format;
+        int bytes;
+    } layouts[] = {{"rgba8", LYRA_PIXEL_RGBA8, 4}, {"f16", LYRA_PIXEL_RGBA_F16, 8}, {"f32", LYRA_PIXEL_RGBA_F32, 16}};
+
+    for (const auto &layout : layouts) {
+        auto pixels = std::make_unique<Pixels>(width, height, layout.format, layout.bytes);
+        results.push_back(lyra::bench::run_stage(name, layout.stage, width, height, n, [&] {
+            return load_exr_pixels(p, &pixels->target, nullptr, &gray);
+        }, last_error));
+    }
+
+    int pw = 0, ph = 0;
+    const int max_w = std::max(16, width / 4), max_h = std::max(16, height / 4);
+    if (read_exr_preview_size(p, max_w, max_h, &pw, &ph)) {
+        auto preview = std::make_unique<Pixels>(pw, ph, LYRA_PIXEL_RGBA8, 4);
+        results.push_back(lyra::bench::run_stage(name, "preview", width, height, n, [&] {
+            return load_exr_preview(p, max_w, max_h, &preview->target, nullptr, &gray);
+        }, last_error));
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        lyra::bench::Options options = lyra::bench::parse_options(argc, argv);
+#if defined(_WIN32)
+        _mkdir(options.corpus.c_str());
+#else
+        mkdir(options.corpus.c_str(), 0755);
+#endif
+        // Same pool size the wrapper uses, so "decompress" is comparable with the full decodes.
+        Imf::setGlobalThreadCount(static_cast<int>(lyra::hardware_threads()));
+
+        std::vector<StageResult> results;
+        for (int width : options.sizes) {
+            int height = width / 2;
+            for (const CorpusVariant &variant : variants) {
+                std::string name = "exr_" + std::to_string(width) + "x" + std::to_string(height) + "_" + variant.name + ".exr";
+                std::string path = options.corpus + "/" + name;
+                if (!file_exists(path))
+                    write_exr(path, width, height, variant);
+
+                bench_file(options, path, name, width, height, results);
+            }
+        }
+
+        lyra::bench::write_json(options, "exr_native", results);
+        return 0;
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "exr_bench: %s\n", ex.what());
+        return 1;
+    }
+}
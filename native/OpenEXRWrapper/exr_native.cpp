@@ -1,12 +1,35 @@
-#include <OpenEXR/ImfArray.h>
+#include <OpenEXR/Iex.h>
+#include <OpenEXR/IlmThreadPool.h>
+#include <OpenEXR/ImfChannelList.h>
+#include <OpenEXR/ImfFrameBuffer.h>
+#include <OpenEXR/ImfHeader.h>
+#include <OpenEXR/ImfIO.h>
+#include <OpenEXR/ImfInputFile.h>
+#include <OpenEXR/ImfInputPart.h>
+#include <OpenEXR/ImfMultiPartInputFile.h>
+#include <OpenEXR/ImfPartType.h>
 #include <OpenEXR/ImfRgba.h>
 #include <OpenEXR/ImfRgbaFile.h>
-#include <OpenEXR/ImfThreading.h>
+#include <OpenEXR/ImfTiledInputFile.h>
+#include <OpenEXR/OpenEXRConfig.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <memory>
 #include <mutex>
-#include <thread>
-#include <unordered_set>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "decode_control.h"
+#include "lyra_decode.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "preview.h"
+#include "pixel_kernels.h"
+#include "scratch_pool.h"
 
 #ifdef _WIN32
 #define EXR_API __declspec(dllexport)
@@ -21,84 +44,1180 @@
 #endif
 
 static THREAD_LOCAL char last_exr_error[512] = "";
-static std::unordered_set<void *> exr_allocated_ptrs;
-static std::mutex exr_alloc_mutex;
 
-extern "C" {
+// Scanlines read per band when converting into the target. A multiple of every
+// standard line-block height (1/16/32/256), so bands never split a chunk.
+static constexpr int exr_band_rows = 256;
 
-EXR_API const char *get_last_exr_error() { return last_exr_error; }
+// OpenEXR's line-buffer and tile tasks run on lyra's shared worker pool instead of IlmThread's own
+// threads, so they count against the budget of the decode that queued them and a foreground decode
+// takes threads back from background ones. A file's thread count only sizes how many chunks it keeps
+// in flight; the budget decides how many of them run at once.
+class ExrTaskProvider : public IlmThread::ThreadPoolProvider {
+public:
+    int numThreads() const override { return static_cast<int>(lyra::hardware_threads()); }
+    void setNumThreads(int) override {}
+    void addTask(IlmThread::Task *task) override { tasks_.submit(run, task); }
+    void finish() override { tasks_.finish(); }
+
+private:
+    static void run(void *arg) {
+        auto *task = static_cast<IlmThread::Task *>(arg);
+        task->execute();
+        delete task;
+    }
+
+    lyra::TaskGroup tasks_; // only this provider's tasks, so finish() never waits on other libraries
+};
 
-EXR_API bool load_exr_rgba(const char *path, float **out_pixels, int *width, int *height) {
+static void init_exr_threads() {
     static std::once_flag exr_init_flag;
     std::call_once(exr_init_flag, []() {
-        unsigned n = std::thread::hardware_concurrency();
-        Imf::setGlobalThreadCount(n ? static_cast<int>(n) : 1);
-        printf("[EXR] Using %u threads for OpenEXR\n", n);
+        IlmThread::ThreadPool::globalThreadPool().setThreadProvider(new ExrTaskProvider());
+    });
+}
+
+// OpenEXR 3.3 reads chunks from several threads at once when the stream supports offset reads.
+#if OPENEXR_VERSION_MAJOR > 3 || (OPENEXR_VERSION_MAJOR == 3 && OPENEXR_VERSION_MINOR >= 3)
+#define LYRA_EXR_STATELESS_READ 1
+#endif
+
+// Encoded EXR bytes: a mapped file or a caller's buffer. `name` only labels OpenEXR's messages.
+struct ExrBytes {
+    const char *name;
+    const unsigned char *data;
+    size_t size;
+};
+
+// Imf::IStream over bytes already in memory. OpenEXR takes chunks straight out of the buffer
+// (readMemoryMapped, or offset reads on 3.3+) instead of copying them through std::ifstream, so
+// a mapped file is decompressed directly from the page cache. Several streams may share one buffer.
+class ExrMemoryStream : public Imf::IStream {
+public:
+    explicit ExrMemoryStream(const ExrBytes &bytes)
+        : Imf::IStream(bytes.name), data_(reinterpret_cast<const char *>(bytes.data)), size_(bytes.size) {}
+
+    bool isMemoryMapped() const override { return true; }
+
+    bool read(char c[], int n) override {
+        memcpy(c, take(n), static_cast<size_t>(n));
+        return pos_ < size_;
+    }
+
+    // OpenEXR only reads through the returned pointer; the mapping itself is read-only.
+    char *readMemoryMapped(int n) override { return const_cast<char *>(take(n)); }
+
+    uint64_t tellg() override { return pos_; }
+    void seekg(uint64_t pos) override { pos_ = pos; }
+    void clear() override {}
+
+#ifdef LYRA_EXR_STATELESS_READ
+    int64_t size() override { return static_cast<int64_t>(size_); }
+    bool isStatelessRead() const override { return true; }
+
+    int64_t read(void *buf, uint64_t sz, uint64_t offset) override {
+        if (offset >= size_)
+            return 0;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(sz, size_ - offset));
+        memcpy(buf, data_ + offset, n);
+        return static_cast<int64_t>(n);
+    }
+#endif
+
+private:
+    const char *take(int n) {
+        if (n < 0 || pos_ > size_ || static_cast<uint64_t>(n) > size_ - pos_)
+            throw Iex::InputExc("Unexpected end of file.");
+        const char *p = data_ + pos_;
+        pos_ += static_cast<uint64_t>(n);
+        return p;
+    }
+
+    const char *data_;
+    uint64_t size_;
+    uint64_t pos_ = 0;
+};
+
+// A file mapped for reading plus the stream OpenEXR reads it through. Must outlive the Imf file
+// opened on stream(); files opened later on bytes() share the same mapping.
+class ExrMappedFile {
+public:
+    explicit ExrMappedFile(const char *path) {
+        if (!file_.open(path))
+            throw std::runtime_error("Failed to open EXR file.");
+        bytes_ = {path, file_.data(), file_.size()};
+        stream_.reset(new ExrMemoryStream(bytes_));
+    }
+
+    const ExrBytes &bytes() const { return bytes_; }
+    ExrMemoryStream &stream() { return *stream_; }
+
+private:
+    lyra::MappedFile file_;
+    ExrBytes bytes_{};
+    std::unique_ptr<ExrMemoryStream> stream_;
+};
+
+// File channels feeding the R/G/B/A output slots; nullptr slots are filled with defaults.
+struct ExrRgbaChannels {
+    const char *names[4] = {nullptr, nullptr, nullptr, nullptr};
+    bool all_half = true;       // every present channel is stored as HALF
+    bool needs_rgba_file = false; // luminance/chroma or subsampled data only RgbaInputFile reconstructs
+};
+
+static ExrRgbaChannels select_rgba_channels(const Imf::ChannelList &channels) {
+    static const char *const rgba[4] = {"R", "G", "B", "A"};
+    ExrRgbaChannels sel;
+
+    for (int c = 0; c < 4; ++c) {
+        if (channels.findChannel(rgba[c]))
+            sel.names[c] = rgba[c];
+    }
+
+    // Luminance-only images map Y to R; the empty G/B slots mark them as grayscale.
+    if (!sel.names[0] && !sel.names[1] && !sel.names[2] && channels.findChannel("Y"))
+        sel.names[0] = "Y";
+
+    if (channels.findChannel("RY") || channels.findChannel("BY"))
+        sel.needs_rgba_file = true;
+
+    for (const char *name : sel.names) {
+        if (!name)
+            continue;
+
+        const Imf::Channel *ch = channels.findChannel(name);
+        if (ch->type != Imf::HALF)
+            sel.all_half = false;
+        if (ch->xSampling != 1 || ch->ySampling != 1)
+            sel.needs_rgba_file = true;
+    }
+
+    return sel;
+}
+
+// Binds the four output slots to interleaved memory at `base` (already offset for the data window).
+static void insert_rgba_slices(Imf::FrameBuffer &fb, const ExrRgbaChannels &sel, Imf::PixelType type,
+                               char *base, size_t x_stride, size_t y_stride) {
+    static const char *const slots[4] = {"R", "G", "B", "A"};
+    size_t sample = type == Imf::HALF ? 2 : 4;
+
+    for (int c = 0; c < 4; ++c) {
+        const char *name = sel.names[c] ? sel.names[c] : slots[c];
+        fb.insert(name, Imf::Slice(type, base + c * sample, x_stride, y_stride, 1, 1, c == 3 ? 1.0 : 0.0));
+    }
+}
+
+// Clears `gray` when any of target rows [y0, y1) of a float target carries G or B, and adds
+// the rows to `image_stats` when those are collected.
+static void check_gray_rows(const lyra_decode_target *target, int y0, int y1, std::atomic<bool> &gray,
+                            lyra::DecodeStats *stats, lyra::ImageStats *image_stats) {
+    bool collect = image_stats && image_stats->enabled();
+    if (!gray.load(std::memory_order_relaxed) && !collect)
+        return;
+
+    const auto *dst = static_cast<const char *>(target->pixels);
+    lyra::parallel_for_rows(y1 - y0, 16, [&](int r0, int r1) {
+        lyra::StageTimer timer(stats, lyra::DecodeStats::convert);
+        lyra::ImageStatsRows image_rows(image_stats);
+        for (int r = r0; r < r1; ++r) {
+            const char *row = dst + static_cast<size_t>(y0 + r) * target->stride;
+            if (gray.load(std::memory_order_relaxed) && !lyra::is_gray_row(row, target->format, target->width))
+                gray.store(false, std::memory_order_relaxed);
+            else if (!collect && !gray.load(std::memory_order_relaxed))
+                break;
+            image_rows.add_target_row(row, target->format, target->width);
+        }
+    });
+}
+
+// Converts `rows` rows of an interleaved RGBA band (HALF or FLOAT samples) into target rows from dst_y.
+static void convert_band_rows(const char *band, Imf::PixelType band_type, size_t band_stride, int rows,
+                              const lyra_decode_target *target, int dst_y, std::atomic<bool> &gray,
+                              lyra::DecodeStats *stats, lyra::ImageStats *image_stats) {
+    auto *dst = static_cast<char *>(target->pixels);
+    lyra::parallel_for_rows(rows, 16, [&](int r0, int r1) {
+        lyra::StageTimer timer(stats, lyra::DecodeStats::conversion_stage(target->format));
+        lyra::ImageStatsRows image_rows(image_stats);
+        for (int r = r0; r < r1; ++r) {
+            const char *src = band + static_cast<size_t>(r) * band_stride;
+            char *row = dst + static_cast<size_t>(dst_y + r) * target->stride;
+            if (band_type == Imf::HALF)
+                image_rows.add_half_row(reinterpret_cast<const uint16_t *>(src), target->width);
+            else
+                image_rows.add_float_row(reinterpret_cast<const float *>(src), 4, target->width);
+            bool check = gray.load(std::memory_order_relaxed);
+            bool row_gray = band_type == Imf::HALF
+                ? lyra::half_rgba_to_row(reinterpret_cast<const uint16_t *>(src), row, target->format, target->width, check)
+                : lyra::float_to_row(reinterpret_cast<const float *>(src), 4, row, target->format, target->width, check);
+            if (!row_gray)
+                gray.store(false, std::memory_order_relaxed);
+        }
     });
+}
+
+static bool is_float_format(int format) {
+    return format == LYRA_PIXEL_RGBA_F32 || format == LYRA_PIXEL_RGBA_F16;
+}
+
+// Band type for RGBA8 targets: the narrowest type that holds the file's data.
+static Imf::PixelType band_pixel_type(const ExrRgbaChannels &sel) {
+    return sel.all_half ? Imf::HALF : Imf::FLOAT;
+}
+
+// Reads channels in their stored precision through Imf::InputFile. Float and half targets receive
+// the samples directly via slice strides; RGBA8 targets go through one band buffer of the narrowest
+// type that holds the file's data (half, or float for FLOAT/UINT channels). Target row 0 is data
+// window row `first_row`. Works on Imf::InputFile and Imf::InputPart alike.
+template <typename InputFileT>
+static void read_exr_framebuffer(InputFileT &file, const ExrRgbaChannels &sel, int first_row, const lyra_decode_target *target,
+                                 lyra::DecodeMonitor &monitor, std::atomic<bool> &gray) {
+    Imath::Box2i dw = file.header().dataWindow();
+    int top = dw.min.y + first_row;
+    int w = target->width;
+    int h = target->height;
+    auto *dst = static_cast<char *>(target->pixels);
+    int format = target->format;
+    int band_rows = std::min(exr_band_rows, h);
+    auto *stats = monitor.stats();
+
+    if (is_float_format(format)) {
+        // OpenEXR converts between HALF/FLOAT/UINT while filling the slices.
+        Imf::PixelType type = format == LYRA_PIXEL_RGBA_F32 ? Imf::FLOAT : Imf::HALF;
+        size_t px = lyra::bytes_per_pixel(format);
+        Imf::FrameBuffer fb;
+        char *base = dst - static_cast<ptrdiff_t>(dw.min.x) * px - static_cast<ptrdiff_t>(top) * target->stride;
+        insert_rgba_slices(fb, sel, type, base, px, target->stride);
+        file.setFrameBuffer(fb);
+
+        for (int y0 = 0; y0 < h; y0 += band_rows) {
+            int y1 = std::min(y0 + band_rows, h);
+            {
+                lyra::StageTimer timer(stats, lyra::DecodeStats::decompress);
+                file.readPixels(top + y0, top + y1 - 1);
+            }
+            monitor.advance(y1 - y0);
+
+            // Check the band while it is still hot in cache.
+            check_gray_rows(target, y0, y1, gray, stats, monitor.image_stats());
+        }
+        return;
+    }
+
+    Imf::PixelType band_type = band_pixel_type(sel);
+    size_t band_px = band_type == Imf::HALF ? 8 : 16;
+    size_t band_stride = band_px * w;
+    lyra::ScratchBuffer scratch(monitor.scratch_pool(), band_stride * band_rows, stats);
+    auto *band = scratch.as<char>();
+
+    for (int y0 = 0; y0 < h; y0 += band_rows) {
+        int y1 = std::min(y0 + band_rows, h);
+
+        Imf::FrameBuffer fb;
+        char *base = band - static_cast<ptrdiff_t>(dw.min.x) * band_px - static_cast<ptrdiff_t>(top + y0) * band_stride;
+        insert_rgba_slices(fb, sel, band_type, base, band_px, band_stride);
+        file.setFrameBuffer(fb);
+        {
+            lyra::StageTimer timer(stats, lyra::DecodeStats::decompress);
+            file.readPixels(top + y0, top + y1 - 1);
+        }
+
+        convert_band_rows(band, band_type, band_stride, y1 - y0, target, y0, gray, stats, monitor.image_stats());
+        monitor.advance(y1 - y0);
+    }
+}
+
+// Luminance/chroma images: RgbaInputFile performs the YC -> RGB reconstruction in half precision.
+static void read_exr_rgba_file(const ExrBytes &bytes, const lyra_decode_target *target, lyra::DecodeMonitor &monitor,
+                               std::atomic<bool> &gray) {
+    auto *stats = monitor.stats();
+    lyra::StageTimer open_timer(stats, lyra::DecodeStats::open);
+    ExrMemoryStream stream(bytes);
+    Imf::RgbaInputFile file(stream, lyra::budget_threads());
+    open_timer.stop();
+
+    Imath::Box2i dw = file.dataWindow();
+    int w = target->width;
+    int h = target->height;
+    auto *dst = static_cast<uint8_t *>(target->pixels);
+    int format = target->format;
+
+    int band_rows = std::min(exr_band_rows, h);
+    lyra::ScratchBuffer scratch(monitor.scratch_pool(), static_cast<size_t>(band_rows) * w * sizeof(Imf::Rgba), stats);
+    auto *band = scratch.as<Imf::Rgba>();
+
+    for (int y0 = 0; y0 < h; y0 += band_rows) {
+        int y1 = std::min(y0 + band_rows, h);
+
+        file.setFrameBuffer(band - dw.min.x - static_cast<ptrdiff_t>(dw.min.y + y0) * w, 1, w);
+        {
+            lyra::StageTimer timer(stats, lyra::DecodeStats::decompress);
+            file.readPixels(dw.min.y + y0, dw.min.y + y1 - 1);
+        }
+
+        lyra::parallel_for_rows(y1 - y0, 16, [&](int r0, int r1) {
+            lyra::StageTimer timer(stats, lyra::DecodeStats::conversion_stage(format));
+            lyra::ImageStatsRows image_rows(monitor.image_stats());
+            for (int r = r0; r < r1; ++r) {
+                const auto *src = reinterpret_cast<const uint16_t *>(band + static_cast<size_t>(r) * w);
+                uint8_t *row = dst + static_cast<size_t>(y0 + r) * target->stride;
+                image_rows.add_half_row(src, w);
+                if (!lyra::half_rgba_to_row(src, row, format, w, gray.load(std::memory_order_relaxed)))
+                    gray.store(false, std::memory_order_relaxed);
+            }
+        });
+        monitor.advance(y1 - y0);
+    }
+}
+
+// Box-filters the image down by an integer factor while bands stream in. Bands hold whole preview
+// rows (a multiple of `factor` scanlines) so workers can each filter their own preview rows.
+static void read_exr_preview(const ExrBytes &bytes, Imf::InputFile &file, const ExrRgbaChannels &sel, int factor,
+                             const lyra_decode_target *target, lyra::DecodeMonitor &monitor, std::atomic<bool> &gray) {
+    Imath::Box2i dw = file.header().dataWindow();
+    int w = dw.max.x - dw.min.x + 1;
+    int h = dw.max.y - dw.min.y + 1;
+    auto *dst = static_cast<uint8_t *>(target->pixels);
+    int preview_rows = std::max(1, exr_band_rows / factor);
+    int band_rows = std::min(preview_rows * factor, h);
+    size_t band_stride = static_cast<size_t>(w) * 4;
+    auto *stats = monitor.stats();
+
+    // Luminance/chroma files decode through RgbaInputFile in half precision.
+    std::unique_ptr<ExrMemoryStream> rgba_stream;
+    std::unique_ptr<Imf::RgbaInputFile> rgba_file;
+    if (sel.needs_rgba_file) {
+        lyra::StageTimer open_timer(stats, lyra::DecodeStats::open);
+        rgba_stream.reset(new ExrMemoryStream(bytes));
+        rgba_file.reset(new Imf::RgbaInputFile(*rgba_stream, lyra::budget_threads()));
+        open_timer.stop();
+    }
+    // One band buffer, holding half RGBA from RgbaInputFile or float RGBA from InputFile.
+    lyra::ScratchBuffer scratch(monitor.scratch_pool(), rgba_file ? static_cast<size_t>(band_rows) * w * sizeof(Imf::Rgba)
+                                                                  : band_stride * band_rows * sizeof(float), stats);
+    auto *half_band = scratch.as<Imf::Rgba>();
+    auto *band = scratch.as<float>();
+
+    for (int y0 = 0; y0 < h; y0 += band_rows) {
+        int y1 = std::min(y0 + band_rows, h);
+
+        lyra::StageTimer read_timer(stats, lyra::DecodeStats::decompress);
+        if (rgba_file) {
+            rgba_file->setFrameBuffer(half_band - dw.min.x - static_cast<ptrdiff_t>(dw.min.y + y0) * w, 1, w);
+            rgba_file->readPixels(dw.min.y + y0, dw.min.y + y1 - 1);
+        } else {
+            Imf::FrameBuffer fb;
+            char *base = reinterpret_cast<char *>(band) - static_cast<ptrdiff_t>(dw.min.x) * 16 -
+                         static_cast<ptrdiff_t>(dw.min.y + y0) * band_stride * sizeof(float);
+            insert_rgba_slices(fb, sel, Imf::FLOAT, base, 16, band_stride * sizeof(float));
+            file.setFrameBuffer(fb);
+            file.readPixels(dw.min.y + y0, dw.min.y + y1 - 1);
+        }
+        read_timer.stop();
+
+        int py0 = y0 / factor;
+        int py1 = (y1 + factor - 1) / factor;
+        lyra::parallel_for_rows(py1 - py0, 1, [&](int r0, int r1) {
+            lyra::StageTimer timer(stats, lyra::DecodeStats::conversion_stage(target->format));
+            lyra::PreviewRowFilter filter(w, factor);
+            lyra::ScratchBuffer row_scratch(monitor.scratch_pool(), rgba_file ? band_stride * sizeof(float) : 0, stats);
+            auto *converted = row_scratch.as<float>();
+
+            for (int py = py0 + r0; py < py0 + r1; ++py) {
+                int sy1 = std::min((py + 1) * factor, y1);
+                for (int sy = py * factor; sy < sy1; ++sy) {
+                    if (rgba_file) {
+                        const auto *src = reinterpret_cast<const uint16_t *>(half_band + static_cast<size_t>(sy - y0) * w);
+                        lyra::halves_to_floats(src, converted, band_stride);
+                        filter.add_row(converted, 4);
+                    } else {
+                        filter.add_row(band + static_cast<size_t>(sy - y0) * band_stride, 4);
+                    }
+                }
+
+                uint8_t *row = dst + static_cast<size_t>(py) * target->stride;
+                if (!filter.emit(row, target->format, gray.load(std::memory_order_relaxed)))
+                    gray.store(false, std::memory_order_relaxed);
+            }
+        });
+        monitor.advance(y1 - y0);
+    }
+}
+
+static const char *exr_compression_name(Imf::Compression compression) {
+    switch (compression) {
+        case Imf::NO_COMPRESSION: return "none";
+        case Imf::RLE_COMPRESSION: return "rle";
+        case Imf::ZIPS_COMPRESSION: return "zips";
+        case Imf::ZIP_COMPRESSION: return "zip";
+        case Imf::PIZ_COMPRESSION: return "piz";
+        case Imf::PXR24_COMPRESSION: return "pxr24";
+        case Imf::B44_COMPRESSION: return "b44";
+        case Imf::B44A_COMPRESSION: return "b44a";
+        case Imf::DWAA_COMPRESSION: return "dwaa";
+        case Imf::DWAB_COMPRESSION: return "dwab";
+        default: return "unknown";
+    }
+}
+
+static const char *exr_pixel_type_name(Imf::PixelType type) {
+    switch (type) {
+        case Imf::UINT: return "uint";
+        case Imf::HALF: return "half";
+        case Imf::FLOAT: return "float";
+        default: return "unknown";
+    }
+}
+
+// Resolution levels along an axis of `size` pixels, matching OpenEXR's roundLog2(size) + 1.
+static int exr_level_count(int size, Imf::LevelRoundingMode rounding) {
+    int levels = 1;
+    while (size > 1) {
+        size = rounding == Imf::ROUND_UP ? (size + 1) / 2 : size / 2;
+        ++levels;
+    }
+    return levels;
+}
+
+static void fill_exr_probe(const Imf::MultiPartInputFile &file, lyra_image_probe *probe) {
+    const Imf::Header &header = file.header(0);
+    Imath::Box2i dw = header.dataWindow();
+    Imath::Box2i dispw = header.displayWindow();
+
+    memset(probe, 0, sizeof(*probe));
+    probe->width = dw.max.x - dw.min.x + 1;
+    probe->height = dw.max.y - dw.min.y + 1;
+    probe->data_window[0] = dw.min.x;
+    probe->data_window[1] = dw.min.y;
+    probe->data_window[2] = dw.max.x;
+    probe->data_window[3] = dw.max.y;
+    probe->display_window[0] = dispw.min.x;
+    probe->display_window[1] = dispw.min.y;
+    probe->display_window[2] = dispw.max.x;
+    probe->display_window[3] = dispw.max.y;
+    probe->part_count = file.parts();
+    snprintf(probe->compression, sizeof(probe->compression), "%s", exr_compression_name(header.compression()));
+
+    size_t used = 0;
+    for (Imf::ChannelList::ConstIterator it = header.channels().begin(); it != header.channels().end(); ++it) {
+        ++probe->channel_count;
+        probe->stored_bytes_per_pixel += it.channel().type == Imf::HALF ? 2 : 4;
+
+        int n = snprintf(probe->channels + used, sizeof(probe->channels) - used, "%s%s:%s",
+                         used ? ";" : "", it.name(), exr_pixel_type_name(it.channel().type));
+        if (n < 0 || used + n >= sizeof(probe->channels))
+            used = sizeof(probe->channels) - 1; // truncated; later channels are still counted
+        else
+            used += n;
+    }
+
+    probe->level_count = 1;
+    if (header.hasTileDescription()) {
+        const Imf::TileDescription &td = header.tileDescription();
+        probe->tiled = 1;
+        probe->tile_width = static_cast<int>(td.xSize);
+        probe->tile_height = static_cast<int>(td.ySize);
+        if (td.mode == Imf::MIPMAP_LEVELS || td.mode == Imf::RIPMAP_LEVELS) {
+            probe->level_mode = td.mode == Imf::MIPMAP_LEVELS ? LYRA_LEVELS_MIPMAP : LYRA_LEVELS_RIPMAP;
+            probe->level_count = exr_level_count(std::max(probe->width, probe->height), td.roundingMode);
+        }
+    }
+}
+
+// Display slot for a channel name suffix: R/X/U -> 0, G/Y/V -> 1, B/Z/W -> 2, A -> 3, anything else -1.
+static int exr_channel_slot(const std::string &suffix) {
+    if (suffix.size() != 1)
+        return -1;
+
+    switch (suffix[0]) {
+        case 'R': case 'r': case 'X': case 'x': case 'U': case 'u': return 0;
+        case 'G': case 'g': case 'Y': case 'y': case 'V': case 'v': return 1;
+        case 'B': case 'b': case 'Z': case 'z': case 'W': case 'w': return 2;
+        case 'A': case 'a': return 3;
+        default: return -1;
+    }
+}
+
+// Fills one layer entry from its full-resolution channels. A lone channel goes to R (shown as gray);
+// otherwise channels take their suffix's slot and the rest fill free colour slots, never alpha.
+static void add_exr_layer(const Imf::Header &header, int part, const std::string &layer, const std::vector<std::string> &names,
+                          std::vector<lyra_image_layer> &layers) {
+    if (names.empty())
+        return;
+
+    std::string slots[4];
+    std::vector<const std::string *> rest;
+    for (const std::string &name : names) {
+        int slot = names.size() == 1 ? 0 : exr_channel_slot(layer.empty() ? name : name.substr(layer.size() + 1));
+        if (slot >= 0 && slots[slot].empty())
+            slots[slot] = name;
+        else
+            rest.push_back(&name);
+    }
+
+    for (const std::string *name : rest) {
+        for (int slot = 0; slot < 3; ++slot) {
+            if (slots[slot].empty()) {
+                slots[slot] = *name;
+                break;
+            }
+        }
+    }
+
+    std::string channels;
+    int last = 3;
+    while (last > 0 && slots[last].empty())
+        --last;
+    for (int slot = 0; slot <= last; ++slot)
+        channels += (slot ? ";" : "") + slots[slot];
+
+    Imath::Box2i dw = header.dataWindow();
+    lyra_image_layer entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.part = part;
+    entry.width = dw.max.x - dw.min.x + 1;
+    entry.height = dw.max.y - dw.min.y + 1;
+    entry.channel_count = static_cast<int>(names.size());
+    snprintf(entry.part_name, sizeof(entry.part_name), "%s", header.hasName() ? header.name().c_str() : "");
+    snprintf(entry.name, sizeof(entry.name), "%s", layer.c_str());
+    snprintf(entry.channels, sizeof(entry.channels), "%s", channels.c_str());
+    layers.push_back(entry);
+}
+
+// Lists every layer of every non-deep part: the part's default layer (channels without a '.') first,
+// then its named layers. Subsampled channels (luminance/chroma) are left out.
+static std::vector<lyra_image_layer> collect_exr_layers(const Imf::MultiPartInputFile &file) {
+    std::vector<lyra_image_layer> layers;
+
+    for (int part = 0; part < file.parts(); ++part) {
+        const Imf::Header &header = file.header(part);
+        if (header.hasType() && Imf::isDeepData(header.type()))
+            continue;
+
+        const Imf::ChannelList &channels = header.channels();
+        std::vector<std::string> names;
+        for (Imf::ChannelList::ConstIterator it = channels.begin(); it != channels.end(); ++it) {
+            if (!strchr(it.name(), '.') && it.channel().xSampling == 1 && it.channel().ySampling == 1)
+                names.emplace_back(it.name());
+        }
+        add_exr_layer(header, part, std::string(), names, layers);
+
+        std::set<std::string> layer_names;
+        channels.layers(layer_names);
+        for (const std::string &layer : layer_names) {
+            Imf::ChannelList::ConstIterator first, last;
+            channels.channelsInLayer(layer, first, last);
+
+            names.clear();
+            for (Imf::ChannelList::ConstIterator it = first; it != last; ++it) {
+                // channelsInLayer("a") also yields "a.b.R"; those belong to layer "a.b".
+                if (!strchr(it.name() + layer.size() + 1, '.') && it.channel().xSampling == 1 && it.channel().ySampling == 1)
+                    names.emplace_back(it.name());
+            }
+            add_exr_layer(header, part, layer, names, layers);
+        }
+    }
+    return layers;
+}
+
+// Maps a layer's ';'-separated slot list onto RGBA slots of `header`. `storage` keeps the names alive.
+static ExrRgbaChannels select_layer_channels(const Imf::Header &header, const char *channels, std::string (&storage)[4]) {
+    ExrRgbaChannels sel;
+    const char *p = channels;
+    for (int slot = 0; slot < 4 && *p; ++slot) {
+        const char *end = strchr(p, ';');
+        storage[slot].assign(p, end ? static_cast<size_t>(end - p) : strlen(p));
+        p = end ? end + 1 : p + strlen(p);
+
+        if (storage[slot].empty())
+            continue;
+
+        const Imf::Channel *ch = header.channels().findChannel(storage[slot]);
+        if (!ch)
+            throw std::runtime_error("channel '" + storage[slot] + "' not found");
+        if (ch->xSampling != 1 || ch->ySampling != 1)
+            throw std::runtime_error("channel '" + storage[slot] + "' is subsampled");
+
+        sel.names[slot] = storage[slot].c_str();
+        if (ch->type != Imf::HALF)
+            sel.all_half = false;
+    }
+    return sel;
+}
+
+// Readers outlive any one read, so they are opened for the widest grant and each read's ThreadBudget
+// decides how many of the queued chunks actually run (see ExrTaskProvider).
+static int exr_reader_threads() {
+    return static_cast<int>(lyra::hardware_threads());
+}
+
+// Open scanline (or single-level tiled) file plus its channel mapping, for reading bands in any order.
+struct ExrScanlineReader {
+    ExrMappedFile mapped;
+    Imf::InputFile file;
+    ExrRgbaChannels channels;
+    std::mutex mutex;
+
+    explicit ExrScanlineReader(const char *path)
+        : mapped(path), file(mapped.stream(), exr_reader_threads()), channels(select_rgba_channels(file.header().channels())) {}
+};
+
+// Open tiled file plus its channel mapping. OpenEXR frame buffers are per file, so reads are serialised.
+struct ExrTiledReader {
+    ExrMappedFile mapped;
+    Imf::TiledInputFile file;
+    ExrRgbaChannels channels;
+    std::mutex mutex;
+
+    explicit ExrTiledReader(const char *path)
+        : mapped(path), file(mapped.stream(), exr_reader_threads()), channels(select_rgba_channels(file.header().channels())) {}
+
+    // Levels addressable by a single index: mip levels, the diagonal of rip levels, or just level 0.
+    int level_count() const {
+        switch (file.levelMode()) {
+            case Imf::MIPMAP_LEVELS: return file.numLevels();
+            case Imf::RIPMAP_LEVELS: return std::min(file.numXLevels(), file.numYLevels());
+            default: return 1;
+        }
+    }
+};
+
+// Reads tiles [tx0, tx1] x [ty0, ty1] of one level, one row of tiles at a time, into a target
+// covering exactly that pixel region.
+static void read_exr_tiles(ExrTiledReader &reader, int level, int tx0, int ty0, int tx1, int ty1,
+                           const lyra_decode_target *target, lyra::DecodeMonitor &monitor, std::atomic<bool> &gray) {
+    Imf::TiledInputFile &file = reader.file;
+    Imath::Box2i origin = file.dataWindowForTile(tx0, ty0, level, level);
+    auto *dst = static_cast<char *>(target->pixels);
+    int format = target->format;
+
+    bool direct = is_float_format(format);
+    Imf::PixelType type = direct ? (format == LYRA_PIXEL_RGBA_F32 ? Imf::FLOAT : Imf::HALF) : band_pixel_type(reader.channels);
+    size_t px = type == Imf::HALF ? 8 : 16;
+    size_t band_stride = px * target->width;
+    auto *stats = monitor.stats();
+    lyra::ScratchBuffer scratch(monitor.scratch_pool(), direct ? 0 : band_stride * file.tileYSize(), stats);
+    auto *band = scratch.as<char>();
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        Imath::Box2i row_box = file.dataWindowForTile(tx0, ty, level, level);
+        int y0 = row_box.min.y - origin.min.y;
+        int rows = row_box.max.y - row_box.min.y + 1;
+
+        Imf::FrameBuffer fb;
+        if (direct) {
+            char *base = dst - static_cast<ptrdiff_t>(origin.min.x) * px - static_cast<ptrdiff_t>(origin.min.y) * target->stride;
+            insert_rgba_slices(fb, reader.channels, type, base, px, target->stride);
+        } else {
+            char *base = band - static_cast<ptrdiff_t>(origin.min.x) * px - static_cast<ptrdiff_t>(row_box.min.y) * band_stride;
+            insert_rgba_slices(fb, reader.channels, type, base, px, band_stride);
+        }
+        file.setFrameBuffer(fb);
+        {
+            lyra::StageTimer timer(stats, lyra::DecodeStats::decompress);
+            file.readTiles(tx0, tx1, ty, ty, level, level);
+        }
+
+        if (!direct)
+            convert_band_rows(band, type, band_stride, rows, target, y0, gray, stats, monitor.image_stats());
+        monitor.advance(1);
+    }
+}
+
+static void replicate_red(const lyra_decode_target *target) {
+    auto *dst = static_cast<uint8_t *>(target->pixels);
+    lyra::parallel_for_rows(target->height, 256, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y)
+            lyra::replicate_red_row(dst + static_cast<size_t>(y) * target->stride, target->format, target->width);
+    });
+}
+
+// Whole-image decode from encoded bytes; the path and memory entry points differ only in where those live.
+static bool decode_exr_pixels(const ExrBytes &bytes, const lyra_decode_target *target, const lyra_decode_control *control,
+                              bool *is_grayscale, lyra::DecodeStats &stats) {
+    init_exr_threads();
+    lyra::ThreadBudget budget(control);
+    stats.set_threads(budget.threads());
+    stats.set_io_bytes(static_cast<long long>(bytes.size));
+
+    try {
+        lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+        ExrMemoryStream stream(bytes);
+        Imf::InputFile file(stream, budget.threads());
+        open_timer.stop();
+
+        Imath::Box2i dw = file.header().dataWindow();
+        int w = dw.max.x - dw.min.x + 1;
+        int h = dw.max.y - dw.min.y + 1;
+
+        if (w != target->width || h != target->height) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR size changed: expected %dx%d, got %dx%d.", target->width, target->height, w, h);
+            return false;
+        }
+
+        lyra::StageTimer header_timer(&stats, lyra::DecodeStats::header);
+        ExrRgbaChannels channels = select_rgba_channels(file.header().channels());
+        header_timer.stop();
+
+        lyra::ImageStats image_stats(control);
+        lyra::DecodeMonitor monitor(control, h, &stats, &image_stats);
+        std::atomic<bool> gray(true);
+
+        monitor.check();
+        if (channels.needs_rgba_file)
+            read_exr_rgba_file(bytes, target, monitor, gray);
+        else
+            read_exr_framebuffer(file, channels, 0, target, monitor, gray);
+
+        if (gray)
+            replicate_red(target);
+        image_stats.publish(gray);
+
+        *is_grayscale = gray;
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "%s", ex.what());
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return false;
+}
+
+
+extern "C" {
+
+EXR_API const char *get_last_exr_error() { return last_exr_error; }
+
+EXR_API bool read_exr_size_from_memory(const void *data, size_t size, int *width, int *height) {
+    if (!data) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR source buffer.");
+        *width = *height = 0;
+        return false;
+    }
+
+    try {
+        ExrMemoryStream stream({"<memory>", static_cast<const unsigned char *>(data), size});
+        Imf::InputFile file(stream);
+        Imath::Box2i dw = file.header().dataWindow();
+        *width = dw.max.x - dw.min.x + 1;
+        *height = dw.max.y - dw.min.y + 1;
+
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    *width = *height = 0;
+    return false;
+}
+
+EXR_API bool read_exr_size(const char *path, int *width, int *height) {
+    lyra::MappedFile file;
+    if (!file.open(path)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Failed to open EXR file.");
+        *width = *height = 0;
+        return false;
+    }
+
+    return read_exr_size_from_memory(file.data(), file.size(), width, height);
+}
+
+EXR_API bool load_exr_pixels(const char *path, const lyra_decode_target *target, const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR destination buffer.");
+        return false;
+    }
+
+    lyra::DecodeStats stats(control);
+    lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+    lyra::MappedFile file;
+    if (!file.open(path)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Failed to open EXR file.");
+        return false;
+    }
+    open_timer.stop();
+
+    return decode_exr_pixels({path, file.data(), file.size()}, target, control, is_grayscale, stats);
+}
+
+EXR_API bool load_exr_pixels_from_memory(const void *data, size_t size, const lyra_decode_target *target,
+                                         const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target) || !data) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR source or destination buffer.");
+        return false;
+    }
+
+    lyra::DecodeStats stats(control);
+    return decode_exr_pixels({"<memory>", static_cast<const unsigned char *>(data), size}, target, control, is_grayscale, stats);
+}
+
+EXR_API bool probe_exr(const char *path, lyra_image_probe *probe) {
+    try {
+        // Reads the headers and chunk offset tables only; no pixel data is decompressed.
+        ExrMappedFile mapped(path);
+        Imf::MultiPartInputFile file(mapped.stream(), 1, false);
+        fill_exr_probe(file, probe);
+
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return false;
+}
+
+EXR_API bool list_exr_layers(const char *path, lyra_image_layer *layers, int capacity, int *count) {
+    try {
+        // Headers only; no chunk offset table reconstruction and no pixel data.
+        ExrMappedFile mapped(path);
+        Imf::MultiPartInputFile file(mapped.stream(), 1, false);
+        std::vector<lyra_image_layer> found = collect_exr_layers(file);
+
+        int n = std::min(static_cast<int>(found.size()), std::max(capacity, 0));
+        if (n > 0)
+            memcpy(layers, found.data(), sizeof(lyra_image_layer) * n);
+        *count = static_cast<int>(found.size());
+
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return false;
+}
+
+// Decodes only the listed channels of one part. Other parts are never read; within the part, only the
+// requested channels are converted into the frame buffer.
+EXR_API bool load_exr_layer(const char *path, int part, const char *channels, const lyra_decode_target *target,
+                            const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target) || !channels) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR layer or destination buffer.");
+        return false;
+    }
+
+    init_exr_threads();
+    lyra::DecodeStats stats(control);
+    lyra::ThreadBudget budget(control);
+    stats.set_threads(budget.threads());
 
     try {
-        Imf::RgbaInputFile file(path);
-        Imath::Box2i dw = file.dataWindow();
+        lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+        ExrMappedFile mapped(path);
+        Imf::MultiPartInputFile file(mapped.stream(), budget.threads());
+        open_timer.stop();
+        stats.set_io_bytes(static_cast<long long>(mapped.bytes().size));
+        if (part < 0 || part >= file.parts()) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR part %d out of range (%d parts).", part, file.parts());
+            return false;
+        }
+
+        Imf::InputPart input(file, part);
+        Imath::Box2i dw = input.header().dataWindow();
         int w = dw.max.x - dw.min.x + 1;
         int h = dw.max.y - dw.min.y + 1;
 
-        *width = w;
-        *height = h;
+        if (w != target->width || h != target->height) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR part size changed: expected %dx%d, got %dx%d.", target->width, target->height, w, h);
+            return false;
+        }
+
+        lyra::StageTimer header_timer(&stats, lyra::DecodeStats::header);
+        std::string storage[4];
+        ExrRgbaChannels sel = select_layer_channels(input.header(), channels, storage);
+        header_timer.stop();
 
-        Imf::Array2D<Imf::Rgba> pixels;
-        pixels.resizeErase(h, w);
-        file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * w, 1, w);
-        file.readPixels(dw.min.y, dw.max.y);
+        lyra::ImageStats image_stats(control);
+        lyra::DecodeMonitor monitor(control, h, &stats, &image_stats);
+        std::atomic<bool> gray(true);
 
-        *out_pixels = (float *) malloc(sizeof(float) * w * h * 4);
-        if (!*out_pixels) {
-            snprintf(last_exr_error, sizeof(last_exr_error), "Failed to allocate memory for EXR output buffer.");
+        monitor.check();
+        read_exr_framebuffer(input, sel, 0, target, monitor, gray);
+
+        // A single channel (depth, alpha, a mask) is shown as gray.
+        bool single = !sel.names[1] && !sel.names[2];
+        if (single)
+            replicate_red(target);
+        image_stats.publish(single);
+
+        *is_grayscale = single;
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "%s", ex.what());
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return false;
+}
+
+EXR_API void *exr_scanline_open(const char *path) {
+    init_exr_threads();
+
+    try {
+        auto reader = std::make_unique<ExrScanlineReader>(path);
+        if (reader->channels.needs_rgba_file) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "Luminance/chroma EXR cannot be read by band.");
+            return nullptr;
+        }
+
+        last_exr_error[0] = '\0';
+        return reader.release();
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return nullptr;
+}
+
+EXR_API void exr_scanline_close(void *handle) {
+    delete static_cast<ExrScanlineReader *>(handle);
+}
+
+// Reads data window rows [first_row, first_row + target->height) into the target. Grayscale is decided from
+// the channel list, since one band cannot tell whether the rest of the image has colour.
+EXR_API bool exr_scanline_read(void *handle, int first_row, const lyra_decode_target *target, const lyra_decode_control *control,
+                               bool *is_grayscale) {
+    auto *reader = static_cast<ExrScanlineReader *>(handle);
+    if (!reader || !lyra::is_valid_target(target)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR scanline reader or destination buffer.");
+        return false;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        lyra::DecodeStats stats(control);
+        lyra::ThreadBudget budget(control);
+        stats.set_threads(budget.threads());
+        Imath::Box2i dw = reader->file.header().dataWindow();
+        int w = dw.max.x - dw.min.x + 1;
+        int h = dw.max.y - dw.min.y + 1;
+
+        if (target->width != w || first_row < 0 || first_row + target->height > h) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR band out of range: rows %d-%d of %dx%d.", first_row, first_row + target->height - 1, w, h);
             return false;
         }
 
-        {
-            std::lock_guard<std::mutex> lock(exr_alloc_mutex);
-            exr_allocated_ptrs.insert(*out_pixels);
+        lyra::DecodeMonitor monitor(control, target->height, &stats);
+        std::atomic<bool> gray(true);
+        monitor.check();
+        read_exr_framebuffer(reader->file, reader->channels, first_row, target, monitor, gray);
+
+        bool luminance_only = !reader->channels.names[1] && !reader->channels.names[2];
+        if (luminance_only)
+            replicate_red(target);
+
+        *is_grayscale = luminance_only;
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "%s", ex.what());
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return false;
+}
+
+EXR_API void *exr_tiled_open(const char *path) {
+    init_exr_threads();
+
+    try {
+        auto *reader = new ExrTiledReader(path);
+        if (reader->channels.needs_rgba_file) {
+            delete reader;
+            snprintf(last_exr_error, sizeof(last_exr_error), "Luminance/chroma tiled EXR cannot be read by tile.");
+            return nullptr;
         }
 
-        for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                int i = y * w + x;
-                (*out_pixels)[i * 4 + 0] = pixels[y][x].r;
-                (*out_pixels)[i * 4 + 1] = pixels[y][x].g;
-                (*out_pixels)[i * 4 + 2] = pixels[y][x].b;
-                (*out_pixels)[i * 4 + 3] = pixels[y][x].a;
-            }
+        last_exr_error[0] = '\0';
+        return reader;
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
+    }
+    return nullptr;
+}
+
+EXR_API void exr_tiled_close(void *handle) {
+    delete static_cast<ExrTiledReader *>(handle);
+}
+
+EXR_API int exr_tiled_level_count(void *handle) {
+    return handle ? static_cast<ExrTiledReader *>(handle)->level_count() : 0;
+}
+
+EXR_API bool exr_tiled_level_info(void *handle, int level, int *width, int *height, int *tiles_x, int *tiles_y) {
+    auto *reader = static_cast<ExrTiledReader *>(handle);
+    if (!reader || level < 0 || level >= reader->level_count()) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR tile level %d.", level);
+        return false;
+    }
+
+    try {
+        Imf::TiledInputFile &file = reader->file;
+        Imath::Box2i lw = file.dataWindowForLevel(level, level);
+        *width = lw.max.x - lw.min.x + 1;
+        *height = lw.max.y - lw.min.y + 1;
+        *tiles_x = file.numXTiles(level);
+        *tiles_y = file.numYTiles(level);
+
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    }
+    return false;
+}
+
+EXR_API bool exr_tiled_read(void *handle, int level, int tx0, int ty0, int tx1, int ty1, const lyra_decode_target *target,
+                            const lyra_decode_control *control, bool *is_grayscale) {
+    auto *reader = static_cast<ExrTiledReader *>(handle);
+    if (!reader || !lyra::is_valid_target(target)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR tile reader or destination buffer.");
+        return false;
+    }
+
+    try {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        lyra::DecodeStats stats(control);
+        lyra::ThreadBudget budget(control);
+        stats.set_threads(budget.threads());
+        Imf::TiledInputFile &file = reader->file;
+
+        if (level < 0 || level >= reader->level_count() || tx0 < 0 || ty0 < 0 || tx0 > tx1 || ty0 > ty1 ||
+            tx1 >= file.numXTiles(level) || ty1 >= file.numYTiles(level)) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR tile range out of bounds.");
+            return false;
+        }
+
+        Imath::Box2i first = file.dataWindowForTile(tx0, ty0, level, level);
+        Imath::Box2i last = file.dataWindowForTile(tx1, ty1, level, level);
+        int w = last.max.x - first.min.x + 1;
+        int h = last.max.y - first.min.y + 1;
+        if (w != target->width || h != target->height) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR tile region is %dx%d, target is %dx%d.", w, h, target->width, target->height);
+            return false;
         }
 
+        lyra::DecodeMonitor monitor(control, ty1 - ty0 + 1, &stats);
+        std::atomic<bool> gray(true);
+        monitor.check();
+        read_exr_tiles(*reader, level, tx0, ty0, tx1, ty1, target, monitor, gray);
+
+        // Decide from the channel list rather than the pixels: a pure red tile is not grayscale.
+        bool luminance_only = !reader->channels.names[1] && !reader->channels.names[2];
+        if (luminance_only)
+            replicate_red(target);
+
+        *is_grayscale = luminance_only;
         last_exr_error[0] = '\0';
         return true;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "%s", ex.what());
     } catch (const std::exception &ex) {
         snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
     } catch (...) {
         snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
     }
-    *out_pixels = nullptr;
-    *width = *height = 0;
     return false;
 }
 
-EXR_API void free_exr_pixels(float *ptr) {
-    if (ptr == nullptr) {
-        printf("[C++] Warning: free_exr_pixels called with null pointer!\n");
-        fflush(stdout);
-        return;
+EXR_API bool read_exr_preview_size(const char *path, int max_width, int max_height, int *width, int *height) {
+    int w = 0, h = 0;
+    if (!read_exr_size(path, &w, &h))
+        return false;
+
+    lyra::preview_size(w, h, lyra::preview_factor(w, h, max_width, max_height), width, height);
+    return true;
+}
+
+EXR_API bool load_exr_preview(const char *path, int max_width, int max_height, const lyra_decode_target *target,
+                              const lyra_decode_control *control, bool *is_grayscale) {
+    if (!lyra::is_valid_target(target)) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Invalid EXR destination buffer.");
+        return false;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(exr_alloc_mutex);
-        if (exr_allocated_ptrs.find(ptr) == exr_allocated_ptrs.end()) {
-            printf("[C++] Warning: Attempting to free unknown or already freed pointer %p!\n", ptr);
-            fflush(stdout);
-        } else {
-            exr_allocated_ptrs.erase(ptr);
-            free(ptr);
+    init_exr_threads();
+    lyra::DecodeStats stats(control);
+    lyra::ThreadBudget budget(control);
+    stats.set_threads(budget.threads());
+
+    try {
+        lyra::StageTimer open_timer(&stats, lyra::DecodeStats::open);
+        ExrMappedFile mapped(path);
+        Imf::InputFile file(mapped.stream(), budget.threads());
+        open_timer.stop();
+        stats.set_io_bytes(static_cast<long long>(mapped.bytes().size));
+
+        Imath::Box2i dw = file.header().dataWindow();
+        int w = dw.max.x - dw.min.x + 1;
+        int h = dw.max.y - dw.min.y + 1;
+
+        int factor = lyra::preview_factor(w, h, max_width, max_height);
+        int pw = 0, ph = 0;
+        lyra::preview_size(w, h, factor, &pw, &ph);
+        if (pw != target->width || ph != target->height) {
+            snprintf(last_exr_error, sizeof(last_exr_error), "EXR preview size mismatch: expected %dx%d, got %dx%d.", target->width, target->height, pw, ph);
+            return false;
         }
+
+        lyra::StageTimer header_timer(&stats, lyra::DecodeStats::header);
+        ExrRgbaChannels channels = select_rgba_channels(file.header().channels());
+        header_timer.stop();
+
+        lyra::DecodeMonitor monitor(control, h, &stats);
+        std::atomic<bool> gray(true);
+
+        monitor.check();
+        read_exr_preview(mapped.bytes(), file, channels, factor, target, monitor, gray);
+
+        if (gray)
+            replicate_red(target);
+
+        *is_grayscale = gray;
+        last_exr_error[0] = '\0';
+        return true;
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "%s", ex.what());
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR exception: %s", ex.what());
+    } catch (...) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "Unknown EXR exception.");
     }
+    return false;
+}
+
+// Session whose pool keeps up to `retain_bytes` of idle scratch between decodes; passed in lyra_decode_control.
+EXR_API lyra_decode_session *exr_session_create(long long retain_bytes) {
+    try {
+        return new lyra_decode_session(static_cast<size_t>(std::max(0LL, retain_bytes)));
+    } catch (const std::exception &ex) {
+        snprintf(last_exr_error, sizeof(last_exr_error), "EXR session failed: %s", ex.what());
+        return nullptr;
+    }
+}
+
+// Frees idle scratch not reused since the previous trim and any beyond `retain_bytes`, the new cap.
+// Returns the bytes freed.
+EXR_API long long exr_session_trim(lyra_decode_session *session, long long retain_bytes) {
+    return session ? static_cast<long long>(session->pool.trim(static_cast<size_t>(std::max(0LL, retain_bytes)))) : 0;
+}
+
+EXR_API void exr_session_destroy(lyra_decode_session *session) {
+    delete session;
 }
 }
@@ -0,0 +1,490 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "decode_control.h"
+#include "lyra_decode.h"
+#include "parallel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LYRA_SSE2 1
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define LYRA_NEON 1
+#endif
+
+#ifdef _WIN32
+#define PSD_API __declspec(dllexport)
+#else
+#define PSD_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __clang__
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL thread_local
+#endif
+
+static THREAD_LOCAL char last_psd_error[512] = "";
+
+extern "C" {
+
+/* Planar 8-bit source of one composite or tile. Mirrored in Lyra.Imaging.Psd/src/Core/Interop/PsdNative.cs. */
+typedef struct psd_planes {
+    const unsigned char *color[4]; /* R, G, B (fourth unused) or C, M, Y, K */
+    const unsigned char *alpha;    /* null when the image has no alpha plane */
+    int color_stride[4];
+    int alpha_stride;
+    int width;
+    int height;
+} psd_planes;
+
+typedef enum psd_color_planes {
+    PSD_PLANES_RGB = 0,
+    PSD_PLANES_CMYK = 1, /* inverted ink as stored by Photoshop; naive 255 * (1 - c) * (1 - k) unless a grid is given */
+} psd_color_planes;
+
+/* How planes become 4-byte pixels. Curves and neutral balance act on RGB, i.e. after the CMYK conversion. */
+typedef struct psd_interleave_params {
+    int color_planes;             /* psd_color_planes */
+    int bgra;                     /* write B, G, R, A instead of R, G, B, A */
+    int premultiply;              /* premultiply colour by alpha; ignored without an alpha plane */
+    const unsigned char *curves;  /* 3 x 256 entries for R, G and B; null = identity */
+    int neutral_threshold;        /* pixels with max - min <= threshold get neutral_add; < 0 = off */
+    int neutral_add[3];
+    /* CMYK only: a profile baked into cmyk_grid_size^4 nodes over the stored 0..255 range, 4 bytes
+     * (R, G, B, unused) each with C varying fastest, then M, Y, K; 2..152 nodes per axis.
+     * Replaces the naive conversion; null = naive. */
+    const unsigned char *cmyk_grid;
+    int cmyk_grid_size;
+} psd_interleave_params;
+
+} // extern "C"
+
+namespace {
+
+/* c * a / 255 rounded to nearest, the same as the managed (c * a + 127) / 255: products of two
+ * bytes never divide to exactly one half. */
+inline uint8_t mul_div255(unsigned c, unsigned a) {
+    unsigned t = c * a + 128;
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+#if defined(LYRA_SSE2)
+inline __m128i mul_div255_epu16(__m128i c, __m128i a) {
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+inline __m128i mul_div255_epu8(__m128i c, __m128i a) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = mul_div255_epu16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(a, zero));
+    __m128i hi = mul_div255_epu16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(a, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+#elif defined(LYRA_NEON)
+inline uint8x16_t mul_div255_u8(uint8x16_t c, uint8x16_t a) {
+    const uint16x8_t half = vdupq_n_u16(128);
+    uint16x8_t lo = vaddq_u16(vmull_u8(vget_low_u8(c), vget_low_u8(a)), half);
+    uint16x8_t hi = vaddq_u16(vmull_u8(vget_high_u8(c), vget_high_u8(a)), half);
+    return vcombine_u8(vshrn_n_u16(vsraq_n_u16(lo, lo, 8), 8), vshrn_n_u16(vsraq_n_u16(hi, hi, 8), 8));
+}
+#endif
+
+/* Expands one PackBits row: n >= 0 copies n + 1 literal bytes, n > -128 repeats the next byte
+ * 1 - n times and -128 is a no-op. Bytes left over once the row is full are ignored, as in
+ * the managed decoder; running out of input or overrunning the row is an error. */
+void unpack_row(const uint8_t *src, size_t size, uint8_t *dst, int width) {
+    size_t si = 0;
+    int di = 0;
+    while (di < width) {
+        if (si >= size)
+            throw std::runtime_error("PackBits source exhausted.");
+
+        int n = static_cast<int8_t>(src[si++]);
+        if (n >= 0) {
+            int count = n + 1;
+            if (count > width - di || static_cast<size_t>(count) > size - si)
+                throw std::runtime_error("PackBits literal run overruns its row.");
+            std::memcpy(dst + di, src + si, static_cast<size_t>(count));
+            si += static_cast<size_t>(count);
+            di += count;
+        } else if (n != -128) {
+            int count = 1 - n;
+            if (count > width - di || si >= size)
+                throw std::runtime_error("PackBits repeat run overruns its row.");
+            std::memset(dst + di, src[si++], static_cast<size_t>(count));
+            di += count;
+        }
+    }
+}
+
+/* Writes `width` pixels from planar R, G, B and optional A rows as R, G, B, A bytes; callers
+ * swap the R and B pointers for BGRA. Without alpha every pixel is opaque. */
+void interleave_row(const uint8_t *r, const uint8_t *g, const uint8_t *b, const uint8_t *a, bool premultiply, uint8_t *dst, int width) {
+    premultiply = premultiply && a;
+    int x = 0;
+
+#if defined(LYRA_SSE2)
+    const __m128i opaque = _mm_set1_epi8(static_cast<char>(0xFF));
+    for (; x + 16 <= width; x += 16) {
+        __m128i vr = _mm_loadu_si128(reinterpret_cast<const __m128i *>(r + x));
+        __m128i vg = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        __m128i va = a ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x)) : opaque;
+        if (premultiply) {
+            vr = mul_div255_epu8(vr, va);
+            vg = mul_div255_epu8(vg, va);
+            vb = mul_div255_epu8(vb, va);
+        }
+
+        __m128i rg_lo = _mm_unpacklo_epi8(vr, vg), rg_hi = _mm_unpackhi_epi8(vr, vg);
+        __m128i ba_lo = _mm_unpacklo_epi8(vb, va), ba_hi = _mm_unpackhi_epi8(vb, va);
+        auto *out = reinterpret_cast<__m128i *>(dst + static_cast<size_t>(x) * 4);
+        _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg_lo, ba_lo));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+    }
+#elif defined(LYRA_NEON)
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x4_t px;
+        px.val[0] = vld1q_u8(r + x);
+        px.val[1] = vld1q_u8(g + x);
+        px.val[2] = vld1q_u8(b + x);
+        px.val[3] = a ? vld1q_u8(a + x) : vdupq_n_u8(0xFF);
+        if (premultiply) {
+            px.val[0] = mul_div255_u8(px.val[0], px.val[3]);
+            px.val[1] = mul_div255_u8(px.val[1], px.val[3]);
+            px.val[2] = mul_div255_u8(px.val[2], px.val[3]);
+        }
+        vst4q_u8(dst + static_cast<size_t>(x) * 4, px);
+    }
+#endif
+
+    for (; x < width; ++x) {
+        uint8_t av = a ? a[x] : 255;
+        uint8_t *p = dst + static_cast<size_t>(x) * 4;
+        p[0] = premultiply ? mul_div255(r[x], av) : r[x];
+        p[1] = premultiply ? mul_div255(g[x], av) : g[x];
+        p[2] = premultiply ? mul_div255(b[x], av) : b[x];
+        p[3] = av;
+    }
+}
+
+/* Naive CMYK to RGB of one row, channel = ink * k / 255 on the stored (inverted) values. */
+void cmyk_to_rgb_row(const uint8_t *const cmyk[4], uint8_t *rgb[3], int width) {
+    for (int ch = 0; ch < 3; ++ch) {
+        const uint8_t *ink = cmyk[ch];
+        const uint8_t *k = cmyk[3];
+        uint8_t *out = rgb[ch];
+        int x = 0;
+#if defined(LYRA_SSE2)
+        for (; x + 16 <= width; x += 16) {
+            __m128i v = mul_div255_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ink + x)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(k + x)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), v);
+        }
+#elif defined(LYRA_NEON)
+        for (; x + 16 <= width; x += 16)
+            vst1q_u8(out + x, mul_div255_u8(vld1q_u8(ink + x), vld1q_u8(k + x)));
+#endif
+        for (; x < width; ++x)
+            out[x] = mul_div255(ink[x], k[x]);
+    }
+}
+
+/* Largest grid whose size^4 * 4 node bytes fit an int, the bound CmykIccGrid.NodeBytes enforces. */
+constexpr int kMaxCmykGridSize = 152;
+
+/* Node index and 8-bit fraction of every stored sample value along one grid axis, plus the byte
+ * strides of the four axes, so a pixel is located with table lookups alone. */
+struct CmykGrid {
+    const uint8_t *nodes;
+    uint8_t index[256];
+    uint16_t fraction[256]; /* 0..256 */
+    ptrdiff_t stride[4];    /* C, M, Y, K */
+
+    CmykGrid(const uint8_t *grid, int size) : nodes(grid) {
+        for (int v = 0; v < 256; ++v) {
+            int pos = (v * (size - 1) * 256 + 127) / 255;
+            int i = pos >> 8, f = pos & 255;
+            if (i == size - 1) { // the last node is only ever reached as the upper corner
+                i = size - 2;
+                f = 256;
+            }
+            index[v] = static_cast<uint8_t>(i);
+            fraction[v] = static_cast<uint16_t>(f);
+        }
+        stride[0] = 4;
+        for (int a = 1; a < 4; ++a)
+            stride[a] = stride[a - 1] * size;
+    }
+};
+
+/* Tetrahedral interpolation over C, M and Y in the two K slices around the pixel, then linear
+ * interpolation along K. Corner weights sum to 256 and K weights to 256, so everything stays in
+ * integers and the result is rounded once. */
+void cmyk_grid_pixel(const CmykGrid &grid, uint8_t c, uint8_t m, uint8_t y, uint8_t k, uint8_t rgb[3]) {
+    const uint8_t *base = grid.nodes + grid.index[c] * grid.stride[0] + grid.index[m] * grid.stride[1] +
+                          grid.index[y] * grid.stride[2] + grid.index[k] * grid.stride[3];
+    const int fx = grid.fraction[c], fy = grid.fraction[m], fz = grid.fraction[y], fk = grid.fraction[k];
+    const ptrdiff_t sx = grid.stride[0], sy = grid.stride[1], sz = grid.stride[2], sk = grid.stride[3];
+
+    // Corners after the origin, walking the tetrahedron that contains (fx, fy, fz).
+    ptrdiff_t off[4] = {0, 0, 0, sx + sy + sz};
+    int w[4];
+    if (fx >= fy) {
+        if (fy >= fz) {        // x >= y >= z
+            off[1] = sx; off[2] = sx + sy;
+            w[0] = 256 - fx; w[1] = fx - fy; w[2] = fy - fz; w[3] = fz;
+        } else if (fx >= fz) { // x >= z > y
+            off[1] = sx; off[2] = sx + sz;
+            w[0] = 256 - fx; w[1] = fx - fz; w[2] = fz - fy; w[3] = fy;
+        } else {               // z > x >= y
+            off[1] = sz; off[2] = sx + sz;
+            w[0] = 256 - fz; w[1] = fz - fx; w[2] = fx - fy; w[3] = fy;
+        }
+    } else {
+        if (fx >= fz) {        // y > x >= z
+            off[1] = sy; off[2] = sx + sy;
+            w[0] = 256 - fy; w[1] = fy - fx; w[2] = fx - fz; w[3] = fz;
+        } else if (fy >= fz) { // y >= z > x
+            off[1] = sy; off[2] = sy + sz;
+            w[0] = 256 - fy; w[1] = fy - fz; w[2] = fz - fx; w[3] = fx;
+        } else {               // z > y > x
+            off[1] = sz; off[2] = sy + sz;
+            w[0] = 256 - fz; w[1] = fz - fy; w[2] = fy - fx; w[3] = fx;
+        }
+    }
+
+#if defined(LYRA_SSE2)
+    // One register holds a node of both K slices as 16-bit R, G, B, 0 lanes: low half slice k, high half k + 1.
+    __m128i acc = _mm_setzero_si128();
+    for (int i = 0; i < 4; ++i) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, base + off[i], 4);
+        std::memcpy(&hi, base + off[i] + sk, 4);
+        __m128i node = _mm_unpacklo_epi8(_mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(lo)), _mm_cvtsi32_si128(static_cast<int>(hi))),
+                                         _mm_setzero_si128());
+        acc = _mm_add_epi16(acc, _mm_mullo_epi16(node, _mm_set1_epi16(static_cast<short>(w[i]))));
+    }
+
+    // acc * (256 - fk | fk) as 32-bit products, assembled from the low and high 16 bits.
+    __m128i wk = _mm_setr_epi16(static_cast<short>(256 - fk), static_cast<short>(256 - fk), static_cast<short>(256 - fk), static_cast<short>(256 - fk),
+                                static_cast<short>(fk), static_cast<short>(fk), static_cast<short>(fk), static_cast<short>(fk));
+    __m128i lo = _mm_mullo_epi16(acc, wk), hi = _mm_mulhi_epu16(acc, wk);
+    __m128i sum = _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi));
+    sum = _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 15)), 16);
+    __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(sum, sum), _mm_setzero_si128());
+    uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+    rgb[0] = static_cast<uint8_t>(packed);
+    rgb[1] = static_cast<uint8_t>(packed >> 8);
+    rgb[2] = static_cast<uint8_t>(packed >> 16);
+#elif defined(LYRA_NEON)
+    uint16x8_t acc = vdupq_n_u16(0);
+    for (int i = 0; i < 4; ++i) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, base + off[i], 4);
+        std::memcpy(&hi, base + off[i] + sk, 4);
+        uint32x2_t pair = vset_lane_u32(hi, vdup_n_u32(lo), 1);
+        acc = vmlaq_n_u16(acc, vmovl_u8(vreinterpret_u8_u32(pair)), static_cast<uint16_t>(w[i]));
+    }
+    uint32x4_t sum = vmull_n_u16(vget_low_u16(acc), static_cast<uint16_t>(256 - fk));
+    sum = vmlal_n_u16(sum, vget_high_u16(acc), static_cast<uint16_t>(fk));
+    uint16x4_t rounded = vrshrn_n_u32(sum, 16);
+    rgb[0] = static_cast<uint8_t>(vget_lane_u16(rounded, 0));
+    rgb[1] = static_cast<uint8_t>(vget_lane_u16(rounded, 1));
+    rgb[2] = static_cast<uint8_t>(vget_lane_u16(rounded, 2));
+#else
+    for (int ch = 0; ch < 3; ++ch) {
+        unsigned lo = 0, hi = 0;
+        for (int i = 0; i < 4; ++i) {
+            lo += static_cast<unsigned>(w[i]) * base[off[i] + ch];
+            hi += static_cast<unsigned>(w[i]) * base[off[i] + sk + ch];
+        }
+        rgb[ch] = static_cast<uint8_t>((lo * static_cast<unsigned>(256 - fk) + hi * static_cast<unsigned>(fk) + (1u << 15)) >> 16);
+    }
+#endif
+}
+
+void cmyk_grid_row(const CmykGrid &grid, const uint8_t *const cmyk[4], uint8_t *rgb[3], int width) {
+    for (int x = 0; x < width; ++x) {
+        uint8_t out[3];
+        cmyk_grid_pixel(grid, cmyk[0][x], cmyk[1][x], cmyk[2][x], cmyk[3][x], out);
+        rgb[0][x] = out[0];
+        rgb[1][x] = out[1];
+        rgb[2][x] = out[2];
+    }
+}
+
+inline uint8_t clamp_byte(int v) {
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/* Per channel curves, then the neutral balance nudge for near-grey pixels. */
+void tune_rgb_row(uint8_t *rgb[3], const psd_interleave_params &params, int width) {
+    if (params.curves) {
+        for (int ch = 0; ch < 3; ++ch) {
+            const uint8_t *curve = params.curves + ch * 256;
+            uint8_t *v = rgb[ch];
+            for (int x = 0; x < width; ++x)
+                v[x] = curve[v[x]];
+        }
+    }
+
+    if (params.neutral_threshold < 0)
+        return;
+
+    uint8_t *r = rgb[0], *g = rgb[1], *b = rgb[2];
+    for (int x = 0; x < width; ++x) {
+        int hi = r[x] > g[x] ? r[x] : g[x];
+        hi = b[x] > hi ? b[x] : hi;
+        int lo = r[x] < g[x] ? r[x] : g[x];
+        lo = b[x] < lo ? b[x] : lo;
+        if (hi - lo > params.neutral_threshold)
+            continue;
+
+        r[x] = clamp_byte(r[x] + params.neutral_add[0]);
+        g[x] = clamp_byte(g[x] + params.neutral_add[1]);
+        b[x] = clamp_byte(b[x] + params.neutral_add[2]);
+    }
+}
+
+void interleave_planes(const psd_planes &src, const psd_interleave_params &params, uint8_t *dst, int dst_stride,
+                       lyra::DecodeMonitor &monitor) {
+    const int width = src.width;
+    const bool cmyk = params.color_planes == PSD_PLANES_CMYK;
+    // Plain RGB goes straight from the planes; anything else is converted into a per-worker row first.
+    const bool converted = cmyk || params.curves || params.neutral_threshold >= 0;
+    const bool gridded = cmyk && params.cmyk_grid;
+    const CmykGrid grid(gridded ? params.cmyk_grid : nullptr, gridded ? params.cmyk_grid_size : 2);
+
+    lyra::parallel_for_rows(src.height, 64, [&](int y0, int y1) {
+        std::vector<uint8_t> scratch(converted ? static_cast<size_t>(width) * 3 : 0);
+        uint8_t *rgb[3] = {scratch.data(), scratch.data() + width, scratch.data() + 2 * static_cast<size_t>(width)};
+
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t *row[4];
+            for (int ch = 0; ch < (cmyk ? 4 : 3); ++ch)
+                row[ch] = src.color[ch] + static_cast<size_t>(y) * src.color_stride[ch];
+            const uint8_t *a = src.alpha ? src.alpha + static_cast<size_t>(y) * src.alpha_stride : nullptr;
+
+            if (converted) {
+                if (gridded) {
+                    cmyk_grid_row(grid, row, rgb, width);
+                } else if (cmyk) {
+                    cmyk_to_rgb_row(row, rgb, width);
+                } else {
+                    for (int ch = 0; ch < 3; ++ch)
+                        std::memcpy(rgb[ch], row[ch], static_cast<size_t>(width));
+                }
+                tune_rgb_row(rgb, params, width);
+                for (int ch = 0; ch < 3; ++ch)
+                    row[ch] = rgb[ch];
+            }
+
+            uint8_t *out = dst + static_cast<size_t>(y) * dst_stride;
+            if (params.bgra)
+                interleave_row(row[2], row[1], row[0], a, params.premultiply != 0, out, width);
+            else
+                interleave_row(row[0], row[1], row[2], a, params.premultiply != 0, out, width);
+
+            monitor.advance(1);
+        }
+    });
+}
+
+} // namespace
+
+extern "C" {
+
+PSD_API const char *get_last_psd_error() {
+    return last_psd_error;
+}
+
+/* Expands `rows` PackBits rows of `width` bytes each. Packed row i is lengths[i] bytes and
+ * follows row i - 1 in `packed`; unpacked row i is written to dst + i * dst_stride. Rows are
+ * independent, so they are spread over the decode's thread budget. */
+PSD_API bool psd_unpack_rows(const unsigned char *packed, const int *lengths, int rows, int width,
+                             unsigned char *dst, int dst_stride, const lyra_decode_control *control) {
+    if (!packed || !lengths || !dst || rows < 0 || width <= 0 || dst_stride < width) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "Invalid PackBits rows.");
+        return false;
+    }
+
+    try {
+        std::vector<size_t> offsets(static_cast<size_t>(rows) + 1);
+        for (int i = 0; i < rows; ++i) {
+            if (lengths[i] < 0)
+                throw std::runtime_error("Negative PackBits row length.");
+            offsets[i + 1] = offsets[i] + static_cast<size_t>(lengths[i]);
+        }
+
+        lyra::ThreadBudget budget(control);
+        lyra::DecodeMonitor monitor(control, rows);
+        // Packed rows average a few kB, so a chunk needs a good number of them to be worth a thread.
+        lyra::parallel_for_rows(rows, 32, [&](int r0, int r1) {
+            for (int i = r0; i < r1; ++i) {
+                unpack_row(packed + offsets[i], offsets[i + 1] - offsets[i], dst + static_cast<size_t>(i) * dst_stride, width);
+                monitor.advance(1);
+            }
+        });
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "%s", ex.what());
+        return false;
+    } catch (const std::exception &ex) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "PSD RLE decode failed: %s", ex.what());
+        return false;
+    }
+
+    last_psd_error[0] = '\0';
+    return true;
+}
+
+/* Converts planar 8-bit channels into 4-byte pixels at dst, rows dst_stride bytes apart. */
+PSD_API bool psd_interleave_planes(const psd_planes *src, const psd_interleave_params *params,
+                                   unsigned char *dst, int dst_stride, const lyra_decode_control *control) {
+    if (!src || !params || !dst || src->width <= 0 || src->height <= 0 || dst_stride < src->width * 4) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "Invalid PSD planes.");
+        return false;
+    }
+
+    const int color_count = params->color_planes == PSD_PLANES_CMYK ? 4 : 3;
+    for (int ch = 0; ch < color_count; ++ch) {
+        if (!src->color[ch] || src->color_stride[ch] < src->width) {
+            snprintf(last_psd_error, sizeof(last_psd_error), "Invalid PSD plane %d.", ch);
+            return false;
+        }
+    }
+    if (src->alpha && src->alpha_stride < src->width) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "Invalid PSD alpha plane.");
+        return false;
+    }
+    if (params->cmyk_grid && (params->cmyk_grid_size < 2 || params->cmyk_grid_size > kMaxCmykGridSize)) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "Invalid CMYK grid size %d.", params->cmyk_grid_size);
+        return false;
+    }
+
+    try {
+        lyra::ThreadBudget budget(control);
+        lyra::DecodeMonitor monitor(control, src->height);
+        interleave_planes(*src, *params, dst, dst_stride, monitor);
+    } catch (const lyra::decode_cancelled &ex) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "%s", ex.what());
+        return false;
+    } catch (const std::exception &ex) {
+        snprintf(last_psd_error, sizeof(last_psd_error), "PSD conversion failed: %s", ex.what());
+        return false;
+    }
+
+    last_psd_error[0] = '\0';
+    return true;
+}
+
+} // extern "C"